@@ -87,7 +87,9 @@ int main( 	int argc, char** argv 	)
 		
 		int trial = 0;
 
-		while( client.isConnected() ) 
+		// the session inside the client reconnects on its own, this loop only ends when
+		// it gives up
+		while( client.isAlive() ) 
 		{
 
 
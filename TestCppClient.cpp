@@ -54,10 +54,18 @@ TestCppClient::TestCppClient() 		:		m_osSignal		( 	2000 										), //2-seconds
 											m_pClient		(	new EClientSocket( this, &m_osSignal ) 		), 
 											m_state			( 	ST_CONNECT 									), 
 											m_sleepDeadline	( 	0											), 
+											m_cancelDeadline( 	0											), 
 											m_orderId		(	0											), 
+											m_session		(	m_pClient, &m_osSignal 						), 
 											m_extraAuth		(	false										)
 {
-	// nothing
+
+	// stay under the TWS 50 msg/s limit instead of sleeping between requests
+	m_pClient->setPacing( 			EPacer::DEFAULT_RATE, 
+									EPacer::DEFAULT_BURST 						);
+
+	m_pClient->setLatencyProbe( 	&m_probe 									);
+
 }
 
 //**********************************************************************************************************************
@@ -67,8 +75,7 @@ TestCppClient::~TestCppClient()
 {
 
 	// destroy the reader before the client
-	if( m_pReader )
-		m_pReader.reset();
+	m_session.disconnect();
 
 	delete m_pClient;
 
@@ -87,11 +94,18 @@ bool TestCppClient::connect(			const char 	   *host,
 								port, 
 								clientId 											);
 	
+	// sent together with startApi in the first write of the connection
+	m_pClient->queueStartupRequest( 			[]( EClientSocket& client ) { client.reqCurrentTime(); } );
+
 	//! [ connect ]
-	bool bRes = m_pClient->eConnect( 			host, 
+	//! [ereader]
+	// the session starts the EReader and, if the link drops later, reconnects and
+	// re-issues the market data / depth / bar subscriptions made so far
+	bool bRes = m_session.connect( 				host, 
 												port, 
 												clientId, 
 												m_extraAuth 						);
+	//! [ereader]
 	//! [ connect ]
 	
 	if( bRes ) 
@@ -101,12 +115,16 @@ bool TestCppClient::connect(			const char 	   *host,
 									m_pClient->host().c_str(), 
 									m_pClient->port(), 
 									clientId										);
-		
-		//! [ereader]
-		m_pReader = std::unique_ptr< EReader >( new EReader( m_pClient, &m_osSignal ) );
-		
-		m_pReader->start();
-		//! [ereader]
+
+		const ESocketOptions& so = m_pClient->effectiveSocketOptions();
+
+		printf( 					"Socket nodelay:%d quickack:%d rcvbuf:%d sndbuf:%d busypoll:%d priority:%d\n", 
+									so.tcpNoDelay, 
+									so.tcpQuickAck, 
+									so.rcvBuf, 
+									so.sndBuf, 
+									so.busyPollUs, 
+									so.priority										);
 	
 	}
 	else
@@ -121,6 +139,31 @@ bool TestCppClient::connect(			const char 	   *host,
 
 //**********************************************************************************************************************
 
+void TestCppClient::printStartupTimeline() const
+{
+
+	const EStartupTimeline& tl = m_pClient->startupTimeline();
+
+	printf( "Startup" );
+
+	for( int i = STARTUP_TCP_CONNECTED; i < STARTUP_PHASE_COUNT; ++i ) 
+	{
+
+		EStartupPhase phase = ( EStartupPhase )i;
+
+		if( tl.reached( phase ) )
+			printf( 				" %s:+%.3fms", 
+									EStartupTimeline::phaseName( phase ), 
+									tl.phaseMs( phase )							);
+
+	}
+
+	printf( "\n" );
+
+}
+
+//**********************************************************************************************************************
+
 void TestCppClient::disconnect() const
 {
 
@@ -141,6 +184,15 @@ bool TestCppClient::isConnected() const
 
 //**********************************************************************************************************************
 
+bool TestCppClient::isAlive() const
+{
+
+	return m_session.alive();
+
+}
+
+//**********************************************************************************************************************
+
 void TestCppClient::setConnectOptions( 	const std::string&  connectOptions	)
 {
 
@@ -153,6 +205,16 @@ void TestCppClient::setConnectOptions( 	const std::string&  connectOptions	)
 void TestCppClient::processMessages()
 {
 
+	// link down: only the session runs ( backoff + reconnect ), requests would be rejected anyway
+	if( !m_session.connected() ) 
+	{
+
+		m_session.processMsgs();
+
+		return;
+
+	}
+
 
 	time_t now = time( NULL );
 
@@ -213,6 +275,9 @@ void TestCppClient::processMessages()
 			break;
 
 		case ST_MARKETDEPTHOPERATION_ACK:
+			// the books are fed by the callbacks dispatched meanwhile, keep them until the cancel
+			if( !m_books.empty() && m_cancelDeadline < now )
+				cancelMarketDepth();
 			break;
 
 		case ST_REALTIMEBARS:
@@ -261,6 +326,8 @@ void TestCppClient::processMessages()
 		//*************************************************
 
 		case ST_MARKETSCANNERS_ACK:
+			if( m_scanners.tracked() && m_cancelDeadline < now )
+				cancelMarketScanners();
 			break;
 
 		case ST_FUNDAMENTALS:
@@ -510,7 +577,7 @@ void TestCppClient::processMessages()
 	// read 
 	//*************************************************
 	
-	m_pReader->processMsgs();
+	m_session.processMsgs();
 
 	//*************************************************
 	//*************************************************
@@ -854,6 +921,8 @@ void TestCppClient::delayedTickDataOperation()
 
 void TestCppClient::marketDepthOperations()
 {
+	m_books[ 2001 ] = EOrderBook( 5 );
+
 	/*** Requesting the Deep Book ***/
 	//! [reqmarketdepth]
 	m_pClient->reqMktDepth(					2001, 
@@ -862,14 +931,8 @@ void TestCppClient::marketDepthOperations()
 											false, 
 											TagValueListSPtr()										);
 	//! [reqmarketdepth]
-	
-	std::this_thread::sleep_for(			std::chrono::seconds( 2 )								);
-	
-	/*** Canceling the Deep Book request ***/
-	//! [cancelmktdepth]
-	m_pClient->cancelMktDepth(				2001, 
-											false													);
-	//! [cancelmktdepth]
+
+	m_books[ 2002 ] = EOrderBook( 5 );
 
 	/*** Requesting the Deep Book ***/
 	//! [reqmarketdepth]
@@ -879,16 +942,30 @@ void TestCppClient::marketDepthOperations()
 											true, 
 											TagValueListSPtr()										);
 	//! [reqmarketdepth]
-	
-	std::this_thread::sleep_for(			std::chrono::seconds( 5 )								);
-	/*** Canceling the Deep Book request ***/
-	
+
+	// both books fill while ST_MARKETDEPTHOPERATION_ACK dispatches the updates
+	m_cancelDeadline = time( NULL ) + 5;
+
+	m_state = ST_MARKETDEPTHOPERATION_ACK;
+
+}
+
+//**********************************************************************************************************************
+
+void TestCppClient::cancelMarketDepth()
+{
+
+	/*** Canceling the Deep Book requests ***/
 	//! [cancelmktdepth]
+	m_pClient->cancelMktDepth(				2001, 
+											false													);
 	m_pClient->cancelMktDepth(				2002, 
 											true													);
 	//! [cancelmktdepth]
 
-	m_state = ST_MARKETDEPTHOPERATION_ACK;
+	// updates already on their way find no book and are dropped
+	m_books.erase(							2001													);
+	m_books.erase(							2002													);
 
 }
 
@@ -1118,6 +1195,10 @@ void TestCppClient::marketScanners()
 	
 	std::this_thread::sleep_for(					std::chrono::seconds( 2 )						);
 
+	m_scanners.track( 7001 );
+	m_scanners.track( 7002 );
+	m_scanners.track( 7003 );
+
 	/*** Triggering a scanner subscription ***/
 	//! [reqscannersubscription]
 	m_pClient->reqScannerSubscription(				7001, 
@@ -1157,14 +1238,28 @@ void TestCppClient::marketScanners()
 
 	//! [reqcomplexscanner]
 
-	std::this_thread::sleep_for(					std::chrono::seconds( 2 )						);
+	// the refreshes reach m_scanners while ST_MARKETSCANNERS_ACK dispatches them
+	m_cancelDeadline = time( NULL ) + 5;
+
+	m_state = ST_MARKETSCANNERS_ACK;
+
+}
+
+//**********************************************************************************************************************
+
+void TestCppClient::cancelMarketScanners()
+{
+
 	/*** Canceling the scanner subscription ***/
 	//! [cancelscannersubscription]
 	m_pClient->cancelScannerSubscription( 7001 );
 	m_pClient->cancelScannerSubscription( 7002 );
+	m_pClient->cancelScannerSubscription( 7003 );
 	//! [cancelscannersubscription]
 
-	m_state = ST_MARKETSCANNERS_ACK;
+	m_scanners.forget( 7001 );
+	m_scanners.forget( 7002 );
+	m_scanners.forget( 7003 );
 
 }
 
@@ -2426,6 +2521,8 @@ void TestCppClient::nextValidId(  OrderId   orderId  )
 
 	printf(									"Next Valid Id: %ld\n", 
 											orderId										);
+
+	printStartupTimeline();
 	
 	m_orderId = orderId;
 	//! [nextvalidid]
@@ -2490,6 +2587,16 @@ void TestCppClient::currentTime( long time )
 		printf( 							"The current date/time is: %s", 
 											asctime( timeinfo )							);
 
+		const ELatencyHistogram& rtt = m_probe.histogram();
+
+		printf( 							"RTT us last:%lld p50:%lld p99:%lld max:%lld samples:%llu lost:%llu\n", 
+											( long long )m_probe.lastRttUs(), 
+											( long long )rtt.percentile( 50 ), 
+											( long long )rtt.percentile( 99 ), 
+											( long long )rtt.max(), 
+											( unsigned long long )rtt.count(), 
+											m_probe.lost()								);
+
 		time_t now = ::time( NULL );
 
 		m_sleepDeadline = now + SLEEP_BETWEEN_PINGS;
@@ -2759,7 +2866,8 @@ void TestCppClient::updatePortfolio(		const Contract& 	contract,
 											const std::string& 	accountName					)
 {
 
-	printf(									"UpdatePortfolio. %s, %s @ %s: Position: %g, MarketPrice: %g, MarketValue: %g, AverageCost: %g, UnrealizedPNL: %g, RealizedPNL: %g, AccountName: %s\n", 
+	printf(									"UpdatePortfolio. #%d %s, %s @ %s: Position: %g, MarketPrice: %g, MarketValue: %g, AverageCost: %g, UnrealizedPNL: %g, RealizedPNL: %g, AccountName: %s\n", 
+											m_contracts.intern( contract ), 
 											(contract.symbol).c_str(), 
 											(contract.secType).c_str(), 
 											(contract.primaryExchange).c_str(), 
@@ -2812,6 +2920,8 @@ void TestCppClient::contractDetails( 		int 						reqId,
 
 	printContractDetailsMsg(				contractDetails										);
 
+	m_optionChains.onContractDetails(		contractDetails										);
+
 	printf( 								"ContractDetails end. ReqId: %d\n", 
 											reqId												);
 
@@ -3024,6 +3134,16 @@ void TestCppClient::updateMktDepth(					TickerId 		id,
 								price, 
 								size										);
 
+	// updates still in flight after the cancel must not bring an erased book back
+	std::map< TickerId, EOrderBook >::iterator book = m_books.find( id );
+
+	if( book == m_books.end() )
+		return;
+
+	book->second.apply( position, operation, side, price, size );
+
+	printBookTop( id, book->second );
+
 }
 //! [updatemktdepth]
 
@@ -3049,11 +3169,43 @@ void TestCppClient::updateMktDepthL2(				TickerId 				id,
 								size, 
 								isSmartDepth								);
 
+	// unknown once cancelled, as in updateMktDepth
+	std::map< TickerId, EOrderBook >::iterator book = m_books.find( id );
+
+	if( book == m_books.end() )
+		return;
+
+	book->second.apply( position, operation, side, price, size );
+
+	printBookTop( id, book->second );
+
 }
 //! [updatemktdepthl2]
 
 //**********************************************************************************************************************
 
+void TestCppClient::printBookTop(					TickerId 				id, 
+													const EOrderBook& 		book						) const
+{
+
+	if( !book.hasTop() )
+		return;
+
+	printf( 					"Book. %ld - Bid: %d @ %g, Ask: %d @ %g, Spread: %g, Imbalance( 5 ): %.2f, Rows: %d / %d\n", 
+								id, 
+								book.bestBidSize(), 
+								book.bestBid(), 
+								book.bestAskSize(), 
+								book.bestAsk(), 
+								book.spread(), 
+								book.imbalance( 5 ), 
+								book.depth( EOrderBook::SIDE_BID ), 
+								book.depth( EOrderBook::SIDE_ASK )			);
+
+}
+
+//**********************************************************************************************************************
+
 //! [updatenewsbulletin]
 void TestCppClient::updateNewsBulletin(					int 					msgId, 
 														int 					msgType, 
@@ -3162,6 +3314,8 @@ void TestCppClient::scannerData(			int 						reqId,
 								projection.c_str(), 
 								legsStr.c_str()												);
 
+	m_scanners.scannerData( 	reqId, rank, contractDetails, distance, benchmark, projection, legsStr 	);
+
 }
 //! [scannerdata]
 
@@ -3174,6 +3328,24 @@ void TestCppClient::scannerDataEnd(		int  reqId	)
 	printf( 					"ScannerDataEnd. %d\n", 
 								reqId														);
 
+	m_scanners.scannerDataEnd( 	reqId 														);
+
+	const std::vector< EScannerChange >& changes = m_scanners.lastChanges();
+
+	for( size_t i = 0; i < changes.size(); ++i ) 
+	{
+
+		static const char* const kinds[] = { "entered", "left", "moved" };
+
+		printf( 				"Scanner %d: %s %s, rank %d -> %d\n", 
+								reqId, 
+								changes[ i ].row->details.contract.symbol.c_str(), 
+								kinds[ changes[ i ].kind ], 
+								changes[ i ].previousRank, 
+								changes[ i ].rank											);
+
+	}
+
 }
 //! [scannerdataend]
 
@@ -3281,8 +3453,9 @@ void TestCppClient::position( 	const std::string& 		account,
 								double 					avgCost				) 
 {
 
-	printf( 					"Position. %s - Symbol: %s, SecType: %s, Currency: %s, Position: %g, Avg Cost: %g\n", 
+	printf( 					"Position. %s - Contract: #%d, Symbol: %s, SecType: %s, Currency: %s, Position: %g, Avg Cost: %g\n", 
 								account.c_str(), 
+								m_contracts.intern( contract ), 
 								contract.symbol.c_str(), 
 								contract.secType.c_str(), 
 								contract.currency.c_str(), 
@@ -3497,6 +3670,14 @@ void TestCppClient::securityDefinitionOptionalParameter(					int 							reqId,
 							tradingClass.c_str(), 
 							multiplier.c_str()																					);
 
+	const EOptionChain& chain = m_optionChains.onParameter( exchange, underlyingConId, tradingClass, multiplier, expirations, strikes );
+
+	printf(					"Option chain %s@%s: %zu expiries, %zu strikes\n", 
+							tradingClass.c_str(), 
+							exchange.c_str(), 
+							chain.expiries().size(), 
+							chain.strikes().size()																				);
+
 }
 //! [securityDefinitionOptionParameter]
 
@@ -8,7 +8,14 @@
 #include "source/EWrapper.h"
 #include "source/EReaderOSSignal.h"
 #include "source/EReader.h"
-
+#include "source/ESession.h"
+#include "source/ELatencyProbe.h"
+#include "source/EOrderBook.h"
+#include "source/EOptionChain.h"
+#include "source/EScannerTracker.h"
+#include "source/EContractRegistry.h"
+
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -134,6 +141,7 @@ public:
 
 	void 	disconnect			(											) const;
 	bool 	isConnected 		(											) const;
+	bool 	isAlive 			(											) const;	// connected or reconnecting
 
 	State 	getState			(											);
 	void	setState			(			State  		state				); 
@@ -145,6 +153,7 @@ private:
 	void 	tickOptionComputationOperation	();
 	void 	delayedTickDataOperation		();
 	void 	marketDepthOperations			();
+	void 	cancelMarketDepth				();
 	void 	realTimeBars					();
 	void 	marketDataType					();
 	void 	historicalDataRequests			();
@@ -157,6 +166,7 @@ private:
 	void 	hedgeSample						();
 	void 	contractOperations				();
 	void 	marketScanners					();
+	void 	cancelMarketScanners			();
 	void 	fundamentals					();
 	void 	bulletins						();
 	void 	testAlgoSamples					();
@@ -194,6 +204,9 @@ private:
 	void 	printContractDetailsMsg			(	const ContractDetails		&contractDetails		);
 	void 	printContractDetailsSecIdList	(	const TagValueListSPtr 		&secIdList				);
 	void 	printBondContractDetailsMsg		(	const ContractDetails		&contractDetails		);
+	void 	printStartupTimeline			(															) const;
+	void 	printBookTop					(	TickerId 					id, 
+												const EOrderBook& 			book					) const;
 
 private:
 
@@ -204,9 +217,15 @@ private:
 	//! [ socket_declare ]
 	State 							m_state;
 	time_t 							m_sleepDeadline;
+	time_t 							m_cancelDeadline;	// when an _ACK state cancels the subscriptions it left running
 
 	OrderId 						m_orderId;
-	std::unique_ptr< EReader > 		m_pReader;
+	ESession 						m_session;		// owns the EReader, reconnects and replays subscriptions
+	ELatencyProbe 					m_probe;		// reqCurrentTime round trips, probed every second
+	std::map< TickerId, EOrderBook >	m_books;		// added with each reqMktDepth, erased on its cancel, fed by updateMktDepth( L2 )
+	EOptionChainRegistry 			m_optionChains;	// reqSecDefOptParams results, conIds from contractDetails
+	EScannerTracker 				m_scanners;		// scanner refreshes reduced to entries, exits and moves
+	EContractRegistry 				m_contracts;	// every contract of positions and portfolio, stored once
     bool 							m_extraAuth;
 	std::string 					m_bboExchange;
 
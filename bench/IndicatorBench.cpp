@@ -0,0 +1,113 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+//******************************************************************************************
+// indicator warm-up: backfill() over columns of minute bars vs one update() per bar
+//
+//      make bench && ./bench/IndicatorBench [bars]
+//
+// Default: 10 years of regular hours minute bars ( ~980k ). Both paths must end in the
+// same state, the benchmark checks that first.
+//******************************************************************************************
+
+#include "../StdAfx.h"
+#include "../source/EIndicators.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+
+
+//******************************************************************************************
+
+static bool same(   double a, double b  )
+{
+
+    return fabs( a - b ) <= 1e-9 * ( fabs( a ) + fabs( b ) + 1 );
+
+}
+
+//******************************************************************************************
+
+int main(   int argc, char** argv   )
+{
+
+    const size_t BARS = argc > 1 ? ( size_t )atol( argv[ 1 ] ) : 10 * 252 * 390;
+
+    //****************************************************
+    // random walk minute bars
+    //****************************************************
+
+    std::vector< double >   high( BARS ), low( BARS ), close( BARS ), volume( BARS ), wap( BARS );
+    std::mt19937            rng( 7 );
+    std::normal_distribution< double > step( 0, 0.05 );
+
+    double price = 400;
+
+    for( size_t i = 0; i < BARS; ++i ) 
+    {
+
+        double open = price;
+
+        price += step( rng );
+
+        close[ i ]  = price;
+        high[ i ]   = fmax( open, price ) + fabs( step( rng ) );
+        low[ i ]    = fmin( open, price ) - fabs( step( rng ) );
+        wap[ i ]    = ( high[ i ] + low[ i ] + close[ i ] ) / 3;
+        volume[ i ] = 1000 + rng() % 5000;
+
+    }
+
+    typedef std::chrono::steady_clock Clock;
+
+    //****************************************************
+
+    EEma            ema1( 20 ),     ema2( 20 );
+    EVwap           vwap1,          vwap2;
+    ERollingStdev   sd1( 390 ),     sd2( 390 );
+    EAtr            atr1( 14 ),     atr2( 14 );
+
+    Clock::time_point t0 = Clock::now();
+
+    for( size_t i = 0; i < BARS; ++i ) 
+    {
+        ema1.update( close[ i ] );
+        vwap1.update( wap[ i ], volume[ i ] );
+        sd1.update( close[ i ] );
+        atr1.update( high[ i ], low[ i ], close[ i ] );
+    }
+
+    Clock::time_point t1 = Clock::now();
+
+    ema2.backfill( &close[ 0 ], BARS );
+    vwap2.backfill( &wap[ 0 ], &volume[ 0 ], BARS );
+    sd2.backfill( &close[ 0 ], BARS );
+    atr2.backfill( &high[ 0 ], &low[ 0 ], &close[ 0 ], BARS );
+
+    Clock::time_point t2 = Clock::now();
+
+    //****************************************************
+
+    if( !same( ema1.value(), ema2.value() ) || !same( vwap1.value(), vwap2.value() ) || 
+        !same( sd1.value(), sd2.value() ) || !same( atr1.value(), atr2.value() ) ) 
+    {
+        printf( "backfill and update disagree\n" );
+        return 1;
+    }
+
+    double updateMs     = std::chrono::duration< double, std::milli >( t1 - t0 ).count();
+    double backfillMs   = std::chrono::duration< double, std::milli >( t2 - t1 ).count();
+
+    printf( "bars              %zu ( EMA 20, VWAP, stdev 390, ATR 14 )\n", BARS );
+    printf( "update()          %8.1f ms   %6.1f ns/bar\n", updateMs, updateMs * 1e6 / BARS );
+    printf( "backfill()        %8.1f ms   %6.1f ns/bar\n", backfillMs, backfillMs * 1e6 / BARS );
+    printf( "( ema %.4f vwap %.4f stdev %.4f atr %.4f )\n", ema2.value(), vwap2.value(), sd2.value(), atr2.value() );
+
+    return 0;
+
+}
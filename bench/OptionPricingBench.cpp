@@ -0,0 +1,116 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+//******************************************************************************************
+// repricing a whole chain on an underlying move: prices and greeks, implied volatilities
+// from scratch and seeded with the previous solution
+//
+//      make bench && ./bench/OptionPricingBench [options]
+//
+// Default: 2000 options ( 20 expiries x 50 strikes, calls and puts ). The implied vols
+// solved from model prices must give back the model vols, the benchmark checks that first.
+//******************************************************************************************
+
+#include "../StdAfx.h"
+#include "../source/EOptionPricer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+
+
+//******************************************************************************************
+
+int main(   int argc, char** argv   )
+{
+
+    const size_t    OPTIONS = argc > 1 ? ( size_t )atol( argv[ 1 ] ) : 2000;
+    const int       ROUNDS  = 100;
+    const double    RATE    = 0.045;
+    const double    YIELD   = 0.013;
+
+    //****************************************************
+    // chain around 450 with a volatility smile
+    //****************************************************
+
+    std::vector< double >           strike( OPTIONS ), time( OPTIONS ), vol( OPTIONS );
+    std::vector< unsigned char >    isCall( OPTIONS );
+
+    for( size_t i = 0; i < OPTIONS; ++i ) 
+    {
+
+        double moneyness = ( double )( ( i / 2 ) % 50 ) / 50 - 0.5;
+
+        strike[ i ] = 450 * ( 1 + 0.3 * moneyness );
+        time[ i ]   = ( 7 + 30 * ( i / 100 % 20 ) ) / 365.0;
+        vol[ i ]    = 0.16 + 0.2 * moneyness * moneyness - 0.04 * moneyness;
+        isCall[ i ] = i & 1;
+
+    }
+
+    std::vector< double > price( OPTIONS ), delta( OPTIONS ), gamma( OPTIONS ), vega( OPTIONS ), theta( OPTIONS );
+    std::vector< double > iv( OPTIONS, 0 );
+
+    typedef std::chrono::steady_clock Clock;
+
+    //****************************************************
+
+    Clock::time_point t0 = Clock::now();
+
+    for( int r = 0; r < ROUNDS; ++r )
+        EOptionPricer::priceBatch(  OPTION_BLACK_SCHOLES, 450 + 0.01 * r, RATE, YIELD, OPTIONS, 
+                                    &strike[ 0 ], &time[ 0 ], &vol[ 0 ], &isCall[ 0 ], 
+                                    &price[ 0 ], &delta[ 0 ], &gamma[ 0 ], &vega[ 0 ], &theta[ 0 ] );
+
+    Clock::time_point t1 = Clock::now();
+
+    size_t solved = EOptionPricer::impliedVolBatch( OPTION_BLACK_SCHOLES, 450 + 0.01 * ( ROUNDS - 1 ), RATE, YIELD, OPTIONS, 
+                                                    &strike[ 0 ], &time[ 0 ], &isCall[ 0 ], &price[ 0 ], &iv[ 0 ] );
+
+    Clock::time_point t2 = Clock::now();
+
+    double worst = 0;
+
+    for( size_t i = 0; i < OPTIONS; ++i ) 
+    {
+
+        // deep in or out of the money short dated options hardly depend on the volatility
+        if( vega[ i ] > 1e-4 && !( fabs( iv[ i ] - vol[ i ] ) < 1e-6 ) ) 
+        {
+            printf( "implied vol %zu: %.8f, expected %.8f\n", i, iv[ i ], vol[ i ] );
+            return 1;
+        }
+
+        if( !isnan( iv[ i ] ) )
+            worst = fmax( worst, fabs( iv[ i ] - vol[ i ] ) );
+
+    }
+
+    // the underlying ticks up: new prices, vols seeded with the previous solution
+    EOptionPricer::priceBatch(  OPTION_BLACK_SCHOLES, 450.25, RATE, YIELD, OPTIONS, 
+                                &strike[ 0 ], &time[ 0 ], &vol[ 0 ], &isCall[ 0 ], &price[ 0 ] );
+
+    Clock::time_point t3 = Clock::now();
+
+    EOptionPricer::impliedVolBatch( OPTION_BLACK_SCHOLES, 450.25, RATE, YIELD, OPTIONS, 
+                                    &strike[ 0 ], &time[ 0 ], &isCall[ 0 ], &price[ 0 ], &iv[ 0 ] );
+
+    Clock::time_point t4 = Clock::now();
+
+    //****************************************************
+
+    double priceUs  = std::chrono::duration< double, std::micro >( t1 - t0 ).count() / ROUNDS;
+    double coldUs   = std::chrono::duration< double, std::micro >( t2 - t1 ).count();
+    double seededUs = std::chrono::duration< double, std::micro >( t4 - t3 ).count();
+
+    printf( "options           %zu ( implied vols solved %zu, worst error %.1e )\n", OPTIONS, solved, worst );
+    printf( "price + greeks    %8.1f us   %6.1f ns/option\n", priceUs, priceUs * 1e3 / OPTIONS );
+    printf( "implied vols      %8.1f us   %6.1f ns/option\n", coldUs, coldUs * 1e3 / OPTIONS );
+    printf( "  seeded          %8.1f us   %6.1f ns/option\n", seededUs, seededUs * 1e3 / OPTIONS );
+
+    return 0;
+
+}
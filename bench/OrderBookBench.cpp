@@ -0,0 +1,132 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+//******************************************************************************************
+// EOrderBook throughput: updateMktDepth operations applied per second
+//
+//      make bench && ./bench/OrderBookBench [updates]
+//
+// The feed is generated up front ( mostly updates near the top, inserts and deletes
+// keeping each side around 10 rows, as a TWS depth subscription looks ) so only the
+// book is measured. The top of book is read after every update, as a strategy would.
+//******************************************************************************************
+
+#include "../StdAfx.h"
+#include "../source/EOrderBook.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+
+
+//******************************************************************************************
+
+struct DepthUpdate 
+{
+
+    int                 position;
+    int                 operation;
+    int                 side;
+    double              price;
+    int                 size;
+
+};
+
+//******************************************************************************************
+
+int main(   int argc, char** argv   )
+{
+
+    const int UPDATES = argc > 1 ? atoi( argv[ 1 ] ) : 10000000;
+
+    //****************************************************
+    // feed
+    //****************************************************
+
+    std::vector< DepthUpdate >  feed;
+    std::mt19937                rng( 42 );
+
+    feed.reserve( UPDATES );
+
+    int rows[ 2 ] = { 0, 0 };
+
+    for( int i = 0; i < UPDATES; ++i ) 
+    {
+
+        DepthUpdate u;
+
+        u.side      = rng() & 1;
+        u.size      = 100 + rng() % 900;
+
+        int& count  = rows[ u.side ];
+        int  roll   = rng() % 100;
+
+        if( count < 5 || ( roll < 10 && count < 20 ) ) 
+        {
+            u.operation = EOrderBook::OP_INSERT;
+            u.position  = rng() % ( count + 1 );
+            ++count;
+        }
+        else if( roll < 20 || count > 20 ) 
+        {
+            u.operation = EOrderBook::OP_DELETE;
+            u.position  = rng() % count;
+            --count;
+        }
+        else 
+        {
+            u.operation = EOrderBook::OP_UPDATE;
+            u.position  = ( rng() % 4 ) ? rng() % ( count < 3 ? count : 3 ) : rng() % count;
+        }
+
+        u.price     = 420.0 + ( u.side == EOrderBook::SIDE_ASK ? 1 : -1 ) * ( u.position + 1 ) * 0.01;
+
+        feed.push_back( u );
+
+    }
+
+    //****************************************************
+
+    typedef std::chrono::steady_clock Clock;
+
+    EOrderBook  book;
+    double      check = 0;
+
+    Clock::time_point t0 = Clock::now();
+
+    for( int i = 0; i < UPDATES; ++i ) 
+    {
+
+        const DepthUpdate& u = feed[ i ];
+
+        book.apply( u.position, u.operation, u.side, u.price, u.size );
+
+        check += book.bestBid() + book.bestAsk();
+
+    }
+
+    Clock::time_point t1 = Clock::now();
+
+    double imbalance = 0;
+
+    for( int i = 0; i < UPDATES / 10; ++i )
+        imbalance += book.imbalance( 1 + ( i & 7 ) );
+
+    Clock::time_point t2 = Clock::now();
+
+    //****************************************************
+
+    double applyNs      = std::chrono::duration< double, std::nano >( t1 - t0 ).count() / UPDATES;
+    double imbalanceNs  = std::chrono::duration< double, std::nano >( t2 - t1 ).count() / ( UPDATES / 10 );
+
+    printf( "updates           %d ( rejected %llu, rows %d / %d )\n", UPDATES, book.rejected(), book.depth( EOrderBook::SIDE_BID ), book.depth( EOrderBook::SIDE_ASK ) );
+    printf( "apply + top       %8.1f ns/update    %6.1f M updates/s\n", applyNs, 1000.0 / applyNs );
+    printf( "imbalance( <=8 )  %8.1f ns/call\n", imbalanceNs );
+    printf( "( checksum %g %g )\n", check, imbalance );
+
+    return book.rejected() ? 1 : 0;
+
+}
@@ -0,0 +1,175 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+//******************************************************************************************
+// encode time per order: EClient::placeOrder vs EClient::placeOrderFast
+//
+//      make bench && ./bench/OrderEncodeBench [orders]
+//
+// Frames go to a sink instead of a socket, so only encoding is measured. Both paths must
+// produce byte-identical frames, the benchmark checks that first.
+//******************************************************************************************
+
+#include "../StdAfx.h"
+#include "../source/EClient.h"
+#include "../source/EDecoder.h"
+#include "../source/DefaultEWrapper.h"
+#include "../source/EOrderTemplate.h"
+#include "../source/Order.h"
+#include "../source/Contract.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+
+
+//******************************************************************************************
+// EClient "connected" to nothing: keeps the last frame and counts bytes
+//******************************************************************************************
+
+class SinkClient : public EClient
+{
+
+public:
+
+    std::string         lastFrame;
+    size_t              bytes;
+
+    explicit SinkClient(    EWrapper*   wrapper     )
+
+        : EClient( wrapper, 0 )
+        , bytes  ( 0 )
+    {
+
+        sendConnectRequest();
+
+        m_serverVersion = MAX_CLIENT_VER;
+
+    }
+
+    void        eDisconnect         (   bool                                    ) {}
+
+protected:
+
+    void        prepareBufferImpl   (   std::ostream&   buf                     ) const
+    {
+        char header[ HEADER_LEN ] = { 0 };
+        buf.write( header, sizeof( header ) );
+    }
+
+    void        prepareBuffer       (   std::ostream&   buf                     ) const
+    {
+        prepareBufferImpl( buf );
+    }
+
+    bool        closeAndSend        (   std::string     msg, 
+                                        unsigned        offset                  )
+    {
+        bytes += msg.size() - offset;
+        lastFrame.swap( msg );
+        return true;
+    }
+
+private:
+
+    int         receive             (   char*, size_t                           ) { return 0; }
+    bool        isSocketOK          (                                           ) const { return true; }
+
+};
+
+//******************************************************************************************
+
+int main(   int argc, char** argv   )
+{
+
+    const int ORDERS = argc > 1 ? atoi( argv[ 1 ] ) : 200000;
+
+    DefaultEWrapper     wrapper;
+    SinkClient          client( &wrapper );
+
+    Contract contract;
+
+    contract.symbol     = "SPY";
+    contract.secType    = "STK";
+    contract.currency   = "USD";
+    contract.exchange   = "SMART";
+
+    Order order;
+
+    order.action        = "BUY";
+    order.orderType     = "LMT";
+    order.totalQuantity = 100;
+    order.lmtPrice      = 420.25;
+    order.tif           = "DAY";
+
+    EOrderTemplate tpl;
+
+    if( !client.prepareOrderTemplate( tpl, contract, order ) ) 
+    {
+        printf( "cannot prepare template\n" );
+        return 1;
+    }
+
+    //****************************************************
+    // same bytes on both paths
+    //****************************************************
+
+    const char* types[] = { "LMT", "MKT", "STP" };
+
+    for( int i = 0; i < 3; ++i ) 
+    {
+
+        order.orderType = types[ i ];
+        order.lmtPrice  = i == 0 ? 420.25 + i : UNSET_DOUBLE;
+        order.auxPrice  = i == 2 ? 419.5 : UNSET_DOUBLE;
+
+        client.placeOrder( 1000 + i, contract, order );
+        std::string slow = client.lastFrame;
+
+        client.placeOrderFast( tpl, 1000 + i, order.action, order.totalQuantity, order.orderType, order.lmtPrice, order.auxPrice );
+
+        if( slow != client.lastFrame ) 
+        {
+            printf( "frame mismatch for %s\n", types[ i ] );
+            return 1;
+        }
+
+    }
+
+    order.orderType = "LMT";
+    order.auxPrice  = UNSET_DOUBLE;
+
+    typedef std::chrono::steady_clock Clock;
+
+    //****************************************************
+
+    Clock::time_point t0 = Clock::now();
+
+    for( int i = 0; i < ORDERS; ++i ) 
+    {
+        order.lmtPrice = 420.0 + ( i & 63 ) * 0.01;
+        client.placeOrder( i, contract, order );
+    }
+
+    Clock::time_point t1 = Clock::now();
+
+    for( int i = 0; i < ORDERS; ++i )
+        client.placeOrderFast( tpl, i, "BUY", 100, "LMT", 420.0 + ( i & 63 ) * 0.01, UNSET_DOUBLE );
+
+    Clock::time_point t2 = Clock::now();
+
+    //****************************************************
+
+    double slowNs = std::chrono::duration< double, std::nano >( t1 - t0 ).count() / ORDERS;
+    double fastNs = std::chrono::duration< double, std::nano >( t2 - t1 ).count() / ORDERS;
+
+    printf( "orders            %d ( frame %zu bytes )\n", ORDERS, tpl.frameSize() );
+    printf( "placeOrder        %8.1f ns/order\n", slowNs );
+    printf( "placeOrderFast    %8.1f ns/order\n", fastNs );
+    printf( "speedup           %8.1fx\n", slowNs / fastNs );
+
+    return 0;
+
+}
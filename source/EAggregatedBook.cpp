@@ -0,0 +1,370 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EAggregatedBook.h"
+
+#include <string.h>
+
+
+namespace {
+
+    const int   OP_INSERT   = 0;
+    const int   OP_UPDATE   = 1;
+    const int   OP_DELETE   = 2;
+
+}
+
+
+//***************************************************************************************************
+
+EAggregatedBook::EAggregatedBook(       EStringInterner*    venues, 
+                                        int                 maxDepth        )
+
+    : m_pVenues         (   venues ? venues : &m_ownVenues                  )
+    , m_maxDepth        (   maxDepth > 0 ? maxDepth : 1                     )
+    , m_rows            (   2 * m_maxDepth                                  )
+    , m_levels          (   2 * m_maxDepth                                  )
+    , m_smartDepth      (   false                                           )
+    , m_updates         (   0                                               )
+    , m_rejected        (   0                                               )
+{
+
+    clear();
+
+}
+
+//***************************************************************************************************
+
+void EAggregatedBook::clear()
+{
+
+    for( int side = 0; side < 2; ++side ) 
+    {
+
+        m_rowCount[ side ]      = 0;
+        m_levelCount[ side ]    = 0;
+
+        m_venueCount[ side ].assign( m_venueCount[ side ].size(), 0 );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EAggregatedBook::ensureVenue( int venue )
+{
+
+    if( venue < ( int )m_venueCount[ SIDE_ASK ].size() )
+        return;
+
+    // a new venue is rare, grow with room for a few more
+    size_t venues = venue + 8;
+
+    for( int side = 0; side < 2; ++side ) 
+    {
+        m_venueCount[ side ].resize( venues, 0 );
+        m_venueLevels[ side ].resize( venues * m_maxDepth );
+    }
+
+}
+
+//***************************************************************************************************
+
+void EAggregatedBook::addTo(            EAggregatedLevel*   levels, 
+                                        int&                count, 
+                                        int                 side, 
+                                        const Row&          row             )
+{
+
+    int i = 0;
+
+    // shallow books: a linear walk from the top beats a binary search
+    if( side == SIDE_BID ) 
+    {
+        while( i < count && levels[ i ].price > row.price )
+            ++i;
+    }
+    else 
+    {
+        while( i < count && levels[ i ].price < row.price )
+            ++i;
+    }
+
+    if( i < count && levels[ i ].price == row.price ) 
+    {
+
+        levels[ i ].size += row.size;
+        levels[ i ].rows += 1;
+
+        return;
+
+    }
+
+    // never full: a side holds at most maxDepth rows, so as many distinct prices
+    if( count >= m_maxDepth )
+        return;
+
+    if( count > i )
+        memmove( levels + i + 1, levels + i, ( count - i ) * sizeof( EAggregatedLevel ) );
+
+    levels[ i ].price   = row.price;
+    levels[ i ].size    = row.size;
+    levels[ i ].rows    = 1;
+
+    ++count;
+
+}
+
+//***************************************************************************************************
+
+void EAggregatedBook::removeFrom(       EAggregatedLevel*   levels, 
+                                        int&                count, 
+                                        const Row&          row             )
+{
+
+    for( int i = 0; i < count; ++i ) 
+    {
+
+        if( levels[ i ].price != row.price )
+            continue;
+
+        levels[ i ].size -= row.size;
+
+        if( --levels[ i ].rows > 0 )
+            return;
+
+        --count;
+
+        if( count > i )
+            memmove( levels + i, levels + i + 1, ( count - i ) * sizeof( EAggregatedLevel ) );
+
+        return;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EAggregatedBook::contribute(       int             side, 
+                                        const Row&      row, 
+                                        int             sign            )
+{
+
+    EAggregatedLevel* consolidated  = &m_levels[ side * m_maxDepth ];
+    EAggregatedLevel* venue         = &m_venueLevels[ side ][ row.venue * m_maxDepth ];
+
+    if( sign > 0 ) 
+    {
+        addTo( consolidated, m_levelCount[ side ], side, row );
+        addTo( venue, m_venueCount[ side ][ row.venue ], side, row );
+    }
+    else 
+    {
+        removeFrom( consolidated, m_levelCount[ side ], row );
+        removeFrom( venue, m_venueCount[ side ][ row.venue ], row );
+    }
+
+}
+
+//***************************************************************************************************
+
+bool EAggregatedBook::apply(            int                 position, 
+                                        const std::string&  marketMaker, 
+                                        int                 operation, 
+                                        int                 side, 
+                                        double              price, 
+                                        int                 size, 
+                                        bool                isSmartDepth    )
+{
+
+    m_smartDepth = isSmartDepth;
+
+    // a delete does not need the code, but TWS sends it: interning a known one is cheap
+    return apply(       position, 
+                        m_pVenues->intern( marketMaker ), 
+                        operation, 
+                        side, 
+                        price, 
+                        size                                );
+
+}
+
+//***************************************************************************************************
+
+bool EAggregatedBook::apply(            int             position, 
+                                        int             venue, 
+                                        int             operation, 
+                                        int             side, 
+                                        double          price, 
+                                        int             size            )
+{
+
+    ++m_updates;
+
+    if( ( side != SIDE_ASK && side != SIDE_BID ) || position < 0 || venue < 0 ) 
+    {
+        ++m_rejected;
+        return false;
+    }
+
+    ensureVenue( venue );
+
+    Row*    rows    = &m_rows[ side * m_maxDepth ];
+    int&    count   = m_rowCount[ side ];
+
+    Row row;
+
+    row.price   = price;
+    row.size    = size;
+    row.venue   = venue;
+
+    switch( operation ) 
+    {
+
+        case OP_INSERT: 
+        {
+
+            if( position > count || position >= m_maxDepth )
+                break;
+
+            // a full side drops its worst row
+            if( count == m_maxDepth ) 
+            {
+                contribute( side, rows[ count - 1 ], -1 );
+                --count;
+            }
+
+            if( count > position )
+                memmove( rows + position + 1, rows + position, ( count - position ) * sizeof( Row ) );
+
+            rows[ position ] = row;
+
+            ++count;
+
+            contribute( side, row, +1 );
+
+            return true;
+
+        }
+
+        case OP_UPDATE:
+
+            if( position >= count )
+                break;
+
+            contribute( side, rows[ position ], -1 );
+
+            rows[ position ] = row;
+
+            contribute( side, row, +1 );
+
+            return true;
+
+        case OP_DELETE:
+
+            if( position >= count )
+                break;
+
+            contribute( side, rows[ position ], -1 );
+
+            --count;
+
+            if( count > position )
+                memmove( rows + position, rows + position + 1, ( count - position ) * sizeof( Row ) );
+
+            return true;
+
+        default:
+            break;
+
+    }
+
+    ++m_rejected;
+
+    return false;
+
+}
+
+//***************************************************************************************************
+
+double EAggregatedBook::bestBid() const
+{
+
+    return m_levelCount[ SIDE_BID ] ? levels( SIDE_BID )[ 0 ].price : 0;
+
+}
+
+//***************************************************************************************************
+
+double EAggregatedBook::bestAsk() const
+{
+
+    return m_levelCount[ SIDE_ASK ] ? levels( SIDE_ASK )[ 0 ].price : 0;
+
+}
+
+//***************************************************************************************************
+
+long long EAggregatedBook::cumulativeSize(      int         side, 
+                                                double      price       ) const
+{
+
+    if( side != SIDE_ASK && side != SIDE_BID )
+        return 0;
+
+    const EAggregatedLevel* book = levels( side );
+
+    long long total = 0;
+
+    for( int i = 0; i < m_levelCount[ side ]; ++i ) 
+    {
+
+        if( side == SIDE_BID ? book[ i ].price < price : book[ i ].price > price )
+            break;
+
+        total += book[ i ].size;
+
+    }
+
+    return total;
+
+}
+
+//***************************************************************************************************
+
+int EAggregatedBook::venueDepth(        int         venue, 
+                                        int         side            ) const
+{
+
+    if( venue < 0 || venue >= ( int )m_venueCount[ SIDE_ASK ].size() || ( side != SIDE_ASK && side != SIDE_BID ) )
+        return 0;
+
+    return m_venueCount[ side ][ venue ];
+
+}
+
+//***************************************************************************************************
+
+const EAggregatedLevel* EAggregatedBook::venueLevels(   int         venue, 
+                                                        int         side        ) const
+{
+
+    if( venueDepth( venue, side ) == 0 )
+        return 0;
+
+    return &m_venueLevels[ side ][ venue * m_maxDepth ];
+
+}
+
+//***************************************************************************************************
+
+const EAggregatedLevel* EAggregatedBook::bestForVenue(  int         venue, 
+                                                        int         side        ) const
+{
+
+    return venueLevels( venue, side );
+
+}
@@ -0,0 +1,150 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EAGGREGATEDBOOK_H
+#define TWS_API_CLIENT_EAGGREGATEDBOOK_H
+
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "EStringInterner.h"
+
+
+
+//******************************************************************************************
+
+struct EAggregatedLevel 
+{
+
+    double              price;
+    int                 size;           // summed over the rows at this price
+    int                 rows;           // market makers / venues quoting it
+
+};
+
+//******************************************************************************************
+// L2 book of one reqMktDepth subscription fed by updateMktDepthL2. Rows are applied by
+// position as TWS sends them; each row belongs to a venue, the market maker or, for
+// SMART depth, the exchange, interned once to a small id.
+//
+// Alongside the rows two views are kept up to date on every update, both as flat
+// price-sorted arrays, best first:
+//      - the consolidated book: one level per price over all venues
+//      - the book of each venue: its own levels, in one contiguous block per side
+//
+// so "best price on ARCA" or "size available up to 420.10" read arrays of numbers, with
+// no allocation and no string compared. Venue ids may come from an interner shared
+// by several books ( the same code then has the same id everywhere ).
+//******************************************************************************************
+
+class TWSAPIDLLEXP EAggregatedBook
+{
+
+    struct Row 
+    {
+        double              price;
+        int                 size;
+        int                 venue;
+    };
+
+    EStringInterner                     m_ownVenues;
+    EStringInterner*                    m_pVenues;
+
+    int                                 m_maxDepth;
+
+    std::vector< Row >                  m_rows;                 // [ ask rows ][ bid rows ]
+    int                                 m_rowCount[ 2 ];
+
+    std::vector< EAggregatedLevel >     m_levels;               // consolidated, [ ask ][ bid ]
+    int                                 m_levelCount[ 2 ];
+
+    std::vector< EAggregatedLevel >     m_venueLevels[ 2 ];     // maxDepth per venue, by venue id
+    std::vector< int >                  m_venueCount[ 2 ];
+
+    bool                                m_smartDepth;
+    unsigned long long                  m_updates;
+    unsigned long long                  m_rejected;
+
+
+    void                contribute          (       int                 side, 
+                                                    const Row&          row, 
+                                                    int                 sign                        );
+    void                addTo               (       EAggregatedLevel*   levels, 
+                                                    int&                count, 
+                                                    int                 side, 
+                                                    const Row&          row                         );
+    void                removeFrom          (       EAggregatedLevel*   levels, 
+                                                    int&                count, 
+                                                    const Row&          row                         );
+    void                ensureVenue         (       int                 venue                       );
+
+public:
+
+    // side values used by updateMktDepthL2
+    static const int    SIDE_ASK            = 0;
+    static const int    SIDE_BID            = 1;
+
+    static const int    DEFAULT_MAX_DEPTH   = 64;
+
+    // venues: interner shared with other books, or 0 for one of its own
+    explicit EAggregatedBook(                       EStringInterner*    venues      = 0, 
+                                                    int                 maxDepth    = DEFAULT_MAX_DEPTH );
+
+    // applies one updateMktDepthL2; false if rejected ( the book is out of sync )
+    bool                apply               (       int                 position, 
+                                                    const std::string&  marketMaker, 
+                                                    int                 operation, 
+                                                    int                 side, 
+                                                    double              price, 
+                                                    int                 size, 
+                                                    bool                isSmartDepth                );
+
+    // same, the market maker already interned
+    bool                apply               (       int                 position, 
+                                                    int                 venue, 
+                                                    int                 operation, 
+                                                    int                 side, 
+                                                    double              price, 
+                                                    int                 size                        );
+
+    void                clear               (                                                       );
+
+    // consolidated book
+    int                 depth               (       int                 side                        ) const { return m_levelCount[ side ];                  }
+    const EAggregatedLevel* levels          (       int                 side                        ) const { return &m_levels[ side * m_maxDepth ];        }
+    double              bestBid             (                                                       ) const;
+    double              bestAsk             (                                                       ) const;
+
+    // size offered at prices at least as good as 'price' ( bid: >= price, ask: <= price )
+    long long           cumulativeSize      (       int                 side, 
+                                                    double              price                       ) const;
+
+    // book of one venue; empty for a venue never seen on this book
+    int                 venueDepth          (       int                 venue, 
+                                                    int                 side                        ) const;
+    const EAggregatedLevel* venueLevels     (       int                 venue, 
+                                                    int                 side                        ) const;
+
+    // best level of the venue on that side, 0 if it quotes none
+    const EAggregatedLevel* bestForVenue    (       int                 venue, 
+                                                    int                 side                        ) const;
+
+    // venues
+    EStringInterner&    venues              (                                                       ) const { return *m_pVenues;    }
+    int                 venueId             (       const std::string&  code                        ) const { return m_pVenues->find( code );   }
+    const std::string&  venueName           (       int                 venue                       ) const { return m_pVenues->name( venue );  }
+
+    // rows as TWS addresses them
+    int                 rows                (       int                 side                        ) const { return m_rowCount[ side ];    }
+
+    bool                smartDepth          (                                                       ) const { return m_smartDepth;  }
+    int                 maxDepth            (                                                       ) const { return m_maxDepth;    }
+    unsigned long long  updates             (                                                       ) const { return m_updates;     }
+    unsigned long long  rejected            (                                                       ) const { return m_rejected;    }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,320 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EBarAggregator.h"
+
+
+//***************************************************************************************************
+
+EBarAggregator::EBarAggregator()
+
+    : m_pListener   (   0   )
+    , m_finished    (   0   )
+{
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::setListener( EBarListener* listener )
+{
+
+    m_pListener = listener;
+
+}
+
+//***************************************************************************************************
+
+int EBarAggregator::addSeries(          int             reqId, 
+                                        EBarKind        kind, 
+                                        long long       size, 
+                                        int             history         )
+{
+
+    if( size <= 0 || history <= 0 )
+        return -1;
+
+    Series series = Series();
+
+    series.reqId        = reqId;
+    series.kind         = kind;
+    series.size         = size;
+    series.open         = false;
+    series.empty        = true;
+    series.head         = 0;
+    series.stored       = 0;
+    series.notional     = 0;
+
+    series.history.resize( history );
+
+    m_series.push_back( series );
+
+    int id = ( int )m_series.size() - 1;
+
+    m_byReqId[ reqId ].push_back( id );
+
+    // worst case batch: every series closing two bars in the same call ( interval
+    // crossed, then the new bar full at once )
+    m_batch.reserve( 2 * m_series.size() );
+
+    return id;
+
+}
+
+//***************************************************************************************************
+
+const std::vector< int >* EBarAggregator::seriesOf( int reqId ) const
+{
+
+    std::map< int, std::vector< int > >::const_iterator it = m_byReqId.find( reqId );
+
+    return it == m_byReqId.end() ? 0 : &it->second;
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::start(             Series&         series, 
+                                        long long       time            )
+{
+
+    EBar& bar = series.current;
+
+    bar.time        = series.kind == BAR_TIME ? time - ( ( time % series.size ) + series.size ) % series.size : time;
+    bar.endTime     = time;
+    bar.volume      = 0;
+    bar.count       = 0;
+    bar.wap         = 0;
+
+    series.notional = 0;
+    series.open     = true;
+    series.empty    = true;
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::add(               Series&         series, 
+                                        long long       time, 
+                                        double          open, 
+                                        double          high, 
+                                        double          low, 
+                                        double          close, 
+                                        long long       volume, 
+                                        double          wap, 
+                                        int             count           )
+{
+
+    EBar& bar = series.current;
+
+    if( series.empty ) 
+    {
+        bar.open        = open;
+        bar.high        = high;
+        bar.low         = low;
+        series.empty    = false;
+    }
+    else 
+    {
+
+        if( high > bar.high )
+            bar.high = high;
+
+        if( low < bar.low )
+            bar.low = low;
+
+    }
+
+    bar.close        = close;
+    bar.endTime      = time;
+    bar.volume      += volume;
+    bar.count       += count;
+
+    series.notional += wap * volume;
+
+    bar.wap          = bar.volume > 0 ? series.notional / bar.volume : close;
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::finish( int index )
+{
+
+    Series& series = m_series[ index ];
+
+    series.history[ series.head ] = series.current;
+
+    series.head = ( series.head + 1 ) % series.history.size();
+
+    if( series.stored < series.history.size() )
+        ++series.stored;
+
+    series.open = false;
+
+    ++m_finished;
+
+    if( !m_pListener )
+        return;
+
+    EBarEvent event;
+
+    event.series    = index;
+    event.reqId     = series.reqId;
+    event.bar       = series.current;
+
+    m_batch.push_back( event );
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::dispatch()
+{
+
+    if( m_batch.empty() )
+        return;
+
+    if( m_pListener )
+        m_pListener->onBars( &m_batch[ 0 ], m_batch.size() );
+
+    m_batch.clear();
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::onTrade(           int             reqId, 
+                                        long long       time, 
+                                        double          price, 
+                                        long long       size            )
+{
+
+    const std::vector< int >* ids = seriesOf( reqId );
+
+    if( !ids )
+        return;
+
+    for( size_t i = 0; i < ids->size(); ++i ) 
+    {
+
+        int         index   = ( *ids )[ i ];
+        Series&     series  = m_series[ index ];
+
+        if( series.open && series.kind == BAR_TIME && time >= series.current.time + series.size )
+            finish( index );
+
+        if( !series.open )
+            start( series, time );
+
+        add( series, time, price, price, price, price, size, price, 1 );
+
+        if( ( series.kind == BAR_TICKS  && series.current.count  >= series.size ) || 
+            ( series.kind == BAR_VOLUME && series.current.volume >= series.size ) )
+            finish( index );
+
+    }
+
+    dispatch();
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::onRealtimeBar(     int             reqId, 
+                                        long long       time, 
+                                        double          open, 
+                                        double          high, 
+                                        double          low, 
+                                        double          close, 
+                                        long long       volume, 
+                                        double          wap, 
+                                        int             count           )
+{
+
+    const std::vector< int >* ids = seriesOf( reqId );
+
+    if( !ids )
+        return;
+
+    for( size_t i = 0; i < ids->size(); ++i ) 
+    {
+
+        int         index   = ( *ids )[ i ];
+        Series&     series  = m_series[ index ];
+
+        // trade and volume counts inside a 5 second bar are not known precisely enough,
+        // and a source bar would straddle the end of an interval not a multiple of 5s
+        if( series.kind != BAR_TIME || series.size % 5 != 0 )
+            continue;
+
+        if( series.open && time >= series.current.time + series.size )
+            finish( index );
+
+        if( !series.open )
+            start( series, time );
+
+        add( series, time, open, high, low, close, volume, wap, count );
+
+        // the source bar covering the last 5 seconds of the interval completes it
+        if( time + 5 >= series.current.time + series.size )
+            finish( index );
+
+    }
+
+    dispatch();
+
+}
+
+//***************************************************************************************************
+
+void EBarAggregator::advance( long long now )
+{
+
+    for( size_t i = 0; i < m_series.size(); ++i ) 
+    {
+
+        Series& series = m_series[ i ];
+
+        if( series.open && series.kind == BAR_TIME && now >= series.current.time + series.size )
+            finish( ( int )i );
+
+    }
+
+    dispatch();
+
+}
+
+//***************************************************************************************************
+
+int EBarAggregator::history( int series ) const
+{
+
+    return ( int )m_series[ series ].stored;
+
+}
+
+//***************************************************************************************************
+
+const EBar& EBarAggregator::bar(        int         series, 
+                                        int         ago             ) const
+{
+
+    const Series& s = m_series[ series ];
+
+    size_t size = s.history.size();
+
+    return s.history[ ( s.head + size - 1 - ( size_t )ago % size ) % size ];
+
+}
+
+//***************************************************************************************************
+
+const EBar* EBarAggregator::current( int series ) const
+{
+
+    const Series& s = m_series[ series ];
+
+    return s.open ? &s.current : 0;
+
+}
@@ -0,0 +1,171 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EBARAGGREGATOR_H
+#define TWS_API_CLIENT_EBARAGGREGATOR_H
+
+#include <map>
+#include <vector>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+
+enum EBarKind 
+{
+
+    BAR_TIME,           // size in seconds, aligned on multiples of it ( 60: every minute )
+    BAR_TICKS,          // size trades per bar
+    BAR_VOLUME          // a bar closes on the trade that brings its volume to size or more
+
+};
+
+//******************************************************************************************
+
+struct EBar 
+{
+
+    long long           time;           // first second of the bar ( time bars: the interval start )
+    long long           endTime;        // last trade or source bar included
+    double              open;
+    double              high;
+    double              low;
+    double              close;
+    long long           volume;
+    double              wap;            // volume weighted average price
+    int                 count;          // trades
+
+};
+
+//******************************************************************************************
+
+struct EBarEvent 
+{
+
+    int                 series;
+    int                 reqId;
+    EBar                bar;
+
+};
+
+//******************************************************************************************
+// receives the bars finished by one call to the aggregator, all at once
+
+struct EBarListener 
+{
+
+    virtual void    onBars          (       const EBarEvent*    events  ,   size_t  count   ) = 0;
+
+    virtual        ~EBarListener    () {}
+
+};
+
+//******************************************************************************************
+// builds any number of bar series per instrument, incrementally, from the trades of
+// tickByTickAllLast or the 5 second bars of realtimeBar ( feed a reqId from one of the
+// two; bars only make time series, of a multiple of 5 seconds, other series of that
+// reqId get nothing from them ).
+//
+// Each series keeps its last finished bars in a ring preallocated by addSeries(), so the
+// hot path never allocates. Bars finished by one call ( a trade can close a 1s, a 1m
+// and a volume bar at once ) reach the listener as one batch at the end of the call.
+//
+// Time bars close when a later trade arrives; call advance() with the current time to
+// close them on the clock instead ( quiet instruments ). Empty intervals make no bar.
+// Not thread safe: feed and read from one thread, typically the processMsgs one.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EBarAggregator
+{
+
+    struct Series 
+    {
+        int                 reqId;
+        EBarKind            kind;
+        long long           size;
+        bool                open;           // 'current' started
+        bool                empty;          // started, nothing added yet
+        EBar                current;
+        std::vector< EBar > history;        // ring of finished bars
+        size_t              head;           // next slot written
+        size_t              stored;
+        double              notional;       // price * size of the current bar, for the wap
+    };
+
+    std::vector< Series >                   m_series;
+    std::map< int, std::vector< int > >     m_byReqId;
+
+    EBarListener*                           m_pListener;
+    std::vector< EBarEvent >                m_batch;
+
+    unsigned long long                      m_finished;
+
+
+    void                start               (       Series&         series, 
+                                                    long long       time                            );
+    void                add                 (       Series&         series, 
+                                                    long long       time, 
+                                                    double          open, 
+                                                    double          high, 
+                                                    double          low, 
+                                                    double          close, 
+                                                    long long       volume, 
+                                                    double          wap, 
+                                                    int             count                           );
+    void                finish              (       int             index                           );
+    void                dispatch            (                                                       );
+
+    const std::vector< int >* seriesOf      (       int             reqId                           ) const;
+
+public:
+
+    static const int    DEFAULT_HISTORY     = 1024;
+
+    EBarAggregator();
+
+    void                setListener         (       EBarListener*   listener                        );
+
+    // returns the series id, -1 for an invalid size; allocates its history now
+    int                 addSeries           (       int             reqId, 
+                                                    EBarKind        kind, 
+                                                    long long       size, 
+                                                    int             history     = DEFAULT_HISTORY   );
+
+    // tickByTickAllLast
+    void                onTrade             (       int             reqId, 
+                                                    long long       time, 
+                                                    double          price, 
+                                                    long long       size                            );
+
+    // realtimeBar
+    void                onRealtimeBar       (       int             reqId, 
+                                                    long long       time, 
+                                                    double          open, 
+                                                    double          high, 
+                                                    double          low, 
+                                                    double          close, 
+                                                    long long       volume, 
+                                                    double          wap, 
+                                                    int             count                           );
+
+    // closes the time bars whose interval ended before 'now' ( epoch seconds )
+    void                advance             (       long long       now                             );
+
+    // finished bars of a series, 0 the most recent one; history() of them are kept
+    int                 history             (       int             series                          ) const;
+    const EBar&         bar                 (       int             series, 
+                                                    int             ago                             ) const;
+
+    // bar being built, 0 if none
+    const EBar*         current             (       int             series                          ) const;
+
+    int                 seriesCount         (                                                       ) const { return ( int )m_series.size();    }
+    unsigned long long  finished            (                                                       ) const { return m_finished;    }
+
+};
+
+//******************************************************************************************
+
+#endif
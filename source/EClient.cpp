@@ -17,6 +17,9 @@
 #include "ETransport.h"
 #include "FamilyCode.h"
 #include "EClientException.h"
+#include "EOrderTemplate.h"
+#include "ERequestJournal.h"
+#include "ELatencyProbe.h"
 
 #include <sstream>
 #include <iomanip>
@@ -30,6 +33,11 @@
 using namespace ibapi::client_constants;
 
 
+// ENCODE_FIELD that also records where the value sits in the frame ( EOrderTemplate )
+#define ENCODE_FIELD_MARKED(f, x)       { if( pTemplate ) pTemplate->markBegin( f, msg.tellp() ); ENCODE_FIELD(x)     if( pTemplate ) pTemplate->markEnd( f, msg.tellp() ); }
+#define ENCODE_FIELD_MAX_MARKED(f, x)   { if( pTemplate ) pTemplate->markBegin( f, msg.tellp() ); ENCODE_FIELD_MAX(x) if( pTemplate ) pTemplate->markEnd( f, msg.tellp() ); }
+
+
 //********************************************************************************************
 
 // encoders
@@ -232,6 +240,8 @@ EClient::EClient(       EWrapper    *ptr,
     , m_extraAuth       (       false                   )
     , m_serverVersion   (       0                       )
     , m_useV100Plus     (       true                    )
+    , m_pJournal        (       0                       )
+    , m_pProbe          (       0                       )
 {
 
     //nothing
@@ -576,6 +586,9 @@ void EClient::reqMktData(               TickerId                tickerId,
     //*************************
     //*************************
 
+    if( !snapshot && !regulatorySnaphsot )
+        journalRequest( REQ_MKT_DATA, tickerId, msg );
+
     closeAndSend( msg.str() );
     
     //*************************
@@ -616,6 +629,8 @@ void EClient::cancelMktData(  TickerId   tickerId  )
     //**************************
     //**************************
 
+    journalCancel( REQ_MKT_DATA, tickerId );
+
     closeAndSend(  msg.str()  );
 
     //**************************
@@ -758,6 +773,8 @@ void EClient::reqMktDepth(          TickerId                tickerId,
     //**************************
     //**************************
 
+    journalRequest( REQ_MKT_DEPTH, tickerId, msg );
+
     closeAndSend(  msg.str()  );
 
     //**************************
@@ -817,6 +834,8 @@ void EClient::cancelMktDepth(           TickerId    tickerId,
         ENCODE_FIELD(       isSmartDepth        );
     }
 
+    journalCancel( REQ_MKT_DEPTH, tickerId );
+
     closeAndSend( msg.str() );
 
 }
@@ -974,6 +993,9 @@ void EClient::reqHistoricalData(                TickerId                tickerId
     
     }
 
+    if( keepUpToDate )
+        journalRequest( REQ_HISTORICAL_DATA, tickerId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -1011,6 +1033,8 @@ void EClient::cancelHistoricalData(TickerId tickerId)
     ENCODE_FIELD(           VERSION                         );
     ENCODE_FIELD(           tickerId                        );
 
+    journalCancel( REQ_HISTORICAL_DATA, tickerId );
+
     closeAndSend( msg.str() );
 
 }
@@ -1119,6 +1143,8 @@ void EClient::reqRealTimeBars(              TickerId            tickerId,
     
     }
 
+    journalRequest( REQ_REAL_TIME_BARS, tickerId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -1157,6 +1183,8 @@ void EClient::cancelRealTimeBars(  TickerId  tickerId  )
     ENCODE_FIELD(           VERSION                         );
     ENCODE_FIELD(           tickerId                        );
 
+    journalCancel( REQ_REAL_TIME_BARS, tickerId );
+
     closeAndSend( msg.str() );
 
 }
@@ -1293,6 +1321,8 @@ void EClient::reqScannerSubscription(           int                     tickerId
     
     }
 
+    journalRequest( REQ_SCANNER_SUBSCRIPTION, tickerId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -1331,6 +1361,8 @@ void EClient::cancelScannerSubscription(  int  tickerId  )
     ENCODE_FIELD(           VERSION                                 );
     ENCODE_FIELD(           tickerId                                );
 
+    journalCancel( REQ_SCANNER_SUBSCRIPTION, tickerId );
+
     closeAndSend( msg.str() );
 
 }
@@ -1952,6 +1984,15 @@ void EClient::reqCurrentTime()
     //	return;
     //}
 
+    sendCurrentTime( false );
+
+}
+
+//*****************************************************************************************************************
+
+void EClient::sendCurrentTime( bool probe )
+{
+
     std::stringstream msg;
 
     prepareBuffer( msg );
@@ -1962,6 +2003,10 @@ void EClient::reqCurrentTime()
     ENCODE_FIELD(           REQ_CURRENT_TIME            );
     ENCODE_FIELD(           VERSION                     );
 
+    // timestamped before it can possibly be answered
+    if( m_pProbe )
+        m_pProbe->requestSent( probe );
+
     closeAndSend( msg.str() );
 
 }
@@ -1972,7 +2017,73 @@ void EClient::placeOrder(             OrderId           id,
                                 const Contract&         contract, 
                                 const Order&            order               )
 {
-    
+
+    std::stringstream msg;
+
+    if( !encodePlaceOrder(          msg, 
+                                    id, 
+                                    contract, 
+                                    order, 
+                                    0                       ) )
+        return;
+
+    //**************************
+    //**************************
+
+    closeAndSend(  msg.str()  );
+
+    //**************************
+    //**************************
+
+}
+
+//*********************************************************************************************
+
+bool EClient::prepareOrderTemplate(         EOrderTemplate&     tpl, 
+                                      const Contract&           contract, 
+                                      const Order&              order           )
+{
+
+    tpl.reset();
+
+    if( !EOrderTemplate::isSupportedOrderType( order.orderType ) ) 
+    {
+
+        m_pEWrapper->error(                 NO_VALID_ID, 
+                                            BAD_ORDER_TEMPLATE.code(), 
+                                            BAD_ORDER_TEMPLATE.msg() + "unsupported order type " + order.orderType      );
+
+        return false;
+
+    }
+
+    std::stringstream msg;
+
+    if( !encodePlaceOrder(          msg, 
+                                    0, 
+                                    contract, 
+                                    order, 
+                                    &tpl                    ) )
+        return false;
+
+    tpl.capture(            msg.str(), 
+                            m_serverVersion                 );
+
+    return tpl.valid();
+
+}
+
+//*********************************************************************************************
+
+void EClient::placeOrderFast(       const EOrderTemplate&       tpl, 
+                                          OrderId               id, 
+                                    const std::string&          action, 
+                                          double                totalQuantity, 
+                                    const std::string&          orderType, 
+                                          double                lmtPrice, 
+                                          double                auxPrice            )
+{
+
     // not connected?
     if( !isConnected() ) 
     {
@@ -1985,6 +2096,81 @@ void EClient::placeOrder(             OrderId           id,
     
     }
 
+    // a template only holds for the server version it was encoded against
+    if( !tpl.valid() || tpl.serverVersion() != m_serverVersion ) 
+    {
+
+        m_pEWrapper->error(                 id, 
+                                            BAD_ORDER_TEMPLATE.code(), 
+                                            BAD_ORDER_TEMPLATE.msg() + "template is stale, prepare it again"    );
+
+        return;
+
+    }
+
+    if( !EOrderTemplate::isSupportedOrderType( orderType ) ) 
+    {
+
+        m_pEWrapper->error(                 id, 
+                                            BAD_ORDER_TEMPLATE.code(), 
+                                            BAD_ORDER_TEMPLATE.msg() + "unsupported order type " + orderType    );
+
+        return;
+
+    }
+
+    if( !isAsciiPrintable( action ) ) 
+    {
+
+        m_pEWrapper->error(                 id, 
+                                            INVALID_SYMBOL.code(), 
+                                            INVALID_SYMBOL.msg() + action       );
+
+        return;
+
+    }
+
+    std::string frame;
+
+    tpl.render(             frame, 
+                            id, 
+                            action, 
+                            totalQuantity, 
+                            orderType, 
+                            lmtPrice, 
+                            auxPrice                        );
+
+    //**************************
+    //**************************
+
+    closeAndSend(  std::move( frame )  );
+
+    //**************************
+    //**************************
+
+}
+
+//*********************************************************************************************
+
+bool EClient::encodePlaceOrder(       std::ostream&           msg, 
+                                      OrderId                 id,             
+                                const Contract&               contract, 
+                                const Order&                  order, 
+                                      EOrderTemplate*         pTemplate       )
+{
+    
+    // not connected?
+    if( !isConnected() ) 
+    {
+
+        m_pEWrapper->error(                 id, 
+                                            NOT_CONNECTED.code(), 
+                                            NOT_CONNECTED.msg()                 );
+        
+        return false;
+    
+    }
+
     // Not needed anymore validation
     //if( m_serverVersion < MIN_SERVER_VER_SCALE_ORDERS) {
     //	if( order.scaleNumComponents != UNSET_INTEGER ||
@@ -1992,7 +2178,7 @@ void EClient::placeOrder(             OrderId           id,
     //		order.scalePriceIncrement != UNSET_DOUBLE) {
     //		m_pEWrapper->error( id, UPDATE_TWS.code(), UPDATE_TWS.msg() +
     //			"  It does not support Scale orders.");
-    //		return;
+    //		return false;
     //	}
     //}
     //
@@ -2009,7 +2195,7 @@ void EClient::placeOrder(             OrderId           id,
     //				!comboLeg->designatedLocation.IsEmpty()) {
     //				m_pEWrapper->error( id, UPDATE_TWS.code(), UPDATE_TWS.msg() +
     //					"  It does not support SSHORT flag for combo legs.");
-    //				return;
+    //				return false;
     //			}
     //		}
     //	}
@@ -2019,7 +2205,7 @@ void EClient::placeOrder(             OrderId           id,
     //	if( order.whatIf) {
     //		m_pEWrapper->error( id, UPDATE_TWS.code(), UPDATE_TWS.msg() +
     //			"  It does not support what-if orders.");
-    //		return;
+    //		return false;
     //	}
     //}
 
@@ -2033,7 +2219,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() +  "  It does not support delta-neutral orders."       );
         
-            return;
+            return false;
         
         }
 
@@ -2048,7 +2234,7 @@ void EClient::placeOrder(             OrderId           id,
             m_pEWrapper->error(                 id, 
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support Subsequent Level Size for Scale orders.");
-            return;
+            return false;
 
         }
 
@@ -2064,7 +2250,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support algo orders."         );
             
-            return;
+            return false;
 
         }
 
@@ -2080,7 +2266,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support notHeld parameter." );
         
-            return;
+            return false;
 
         }
 
@@ -2096,7 +2282,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support secIdType and secId parameters." );
             
-            return;
+            return false;
         
         }
 
@@ -2112,7 +2298,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support conId parameter.");
             
-            return;
+            return false;
         
         }
 
@@ -2128,7 +2314,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support exemptCode parameter.");
             
-            return;
+            return false;
 
         }
 
@@ -2155,7 +2341,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support exemptCode parameter.");
         
-                return;
+                return false;
             }
 
         }
@@ -2172,7 +2358,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support hedge orders.");
         
-            return;
+            return false;
 
         }
     
@@ -2188,7 +2374,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support optOutSmartRouting parameter.");
             
-            return;
+            return false;
 
         }
 
@@ -2207,7 +2393,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support deltaNeutral parameters: ConId, SettlingFirm, ClearingAccount, ClearingIntent.");
                 
-                return;
+                return false;
         
         }
 
@@ -2226,7 +2412,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support deltaNeutral parameters: OpenClose, ShortSale, ShortSaleSlot, DesignatedLocation.");
             
-                return;
+                return false;
         
         }
 
@@ -2253,7 +2439,7 @@ void EClient::placeOrder(             OrderId           id,
                                                     "  It does not support Scale order parameters: PriceAdjustValue, PriceAdjustInterval, " +
                                                     "ProfitOffset, AutoReset, InitPosition, InitFillQty and RandomPercent");
         
-                    return;
+                    return false;
         
             }
 
@@ -2282,7 +2468,7 @@ void EClient::placeOrder(             OrderId           id,
                                                 UPDATE_TWS.code(), 
                                                 UPDATE_TWS.msg() + "  It does not support per-leg prices for order combo legs.");
                 
-                return;
+                return false;
 
             }
 
@@ -2300,7 +2486,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support trailing percent parameter");
             
-            return;
+            return false;
         }
 
     }
@@ -2315,7 +2501,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support tradingClass parameter in placeOrder.");
             
-            return;
+            return false;
         
         }
 
@@ -2331,7 +2517,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support scaleTable, activeStartTime and activeStopTime parameters");
         
-            return;
+            return false;
 
         }
 
@@ -2347,7 +2533,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support algoId parameter");
             
-            return;
+            return false;
 
         }
     
@@ -2363,7 +2549,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support order solicited parameter.");
             
-            return;
+            return false;
         
         }
     
@@ -2379,7 +2565,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support model code parameter.");
         
-            return;
+            return false;
 
         }
 
@@ -2395,7 +2581,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support ext operator parameter");
             
-            return;
+            return false;
         
         }
     
@@ -2411,7 +2597,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support soft dollar tier");
             
-            return;
+            return false;
 
         }
 
@@ -2427,7 +2613,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + "  It does not support cash quantity parameter");
             
-            return;
+            return false;
         
         }
 
@@ -2442,7 +2628,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support MIFID II decision maker parameters");
     
-            return;
+            return false;
     
     }
 
@@ -2455,7 +2641,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support MIFID II execution parameters");
         
-            return;
+            return false;
     }
 
     if ( m_serverVersion < MIN_SERVER_VER_AUTO_PRICE_FOR_HEDGE
@@ -2466,7 +2652,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support don't use auto price for hedge parameter");
             
-            return;
+            return false;
 
     }
 
@@ -2478,7 +2664,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support oms container parameter");
             
-            return;
+            return false;
 
     }
 
@@ -2490,7 +2676,7 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support D-Peg orders");
             
-            return;
+            return false;
     
     }
 
@@ -2502,12 +2688,10 @@ void EClient::placeOrder(             OrderId           id,
                                             UPDATE_TWS.code(), 
                                             UPDATE_TWS.msg() + " It does not support Use Price Management Algo requests");
 
-            return;
+            return false;
     
     }
 
-    std::stringstream msg;
-
     prepareBuffer(  msg  );
 
     try 
@@ -2523,7 +2707,7 @@ void EClient::placeOrder(             OrderId           id,
             ENCODE_FIELD(           VERSION                     );
         }
 
-        ENCODE_FIELD( id );
+        ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_ORDER_ID,     id      );
 
         // send contract fields
         if( m_serverVersion >= MIN_SERVER_VER_PLACE_ORDER_CONID ) 
@@ -2554,31 +2738,31 @@ void EClient::placeOrder(             OrderId           id,
         }
 
         // send main order fields
-        ENCODE_FIELD(           order.action            );
+        ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_ACTION,       order.action            );
 
         if ( m_serverVersion >= MIN_SERVER_VER_FRACTIONAL_POSITIONS ) 
-            ENCODE_FIELD(           order.totalQuantity             )
+            ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_TOTAL_QUANTITY,       order.totalQuantity     )
         else
-            ENCODE_FIELD(     (long)order.totalQuantity             )
+            ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_TOTAL_QUANTITY, (long)order.totalQuantity     )
 
-        ENCODE_FIELD(           order.orderType         );
+        ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_ORDER_TYPE,   order.orderType         );
 
         if( m_serverVersion < MIN_SERVER_VER_ORDER_COMBO_LEGS_PRICE ) 
         {
-            ENCODE_FIELD(       order.lmtPrice == UNSET_DOUBLE ? 0 : order.lmtPrice     );
+            ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_LMT_PRICE,    order.lmtPrice == UNSET_DOUBLE ? 0 : order.lmtPrice     );
         }
         else 
         {
-            ENCODE_FIELD_MAX( order.lmtPrice);
+            ENCODE_FIELD_MAX_MARKED(    EOrderTemplate::FIELD_LMT_PRICE,    order.lmtPrice      );
         }
         
         if( m_serverVersion < MIN_SERVER_VER_TRAILING_PERCENT ) 
         {
-            ENCODE_FIELD(       order.auxPrice == UNSET_DOUBLE ? 0 : order.auxPrice     );
+            ENCODE_FIELD_MARKED(    EOrderTemplate::FIELD_AUX_PRICE,    order.auxPrice == UNSET_DOUBLE ? 0 : order.auxPrice     );
         }
         else 
         {
-            ENCODE_FIELD_MAX(           order.auxPrice              );
+            ENCODE_FIELD_MAX_MARKED(    EOrderTemplate::FIELD_AUX_PRICE,    order.auxPrice      );
         }
 
         // send extended order fields
@@ -3056,17 +3240,11 @@ void EClient::placeOrder(             OrderId           id,
                                             ex.error().code(), 
                                             ex.error().msg() + ex.text()                );
         
-        return;
+        return false;
     
     }
 
-    //**************************
-    //**************************
-
-    closeAndSend(  msg.str()  );
-
-    //**************************
-    //**************************
+    return true;
 
 }
 
@@ -3158,6 +3336,11 @@ void EClient::reqAccountUpdates(            bool            subscribe,
 
     }
 
+    if( subscribe )
+        journalRequest( REQ_ACCT_DATA, 0, msg );
+    else
+        journalCancel( REQ_ACCT_DATA, 0 );
+
     closeAndSend( msg.str() );
 
 }
@@ -3222,6 +3405,11 @@ void EClient::reqAutoOpenOrders(  bool  bAutoBind  )
     ENCODE_FIELD( VERSION);
     ENCODE_FIELD( bAutoBind);
 
+    if( bAutoBind )
+        journalRequest( REQ_AUTO_OPEN_ORDERS, 0, msg );
+    else
+        journalCancel( REQ_AUTO_OPEN_ORDERS, 0 );
+
     closeAndSend( msg.str());
 }
 
@@ -3385,6 +3573,8 @@ void EClient::reqNewsBulletins(  bool allMsgs  )
     ENCODE_FIELD(           VERSION                     );
     ENCODE_FIELD(           allMsgs                     );
 
+    journalRequest( REQ_NEWS_BULLETINS, 0, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -3415,6 +3605,8 @@ void EClient::cancelNewsBulletins()
     ENCODE_FIELD(           CANCEL_NEWS_BULLETINS           );
     ENCODE_FIELD(           VERSION                         );
 
+    journalCancel( REQ_NEWS_BULLETINS, 0 );
+
     closeAndSend( msg.str() );
 
 }
@@ -3755,6 +3947,8 @@ void EClient::reqMarketDataType(  int  marketDataType  )
     ENCODE_FIELD(           VERSION                         );
     ENCODE_FIELD(           marketDataType                  );
 
+    journalRequest( REQ_MARKET_DATA_TYPE, 0, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -3796,6 +3990,8 @@ void EClient::reqPositions()
     ENCODE_FIELD(           REQ_POSITIONS           );
     ENCODE_FIELD(           VERSION                 );
 
+    journalRequest( REQ_POSITIONS, 0, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -3836,6 +4032,8 @@ void EClient::cancelPositions()
     ENCODE_FIELD(           CANCEL_POSITIONS            );
     ENCODE_FIELD(           VERSION                     );
 
+    journalCancel( REQ_POSITIONS, 0 );
+
     closeAndSend( msg.str() );
 
 }
@@ -3897,6 +4095,8 @@ void EClient::reqAccountSummary(            int             reqId,
     
     }
 
+    journalRequest( REQ_ACCOUNT_SUMMARY, reqId, msg );
+
     closeAndSend(  msg.str() );
 
 }
@@ -3939,6 +4139,8 @@ void EClient::cancelAccountSummary( int  reqId )
     ENCODE_FIELD(           VERSION                             );
     ENCODE_FIELD(           reqId                               );
 
+    journalCancel( REQ_ACCOUNT_SUMMARY, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -4510,6 +4712,8 @@ void EClient::reqPositionsMulti(            int             reqId,
     
     }
 
+    journalRequest( REQ_POSITIONS_MULTI, reqId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -4552,6 +4756,8 @@ void EClient::cancelPositionsMulti(  int  reqId )
     ENCODE_FIELD(           VERSION                             );
     ENCODE_FIELD(           reqId                               );
 
+    journalCancel( REQ_POSITIONS_MULTI, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -4615,6 +4821,8 @@ void EClient::reqAccountUpdatesMulti(           int             reqId,
     
     }
 
+    journalRequest( REQ_ACCOUNT_UPDATES_MULTI, reqId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -4657,6 +4865,8 @@ void EClient::cancelAccountUpdatesMulti(  int  reqId  )
     ENCODE_FIELD(           VERSION                                 );
     ENCODE_FIELD(           reqId                                   );
 
+    journalCancel( REQ_ACCOUNT_UPDATES_MULTI, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -5404,6 +5614,8 @@ void EClient::reqPnL(           int             reqId,
     
     }
 
+    journalRequest( REQ_PNL, reqId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -5442,6 +5654,8 @@ void EClient::cancelPnL(  int  reqId  )
     ENCODE_FIELD(           CANCEL_PNL          );
     ENCODE_FIELD(           reqId               );
 
+    journalCancel( REQ_PNL, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -5501,6 +5715,8 @@ void EClient::reqPnLSingle(             int             reqId,
     
     }
 
+    journalRequest( REQ_PNL_SINGLE, reqId, msg );
+
     closeAndSend( msg.str() );
 
 }
@@ -5539,6 +5755,8 @@ void EClient::cancelPnLSingle(  int  reqId  )
     ENCODE_FIELD(           CANCEL_PNL_SINGLE           );
     ENCODE_FIELD(           reqId                       );
 
+    journalCancel( REQ_PNL_SINGLE, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -5699,6 +5917,8 @@ void EClient::reqTickByTickData(            int             reqId,
     
     }
 
+    journalRequest( REQ_TICK_BY_TICK_DATA, reqId, msg );
+
     closeAndSend( msg.str() );
     
 }
@@ -5737,6 +5957,8 @@ void EClient::cancelTickByTickData( int  reqId )
     ENCODE_FIELD(           CANCEL_TICK_BY_TICK_DATA            );
     ENCODE_FIELD(           reqId                               );
 
+    journalCancel( REQ_TICK_BY_TICK_DATA, reqId );
+
     closeAndSend( msg.str() );
 
 }
@@ -5894,4 +6116,143 @@ int EClient::sendConnectRequest()
 
 }
 
-//********************************************************************************************
\ No newline at end of file
+//********************************************************************************************
+
+void EClient::setRequestJournal( ERequestJournal* journal )
+{
+
+    m_pJournal = journal;
+
+}
+
+//********************************************************************************************
+
+ERequestJournal* EClient::requestJournal() const
+{
+
+    return m_pJournal;
+
+}
+
+//********************************************************************************************
+
+void EClient::journalRequest(       int                         msgId, 
+                                    int                         reqId, 
+                                    const std::stringstream&    msg         )
+{
+
+    if( m_pJournal )
+        m_pJournal->record( msgId, reqId, msg.str(), m_serverVersion );
+
+}
+
+//********************************************************************************************
+
+void EClient::journalCancel(        int         msgId, 
+                                    int         reqId       )
+{
+
+    if( m_pJournal )
+        m_pJournal->erase( msgId, reqId );
+
+}
+
+//********************************************************************************************
+
+void EClient::setLatencyProbe( ELatencyProbe* probe )
+{
+
+    m_pProbe = probe;
+
+}
+
+//********************************************************************************************
+
+ELatencyProbe* EClient::latencyProbe() const
+{
+
+    return m_pProbe;
+
+}
+
+//********************************************************************************************
+
+bool EClient::latencyProbeDue() const
+{
+
+    return m_pProbe && isConnected() && m_pProbe->due();
+
+}
+
+//********************************************************************************************
+
+bool EClient::pollLatencyProbe()
+{
+
+    if( !latencyProbeDue() )
+        return false;
+
+    sendCurrentTime( true );
+
+    return true;
+
+}
+
+//********************************************************************************************
+
+int EClient::replayRequestJournal()
+{
+
+    if( !m_pJournal || !isConnected() )
+        return 0;
+
+    std::vector< std::string >  frames;
+    size_t                      stale = 0;
+
+    m_pJournal->snapshot( m_serverVersion, frames, stale );
+
+    if( stale > 0 ) 
+    {
+
+        std::stringstream text;
+
+        text << stale << " request(s) dropped";
+
+        m_pEWrapper->error(     NO_VALID_ID, 
+                                STALE_REQUEST_JOURNAL.code(), 
+                                STALE_REQUEST_JOURNAL.msg() + text.str()        );
+
+    }
+
+    for( size_t i = 0; i < frames.size(); ++i )
+        closeAndSend( frames[ i ] );
+
+    return (int)frames.size();
+
+}
+
+//********************************************************************************************
+
+bool EClient::forwardRequest(       int                     msgId, 
+                                    int                     reqId, 
+                                    const std::string&      fields, 
+                                    bool                    standing    )
+{
+
+    if( !isConnected() || fields.empty() )
+        return false;
+
+    std::stringstream msg;
+
+    prepareBuffer(  msg  );
+
+    msg.write( fields.data(), fields.size() );
+
+    if( standing )
+        journalRequest( msgId, reqId, msg );
+
+    return closeAndSend( msg.str() );
+
+}
+
+//********************************************************************************************
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <ostream>
+#include <sstream>
 #include "platformspecific.h"
 #include "CommonDefs.h"
 #include "TagValue.h"
@@ -210,6 +211,9 @@ struct ScannerSubscription;
 struct ETransport;
 
 class EWrapper;
+class EOrderTemplate;
+class ERequestJournal;
+class ELatencyProbe;
 
 
 //******************************************************************************************
@@ -315,6 +319,20 @@ public:
 													const Contract& 			contract, 
 													const Order& 				order							);
 
+	// fast path for plain LMT / MKT / STP orders: encode a template once per contract and
+	// order setup, then place or modify ( same id ) patching only the per-order fields
+	bool 		prepareOrderTemplate	(			EOrderTemplate& 			tpl, 
+													const Contract& 			contract, 
+													const Order& 				order							);
+
+	void 		placeOrderFast			(			const EOrderTemplate& 		tpl, 
+													OrderId 					id, 
+													const std::string& 			action, 
+													double 						totalQuantity, 
+													const std::string& 			orderType, 
+													double 						lmtPrice, 
+													double 						auxPrice						);
+
 	void 		cancelOrder				(			OrderId 					id								);
 	
 	void 		reqOpenOrders			();
@@ -554,6 +572,30 @@ public:
 	void 		cancelTickByTickData	(			int 						reqId							);
       
 	void 		reqCompletedOrders		(			bool 						apiOnly							);
+
+	// standing requests ( subscriptions and their cancels ) are recorded in the journal,
+	// if one is set, so that a new connection can re-issue them with replayRequestJournal()
+	void 		setRequestJournal		(			ERequestJournal* 			journal							);
+	ERequestJournal* requestJournal		(																) const;
+
+	// re-sends the recorded requests through closeAndSend ( so paced ), returns how many
+	int 		replayRequestJournal	(																);
+
+	// sends a request encoded by another client ( its fields, without the length prefix )
+	// as is, e.g. one relayed by EGateway; a standing one is journaled under msgId / reqId
+	bool 		forwardRequest			(			int 						msgId, 
+													int 						reqId, 
+													const std::string& 			fields, 
+													bool 						standing						);
+
+	// reqCurrentTime round trips are measured by the probe, if one is set ( before
+	// connecting ), which also sends probes of its own from pollLatencyProbe()
+	void 		setLatencyProbe			(			ELatencyProbe* 				probe							);
+	ELatencyProbe* latencyProbe			(																) const;
+
+	// sends a probe if one is due, returns true if it did. Called from processMsgs
+	bool 		pollLatencyProbe		(																);
+	bool 		latencyProbeDue			(																) const;
 	
 
 
@@ -565,6 +607,21 @@ private:
 
 	static bool 	isAsciiPrintable	( 			const std::string& 			s 								);
 
+	void 			journalRequest		(			int 						msgId, 
+													int 						reqId, 
+													const std::stringstream& 	msg								);
+
+	void 			journalCancel		(			int 						msgId, 
+													int 						reqId							);
+
+	void 			sendCurrentTime		(			bool 						probe							);
+
+	bool 			encodePlaceOrder	(			std::ostream& 				msg, 
+													OrderId 					id, 
+													const Contract& 			contract, 
+													const Order& 				order, 
+													EOrderTemplate* 			pTemplate						);
+
 protected:
 
 	virtual void 	prepareBufferImpl	(			std::ostream&												) const = 0;
@@ -640,6 +697,11 @@ protected:
 
 	bool 			m_useV100Plus;
 
+private:
+
+	ERequestJournal* 	m_pJournal;
+	ELatencyProbe* 		m_pProbe;
+
 };
 
 //******************************************************************************************
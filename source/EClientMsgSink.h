@@ -14,6 +14,12 @@ struct EClientMsgSink
     virtual void    serverVersion   (       int             version ,   const char*     time    ) = 0;
     
     virtual void    redirect        (       const char*     host    ,   int             port    ) = 0;
+
+    // true if the reply answered the client's own latency probe and is not for the EWrapper
+    virtual bool    currentTimeReply(       long            time                                ) = 0;
+
+    // sees message ids while the connection starts up, false once it needs no more
+    virtual bool    startupMessage  (       int             msgId                               ) = 0;
     
     virtual        ~EClientMsgSink  () {}
 
@@ -13,8 +13,11 @@
 #include "EReaderSignal.h"
 #include "EReader.h"
 #include "EMessage.h"
+#include "ELatencyProbe.h"
 
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <ostream>
 
@@ -34,6 +37,27 @@ EClientSocket::EClientSocket(	EWrapper *ptr,  EReaderSignal  *pSignal   )
     m_pSignal 			= 	pSignal;
     m_redirectCount 	= 	0;
 
+	m_concurrentSubmission 	= 	false;
+	m_pipelining 			= 	false;
+	m_pipeliningThread 		= 	std::thread::id();
+	m_wakePending 			= 	false;
+	m_wakePipe[ 0 ] 		= 	-1;
+	m_wakePipe[ 1 ] 		= 	-1;
+
+	m_connectAddrIdx 		= 	0;
+	m_connectPending 		= 	false;
+	m_connectArmed 			= 	false;
+	m_connectTimeoutMs 		= 	DEFAULT_CONNECT_TIMEOUT_MS;
+
+	m_connections 			= 	0;
+
+	m_pTap 					= 	0;
+	m_pQuotes 				= 	0;
+	m_pTickByTick 			= 	0;
+
+	// nothing granted until a handshake completed
+	m_effectiveOptions.tcpNoDelay = false;
+
 }
 
 //*******************************************************************************************************************
@@ -41,6 +65,18 @@ EClientSocket::EClientSocket(	EWrapper *ptr,  EReaderSignal  *pSignal   )
 EClientSocket::~EClientSocket()
 {
 
+#if defined(IB_POSIX)
+
+	if( m_wakePipe[ 0 ] >= 0 ) 
+	{
+
+		close( m_wakePipe[ 0 ] );
+		close( m_wakePipe[ 1 ] );
+
+	}
+
+#endif
+
 	if( m_fd != -2 )
 		SocketsDestroy();
 
@@ -84,12 +120,200 @@ void EClientSocket::asyncEConnect( 	bool  val )
 
 //*******************************************************************************************************************
 
+void EClientSocket::setPacing(			double 			rate, 
+										double 			burst					)
+{
+
+	m_pacer.configure( 			rate, 
+								burst 								);
+
+}
+
+//*******************************************************************************************************************
+
+EPacer& EClientSocket::pacer()
+{
+
+	return m_pacer;
+
+}
+
+//*******************************************************************************************************************
+
+const EPacer& EClientSocket::pacer() const
+{
+
+	return m_pacer;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::setConcurrentSubmission( 	bool 	val 	)
+{
+
+#if defined(IB_POSIX)
+
+	/*
+
+		#include <unistd.h>
+
+		int pipe(	int pipefd[ 2 ]		);
+
+		The wake pipe lets producers interrupt the sender's select() as soon as a frame
+		is queued instead of waiting for its timeout. Both ends are non-blocking, at most
+		one byte is pending at a time thanks to m_wakePending.
+
+	*/
+
+	if( val && m_wakePipe[ 0 ] < 0 && pipe( m_wakePipe ) == 0 ) 
+	{
+
+		SetSocketNonBlocking( m_wakePipe[ 0 ] );
+		SetSocketNonBlocking( m_wakePipe[ 1 ] );
+
+	}
+
+#endif
+
+	m_concurrentSubmission = val;
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::concurrentSubmission() const
+{
+
+	return m_concurrentSubmission;
+
+}
+
+//*******************************************************************************************************************
+
+size_t EClientSocket::submissionQueueDepth() const
+{
+
+	return m_submissions.size();
+
+}
+
+//*******************************************************************************************************************
+
+int EClientSocket::wakeFd() const
+{
+
+	return m_concurrentSubmission ? m_wakePipe[ 0 ] : -1;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::wakeSender()
+{
+
+	if( m_wakePending.exchange( true ) )
+		return;
+
+#if defined(IB_POSIX)
+
+	if( m_wakePipe[ 1 ] >= 0 ) 
+	{
+
+		char c = 0;
+
+		if( ::write( m_wakePipe[ 1 ], &c, 1 ) < 0 ) 
+		{
+			// pipe full: a wakeup is pending anyway
+		}
+
+	}
+
+#endif
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::drainSubmissions()
+{
+
+	bool woken = m_wakePending.exchange( false );
+
+#if defined(IB_POSIX)
+
+	if( woken && m_wakePipe[ 0 ] >= 0 ) 
+	{
+
+		char sink[ 64 ];
+
+		while( ::read( m_wakePipe[ 0 ], sink, sizeof( sink ) ) > 0 );
+
+	}
+
+#else
+
+	(void)woken;
+
+#endif
+
+	std::string frame;
+
+	while( isSocketOK() && m_submissions.pop( frame ) ) 
+	{
+
+		if( !sendFrame( frame ) && !isSocketOK() )
+			return;
+
+	}
+
+	if( !isSocketOK() )
+		return;
+
+	flushPaced();
+
+	if ( getTransport()->sendBufferedData() < 0 )
+		handleSocketError();
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::discardSubmissions()
+{
+
+	std::string frame;
+
+	while( m_submissions.pop( frame ) );
+
+}
+
+//*******************************************************************************************************************
+
 bool EClientSocket::eConnect(			const char*		host, 
 										int 			port, 
 										int 			clientId, 
 										bool 			extraAuth				)
 {
 
+	if( !prepareConnect( 	host, 
+							port 		) )
+		return false;
+
+	// try to connect to specified host and port
+	ConnState resState = CS_DISCONNECTED;
+
+    return eConnectImpl( 				clientId, 
+										extraAuth, 
+										&resState									);
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::prepareConnect(		const char*		host, 
+										int 			port 					)
+{
 
 	if( m_fd == -2 ) 
 	{
@@ -126,12 +350,38 @@ bool EClientSocket::eConnect(			const char*		host,
 	setHost( 	hostNorm 	);
 	setPort( 	port	  	);
 
-	// try to connect to specified host and port
-	ConnState resState = CS_DISCONNECTED;
+	m_startup.reset();
+	m_startup.mark( STARTUP_CONNECT_BEGIN );
 
-    return eConnectImpl( 				clientId, 
-										extraAuth, 
-										&resState									);
+	return true;
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::eConnectAsync(			const char*		host, 
+											int 			port, 
+											int 			clientId, 
+											bool 			extraAuth				)
+{
+
+	if( !prepareConnect( 	host, 
+							port 		) )
+		return false;
+
+	setClientId ( 	clientId  	);
+	setExtraAuth( 	extraAuth 	);
+
+	discardSubmissions();
+
+	if( !resolveHost() )
+		return false;
+
+	armConnectDeadline();
+
+	// the rest happens on the EReader thread: driveConnect() finishes the TCP connect and
+	// sends the handshake, EDecoder::processConnectAck reports connectAck()
+	return beginConnect() == 0;
 
 }
 
@@ -166,215 +416,532 @@ bool EClientSocket::eConnectImpl(			int 			clientId,
 											ConnState* 		stateOutPt				)
 {
 
-	/*
+	// frames queued by producers for a previous connection must not leak into this one;
+	// no sender runs while connecting so it is safe to consume them here
+	discardSubmissions();
 
-		#include <netdb.h>
 
-       	struct hostent *gethostbyname(  const char  *name  );
+	if( !resolveHost() )
+		return false;
+
+	armConnectDeadline();
 
-		The gethostbyname() function returns a structure of type hostent
-       	for the given host name.  Here name is either a hostname or an
-       	IPv4 address in standard dot notation ( as for inet_addr(3) )
 
-	*/
+	//*********************************************************************
+	// connects to server: non-blocking connect, bounded by the deadline,
+	// falling back to the next resolved address on failure
+	//*********************************************************************
+
+	int state = beginConnect();
+
+	while( state == 0 )
+		state = pollConnect( 100 );
+
+	if( state < 0 )
+		return false;
+
+	m_startup.mark( STARTUP_TCP_CONNECTED );
+
+	//*********************************************************************
+	//*********************************************************************
+
+    getTransport()->fd( m_fd );
+
+	// set client id
+	setClientId ( 	clientId  	);
+	setExtraAuth( 	extraAuth 	);
 
-	struct hostent* hostEnt = gethostbyname(  	host().c_str() 	  );
 
+    int res = sendConnectRequest();
+
+
+	if ( res < 0 && !handleSocketError() )
+		return false;
+
+	if( isConnected() )
+		m_startup.mark( STARTUP_HANDSHAKE_SENT );
+
+	if( !isConnected() ) 
+	{
+
+		if( connState() != CS_DISCONNECTED ) 
+		{
+	
+			assert( connState() == CS_REDIRECT );
+	
+			if( stateOutPt ) 
+			{
+				*stateOutPt = connState();
+			}
+
+			eDisconnect();
+	
+		}
+
+		return false;
+	
+	}
 
-	if ( !hostEnt ) 
+	// set socket to non-blocking state
+	if ( !SetSocketNonBlocking( m_fd ) ) 
 	{
 
+		// error setting socket to non-blocking
+	
+		eDisconnect();
+	
 		getWrapper()->error( 				NO_VALID_ID, 
 											CONNECT_FAIL.code(), 
 											CONNECT_FAIL.msg()						);
-		
+	
 		return false;
+
+	}
+
+	assert( connState() == CS_CONNECTED );
 	
+	if(  stateOutPt ) 
+	{
+		*stateOutPt = connState();
 	}
 
+    if ( !m_asyncEConnect ) 
+	{
 
-	//************************************************************
-	// creates socket
-	//************************************************************
+        EReader reader( this, m_pSignal );
+
+		reader.putMessageToQueue();
+
+        while ( m_pSignal && !m_serverVersion && isSocketOK() ) 
+		{
+
+            m_pSignal->waitForSignal();
+            
+			reader.processMsgs();
+        
+		}
+
+    }
+
+	// successfully connected
+	return isSocketOK();
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::resolveHost()
+{
 
 	/*
-	    #include <sys/socket.h>
 
-       	int socket(				int 		domain, 
-		   						int 		type, 
-								int 		protocol			);
+		#include <netdb.h>
 
-		creates an endpoint for communication and returns a file
-       	descriptor that refers to that endpoint.
+		int getaddrinfo(		const char 					*node, 
+								const char 					*service,
+								const struct addrinfo 		*hints,
+								struct addrinfo 		   **res 			);
 
-		RETURN VALUE         
-       	On success, a file descriptor for the new socket is returned. 
-		On error, -1 is returned
+		Given node and service, which identify an Internet host and a service, getaddrinfo() 
+		returns one or more addrinfo structures, each of which contains an Internet address 
+		that can be specified in a call to bind(2) or connect(2). Unlike gethostbyname() it is 
+		reentrant and handles IPv4 and IPv6 ( AF_UNSPEC ) alike.
 
 	*/
 
-	m_fd = socket(				AF_INET, 		// =  IPv4 protocol
-								SOCK_STREAM, 	// =  TCP
-								0				// =  IP				
-																);
+	struct addrinfo hints;
 
-	//************************************************************
-	//************************************************************
+	memset( 			&hints, 
+						0, 
+						sizeof( hints ) 			);
+
+	hints.ai_family 	= 	AF_UNSPEC;
+	hints.ai_socktype 	= 	SOCK_STREAM;
+	hints.ai_protocol 	= 	IPPROTO_TCP;
 
+	char service[ 16 ];
 
-	// failed to create socket
-	if( m_fd < 0 ) 
+	snprintf( 			service, 
+						sizeof( service ), 
+						"%d", 
+						port() 						);
+
+	struct addrinfo* res = 0;
+
+	m_connectAddrs.clear();
+	m_connectAddrIdx = 0;
+
+	if( getaddrinfo( host().c_str(), service, &hints, &res ) != 0 || !res ) 
 	{
 
 		getWrapper()->error( 				NO_VALID_ID, 
-											FAIL_CREATE_SOCK.code(), 
-											FAIL_CREATE_SOCK.msg()					);
-		
+											CONNECT_FAIL.code(), 
+											CONNECT_FAIL.msg()						);
+
 		return false;
-	
+
 	}
 
-	// starting to connect to server
-	
-	/*
+	for( struct addrinfo* ai = res; ai; ai = ai->ai_next )
+		m_connectAddrs.push_back( std::string( (const char*)ai->ai_addr, ai->ai_addrlen ) );
+
+	freeaddrinfo( res );
+
+	return true;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::armConnectDeadline()
+{
+
+	m_connectDeadline 	= 	Clock::now() + std::chrono::milliseconds( m_connectTimeoutMs );
+	m_connectArmed 		= 	m_connectTimeoutMs > 0;
 
-		struct sockaddr_in 
+}
+
+//*******************************************************************************************************************
+
+int EClientSocket::beginConnect()
+{
+
+	// opens a non-blocking socket for the next resolved address and starts connecting to it.
+	// 0 when a connect is in flight ( also when it completed at once, select reports it ),
+	// -1 when every address failed
+
+	while( m_connectAddrIdx < m_connectAddrs.size() ) 
+	{
+
+		const std::string& 		addr 	= m_connectAddrs[ m_connectAddrIdx++ ];
+		const struct sockaddr* 	sa 		= (const struct sockaddr*)addr.data();
+
+		int fd = socket( 			sa->sa_family, 		// AF_INET or AF_INET6
+									SOCK_STREAM, 		// TCP
+									0 									);
+
+		if( fd < 0 )
+			continue;
+
+		if( !SetSocketNonBlocking( fd ) ) 
 		{
-        	sa_family_t    	sin_family; 	// address family: AF_INET 
-            in_port_t      	sin_port;   	// port in network byte order
-            struct in_addr 	sin_addr;   	// internet address 
-       	};
 
-        // Internet address 
-        struct in_addr 
+			SocketClose( fd );
+			
+			continue;
+
+		}
+
+		// buffer sizes have to be set before connect to affect the window scale
+		applySocketOptions( fd );
+
+		if( connect( fd, sa, (socklen_t)addr.size() ) == 0 || SocketConnectInProgress() ) 
 		{
-			uint32_t       	s_addr;     	// address in network byte order 
-        };
 
-	*/
+			m_fd 				= 	fd;
+			m_connectPending 	= 	true;
 
-	struct sockaddr_in sa;
+			return 0;
 
-	memset( 			&sa, 
-						0, 
-						sizeof (sa ) 				);
-	
-	sa.sin_family 		= 	AF_INET;
-	sa.sin_port 		= 	htons( port() );
-	sa.sin_addr.s_addr 	= 	( (in_addr*)hostEnt->h_addr )->s_addr;
+		}
+
+		SocketClose( fd );
+
+	}
+
+	m_fd 				= 	-1;
+	m_connectPending 	= 	false;
+	m_connectArmed 		= 	false;
+
+	getWrapper()->error( 				NO_VALID_ID, 
+										CONNECT_FAIL.code(), 
+										CONNECT_FAIL.msg()						);
+
+	return -1;
+
+}
+
+//*******************************************************************************************************************
+
+int EClientSocket::pollConnect( int timeoutMs )
+{
+
+	// one step of a connect in flight: 1 connected, 0 still waiting, -1 failed ( error reported )
+
+	if( !m_connectPending )
+		return isSocketOK() ? 1 : -1;
+
+	if( !checkConnectDeadline() )
+		return -1;
+
+	fd_set 	writeSet;
+	fd_set 	errorSet;
+
+	FD_ZERO( 			&writeSet 		);
+	FD_ZERO( 			&errorSet 		);
+	FD_SET( 			m_fd, &writeSet );
+	FD_SET( 			m_fd, &errorSet );
+
+	struct timeval tval;
 
+	tval.tv_sec  = timeoutMs / 1000;
+	tval.tv_usec = ( timeoutMs % 1000 ) * 1000;
+
+	int ret = select( 			m_fd + 1, 
+								0, 
+								&writeSet, 
+								&errorSet, 
+								&tval 						);
+
+	if( ret == 0 || ( ret < 0 && errno == EINTR ) )
+		return 0;
+
+	// writable means the connect finished, SO_ERROR tells whether it succeeded
+	int 		err = 0;
+	socklen_t 	len = sizeof( err );
+
+	if( ret > 0 && getsockopt( m_fd, SOL_SOCKET, SO_ERROR, (char*)&err, &len ) == 0 && err == 0 ) 
+	{
+
+		m_connectPending = false;
+
+		return 1;
+
+	}
+
+	SocketClose( m_fd );
+
+	m_fd = -1;
+
+	return beginConnect();
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::driveConnect( int timeoutMs )
+{
+
+	if( pollConnect( timeoutMs ) <= 0 )
+		return;
+
+	m_startup.mark( STARTUP_TCP_CONNECTED );
+
+	getTransport()->fd( m_fd );
+
+    int res = sendConnectRequest();
+
+	if( ( res < 0 && !handleSocketError() ) || !isConnected() ) 
+	{
+
+		eDisconnect();
+
+		getWrapper()->error( 				NO_VALID_ID, 
+											CONNECT_FAIL.code(), 
+											CONNECT_FAIL.msg()						);
+
+		return;
+
+	}
+
+	m_startup.mark( STARTUP_HANDSHAKE_SENT );
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::checkConnectDeadline()
+{
+
+	if( !m_connectArmed )
+		return true;
+
+	if( m_serverVersion > 0 || m_fd < 0 ) 
+	{
+
+		m_connectArmed = false;
+
+		return true;
+
+	}
+
+	if( Clock::now() < m_connectDeadline )
+		return true;
+
+	eDisconnect();
+
+	getWrapper()->error( 				NO_VALID_ID, 
+										CONNECT_FAIL.code(), 
+										CONNECT_FAIL.msg() + " - connection attempt timed out"	);
+
+	return false;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::applySocketOptions( int fd )
+{
 
 	/*
-	
+
 		#include <sys/socket.h>
 
-       	int connect(		int 						sockfd, 
-		   					const struct sockaddr 	   *addr,
-                   			socklen_t 					addrlen			);
+		int setsockopt(		int 			sockfd, 
+							int 			level, 
+							int 			optname,
+							const void 	   *optval, 
+							socklen_t 		optlen		);
+
+		manipulates options for the socket referred to by the file descriptor sockfd. 
+		Failures are not fatal here, readSocketOptions() shows what was granted.
 
-		The connect() system call connects the socket referred to by the
-       	file descriptor sockfd to the address specified by addr
-	
 	*/
 
-	//*********************************************************************
-	// connects to server
-	//*********************************************************************
+	const ESocketOptions& o = m_socketOptions;
+
+	int on = 1;
+
+	if( o.tcpNoDelay )
+		setsockopt( fd, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof( on ) );
+
+#if defined(TCP_QUICKACK)
+	if( o.tcpQuickAck )
+		setsockopt( fd, IPPROTO_TCP, TCP_QUICKACK, (const char*)&on, sizeof( on ) );
+#endif
+
+	if( o.rcvBuf > 0 )
+		setsockopt( fd, SOL_SOCKET, SO_RCVBUF, (const char*)&o.rcvBuf, sizeof( o.rcvBuf ) );
+
+	if( o.sndBuf > 0 )
+		setsockopt( fd, SOL_SOCKET, SO_SNDBUF, (const char*)&o.sndBuf, sizeof( o.sndBuf ) );
+
+#if defined(SO_BUSY_POLL)
+	if( o.busyPollUs > 0 )
+		setsockopt( fd, SOL_SOCKET, SO_BUSY_POLL, (const char*)&o.busyPollUs, sizeof( o.busyPollUs ) );
+#endif
+
+#if defined(SO_PRIORITY)
+	if( o.priority >= 0 )
+		setsockopt( fd, SOL_SOCKET, SO_PRIORITY, (const char*)&o.priority, sizeof( o.priority ) );
+#endif
+
+}
+
+//*******************************************************************************************************************
+
+namespace 
+{
+
+	int readIntOption( 		int 	fd, 
+							int 	level, 
+							int 	name, 
+							int 	fallback 		)
+	{
+
+		int 		value 	= 0;
+		socklen_t 	len 	= sizeof( value );
+
+		if( getsockopt( fd, level, name, (char*)&value, &len ) != 0 )
+			return fallback;
+
+		return value;
+
+	}
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::readSocketOptions()
+{
+
+	ESocketOptions e;
+
+	int fd = m_fd;
+
+	if( fd < 0 )
+		return;
+
+	e.tcpNoDelay 	= readIntOption( fd, IPPROTO_TCP, TCP_NODELAY, 0 ) != 0;
+
+#if defined(TCP_QUICKACK)
+	e.tcpQuickAck 	= readIntOption( fd, IPPROTO_TCP, TCP_QUICKACK, 0 ) != 0;
+#else
+	e.tcpQuickAck 	= false;
+#endif
+
+	// Linux reports twice the requested size, the extra half is its bookkeeping overhead
+	e.rcvBuf 		= readIntOption( fd, SOL_SOCKET, SO_RCVBUF, 0 );
+	e.sndBuf 		= readIntOption( fd, SOL_SOCKET, SO_SNDBUF, 0 );
 
-	if( ( connect( 	m_fd, (struct sockaddr *) &sa, sizeof( sa ) ) ) < 0   ) 
-	{
+#if defined(SO_BUSY_POLL)
+	e.busyPollUs 	= readIntOption( fd, SOL_SOCKET, SO_BUSY_POLL, 0 );
+#else
+	e.busyPollUs 	= 0;
+#endif
 
-		// error connecting
-		SocketClose( m_fd );
+#if defined(SO_PRIORITY)
+	e.priority 		= readIntOption( fd, SOL_SOCKET, SO_PRIORITY, -1 );
+#else
+	e.priority 		= -1;
+#endif
 
-		m_fd = -1;
+	m_effectiveOptions = e;
 
-		getWrapper()->error( 				NO_VALID_ID, 
-											CONNECT_FAIL.code(), 
-											CONNECT_FAIL.msg()						);
-		
-		return false;
-	
-	}
+}
 
+//*******************************************************************************************************************
 
-    getTransport()->fd( m_fd );
+void EClientSocket::setSocketOptions( const ESocketOptions& options )
+{
 
-	// set client id
-	setClientId ( 	clientId  	);
-	setExtraAuth( 	extraAuth 	);
+	m_socketOptions = options;
 
+}
 
-    int res = sendConnectRequest();
+//*******************************************************************************************************************
 
+const ESocketOptions& EClientSocket::socketOptions() const
+{
 
-	if ( res < 0 && !handleSocketError() )
-		return false;
+	return m_socketOptions;
 
-	if( !isConnected() ) 
-	{
+}
 
-		if( connState() != CS_DISCONNECTED ) 
-		{
-	
-			assert( connState() == CS_REDIRECT );
-	
-			if( stateOutPt ) 
-			{
-				*stateOutPt = connState();
-			}
+//*******************************************************************************************************************
 
-			eDisconnect();
-	
-		}
+const ESocketOptions& EClientSocket::effectiveSocketOptions() const
+{
 
-		return false;
-	
-	}
+	return m_effectiveOptions;
 
-	// set socket to non-blocking state
-	if ( !SetSocketNonBlocking( m_fd ) ) 
-	{
+}
 
-		// error setting socket to non-blocking
-	
-		eDisconnect();
-	
-		getWrapper()->error( 				NO_VALID_ID, 
-											CONNECT_FAIL.code(), 
-											CONNECT_FAIL.msg()						);
-	
-		return false;
+//*******************************************************************************************************************
 
-	}
+bool EClientSocket::connectPending() const
+{
 
-	assert( connState() == CS_CONNECTED );
-	
-	if(  stateOutPt ) 
-	{
-		*stateOutPt = connState();
-	}
+	return m_connectPending;
 
-    if ( !m_asyncEConnect ) 
-	{
+}
 
-        EReader reader( this, m_pSignal );
+//*******************************************************************************************************************
 
-		reader.putMessageToQueue();
+void EClientSocket::setConnectTimeout( int timeoutMs )
+{
 
-        while ( m_pSignal && !m_serverVersion && isSocketOK() ) 
-		{
+	m_connectTimeoutMs = timeoutMs;
 
-            m_pSignal->waitForSignal();
-            
-			reader.processMsgs();
-        
-		}
+}
 
-    }
+//*******************************************************************************************************************
 
-	// successfully connected
-	return isSocketOK();
+int EClientSocket::connectTimeout() const
+{
+
+	return m_connectTimeoutMs;
 
 }
 
@@ -452,6 +1019,51 @@ bool EClientSocket::closeAndSend(				std::string 	msg,
 	
 	}
 
+	// handshake and startup frames always go out directly from the caller
+	if( m_serverVersion > 0 && m_concurrentSubmission && !pipelining() ) 
+	{
+
+		m_submissions.push( std::move( msg ) );
+
+		wakeSender();
+
+		return true;
+
+	}
+
+	return sendFrame( msg );
+
+}
+
+//****************************************************************************************************************
+
+bool EClientSocket::sendFrame( 		std::string& 	msg 	)
+{
+
+	// handshake frames ( no server version yet ) are never paced
+	if( m_serverVersion > 0 && m_pacer.enabled() ) 
+	{
+
+		size_t 		idPos = m_useV100Plus ? HEADER_LEN : 0;
+
+		EPaceLane 	lane  = EPacer::laneFor( idPos < msg.size() ? atoi( msg.c_str() + idPos ) : 0 );
+
+		// startup frames join the pipelined write and are charged to the bucket after the fact
+		if( pipelining() )
+			m_pacer.charge( lane );
+		else if( !m_pacer.admit( lane ) ) 
+		{
+
+			// parked, released later by onSend() or drainSubmissions()
+			m_pacer.push( 			lane, 
+									msg 					);
+
+			return true;
+
+		}
+
+	}
+
 
 	//******************************
 	//******************************
@@ -524,6 +1136,18 @@ void EClientSocket::eDisconnect(bool resetState)
 	
 	m_fd = -1;
 
+	// frames queued for the closed connection must not lead the next handshake
+	getTransport()->reset();
+
+	m_pacer.clear();
+
+	// requests in flight are never answered, their round trips count as lost
+	if( latencyProbe() )
+		latencyProbe()->connectionClosed();
+
+	m_connectPending 	= 	false;
+	m_connectArmed 		= 	false;
+
     if ( resetState ) 
 	{
 	    eDisconnectBase();
@@ -598,6 +1222,20 @@ int EClientSocket::receive(			char* 		buf,
 		onClose();
 	}
 
+#if defined(TCP_QUICKACK)
+
+	// Linux drops back to delayed acks on its own, keep the option armed
+	if( nResult > 0 && m_socketOptions.tcpQuickAck ) 
+	{
+
+		int on = 1;
+
+		setsockopt( m_fd, IPPROTO_TCP, TCP_QUICKACK, (const char*)&on, sizeof( on ) );
+
+	}
+
+#endif
+
 	if( nResult <= 0 ) 
 	{
 		return 0;
@@ -616,6 +1254,13 @@ void EClientSocket::serverVersion(			int 			version,
     m_serverVersion = version;
     m_TwsTime 		= time;
     m_redirectCount = 0;
+	m_connectArmed 	= false;
+
+	m_startup.mark( STARTUP_SERVER_VERSION );
+
+	++m_connections;
+
+	readSocketOptions();
 
     if( usingV100Plus() ? ( m_serverVersion < MIN_CLIENT_VER || m_serverVersion > MAX_CLIENT_VER ) : m_serverVersion < MIN_SERVER_VER_SUPPORTED ) 
 	{
@@ -631,7 +1276,176 @@ void EClientSocket::serverVersion(			int 			version,
 	}
 
 	if ( !m_asyncEConnect )
-		startApi();
+		startPipelined();
+
+}
+
+//*******************************************************************************************************************
+// true only on the thread inside startPipelined(): a producer racing it must not touch
+// the held socket or the pacer, it goes through the submission queue as usual
+
+bool EClientSocket::pipelining() const
+{
+
+	return m_pipelining && m_pipeliningThread == std::this_thread::get_id();
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::startPipelined()
+{
+
+	// startApi and the startup requests are only queued on the socket and then leave
+	// together, the server reads them back to back instead of one round trip apart.
+	// They bypass the pacer and the submission queue, which would hold them back
+	getTransport()->hold( true );
+
+	m_pipeliningThread 	= std::this_thread::get_id();
+	m_pipelining 		= true;
+
+	startApi();
+
+	std::vector< StartupRequest > requests;
+
+	requests.swap( m_startupRequests );
+
+	for( size_t i = 0; i < requests.size() && isSocketOK(); ++i )
+		requests[ i ]( *this );
+
+	m_pipelining 		= false;
+	m_pipeliningThread 	= std::thread::id();
+
+	getTransport()->hold( false );
+
+	if( isSocketOK() && getTransport()->sendBufferedData() < 0 )
+		handleSocketError();
+
+	m_startup.mark( STARTUP_API_STARTED );
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::queueStartupRequest( const StartupRequest& request )
+{
+
+	m_startupRequests.push_back( request );
+
+}
+
+//*******************************************************************************************************************
+
+size_t EClientSocket::startupRequestCount() const
+{
+
+	return m_startupRequests.size();
+
+}
+
+//*******************************************************************************************************************
+
+const EStartupTimeline& EClientSocket::startupTimeline() const
+{
+
+	return m_startup;
+
+}
+
+//*******************************************************************************************************************
+
+unsigned EClientSocket::connections() const
+{
+
+	return m_connections;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::setMessageTap( EMessageTap* tap )
+{
+
+	m_pTap = tap;
+
+}
+
+//*******************************************************************************************************************
+
+EMessageTap* EClientSocket::messageTap() const
+{
+
+	return m_pTap;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::setQuoteTable( EQuoteTable* quotes )
+{
+
+	m_pQuotes = quotes;
+
+}
+
+//*******************************************************************************************************************
+
+EQuoteTable* EClientSocket::quoteTable() const
+{
+
+	return m_pQuotes;
+
+}
+
+//*******************************************************************************************************************
+
+void EClientSocket::setTickByTickNormalizer( ETickByTickNormalizer* normalizer )
+{
+
+	m_pTickByTick = normalizer;
+
+}
+
+//*******************************************************************************************************************
+
+ETickByTickNormalizer* EClientSocket::tickByTickNormalizer() const
+{
+
+	return m_pTickByTick;
+
+}
+
+//*******************************************************************************************************************
+
+bool EClientSocket::startupMessage( int msgId )
+{
+
+	switch( msgId ) 
+	{
+
+		case NEXT_VALID_ID:
+			m_startup.mark( STARTUP_NEXT_VALID_ID );
+			break;
+
+		case MANAGED_ACCTS:
+			m_startup.mark( STARTUP_MANAGED_ACCOUNTS );
+			break;
+
+		case TICK_PRICE:
+		case TICK_SIZE:
+		case TICK_GENERIC:
+		case TICK_STRING:
+		case TICK_OPTION_COMPUTATION:
+		case MARKET_DEPTH:
+		case MARKET_DEPTH_L2:
+		case REAL_TIME_BARS:
+		case TICK_BY_TICK:
+			m_startup.mark( STARTUP_FIRST_TICK );
+			break;
+
+	}
+
+	return !m_startup.reached( STARTUP_FIRST_TICK );
 
 }
 
@@ -691,6 +1505,15 @@ void EClientSocket::redirect( 		  const char 	*host,
 
 //*******************************************************************************************************************
 
+bool EClientSocket::currentTimeReply( long time )
+{
+
+	return latencyProbe() && latencyProbe()->replyReceived();
+
+}
+
+//*******************************************************************************************************************
+
 bool EClientSocket::handleSocketError()
 {
 
@@ -739,6 +1562,14 @@ bool EClientSocket::handleSocketError()
 void EClientSocket::onSend()
 {
 
+	pollLatencyProbe();
+
+	// the sender thread owns the socket in concurrent mode
+	if( m_concurrentSubmission )
+		return;
+
+	flushPaced();
+
 	if ( getTransport()->sendBufferedData() < 0 )
 		handleSocketError();
 
@@ -746,6 +1577,23 @@ void EClientSocket::onSend()
 
 //*******************************************************************************************************************
 
+void EClientSocket::flushPaced()
+{
+
+	std::string frame;
+
+	while( isSocketOK() && m_pacer.release( frame ) ) 
+	{
+
+		if( bufferedSend( frame ) == -1 && !handleSocketError() && !isSocketOK() )
+			return;
+
+	}
+
+}
+
+//*******************************************************************************************************************
+
 void EClientSocket::onClose()
 {
 	eDisconnect();
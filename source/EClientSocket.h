@@ -6,12 +6,23 @@
 #define TWS_API_CLIENT_ECLIENTSOCKET_H
 
 #include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
 #include "EClient.h"
 #include "EClientMsgSink.h"
 #include "ESocket.h"
+#include "ESocketOptions.h"
+#include "EPacer.h"
+#include "EMpscQueue.h"
+#include "EStartupTimeline.h"
+#include "EMessageTap.h"
 
 
 class  EWrapper;
+class  EQuoteTable;
+class  ETickByTickNormalizer;
 struct EReaderSignal;
 
 
@@ -49,6 +60,14 @@ public:
 													unsigned int 	port, 
 													int 			clientId 			= 0				);
 
+	// starts a non-blocking connect and returns at once; the EReader thread ( start it right
+	// after ) completes the TCP connect and the handshake. Success is reported through
+	// EWrapper::connectAck, failure or timeout through error( CONNECT_FAIL )
+	bool 			eConnectAsync			( 		const char 		*host, 
+													int 			port, 
+													int 			clientId  			= 0,	 
+													bool 			extraAuth 			= false			);
+
 	void 			eDisconnect				(		bool 			resetState 			= true			);
 
 	bool 			isSocketOK				(															) const;
@@ -62,12 +81,83 @@ public:
 
     bool 			allowRedirect 			(															) const; 
 
+	// TCP tuning applied before connect; what the kernel actually granted is read back
+	// once the server version handshake completes
+	void 					setSocketOptions		(		const ESocketOptions& 	options 				);
+	const ESocketOptions& 	socketOptions			(																) const;
+	const ESocketOptions& 	effectiveSocketOptions	(																) const;
+
+	// deadline for resolve + TCP connect + server version handshake, <= 0 waits on the kernel
+	void 			setConnectTimeout		(		int 			timeoutMs 							);
+	int 			connectTimeout			(															) const;
+
+	// event loop side of eConnectAsync, called by EReader
+	bool 			connectPending			(															) const;
+	void 			driveConnect			(		int 			timeoutMs 							);
+	bool 			checkConnectDeadline	(															);
+
+	// client side pacing of outgoing requests, rate <= 0 turns it off ( default )
+	void 			setPacing				(		double 			rate, 
+													double 			burst 				= EPacer::DEFAULT_BURST	);
+
+	EPacer& 		pacer					(															);
+	const EPacer& 	pacer					(															) const;
+
+	// lets any number of threads issue requests at once: encoded frames are queued
+	// lock-free and written to the socket only by the sender ( the EReader thread, or
+	// whichever single thread calls drainSubmissions() ). Set before connecting
+	void 			setConcurrentSubmission	(		bool 			val 								);
+	bool 			concurrentSubmission	(															) const;
+
+	size_t 			submissionQueueDepth	(															) const;
+	int 			wakeFd					(															) const;
+
+	// sender side, single thread only
+	void 			drainSubmissions		(															);
+
+	// requests pipelined behind startApi: sent in the same write, without waiting for
+	// nextValidId. Each runs once, at the next handshake, on the thread completing it
+	// ( the one calling eConnect, or the EReader thread after eConnectAsync ). Not run
+	// when asyncEConnect( true ) leaves startApi to the application
+	typedef std::function< void( EClientSocket& ) > 	StartupRequest;
+
+	void 			queueStartupRequest		(		const StartupRequest& 	request 					);
+	size_t 			startupRequestCount		(															) const;
+
+	// when each phase of the current ( or last ) connection attempt was reached
+	const EStartupTimeline& startupTimeline	(															) const;
+
+	// server version handshakes completed so far, i.e. changes with every new connection
+	unsigned 		connections				(															) const;
+
+	// raw incoming messages are shown to the tap, if set, before they are decoded
+	void 			setMessageTap			(		EMessageTap* 	tap 								);
+	EMessageTap* 	messageTap				(															) const;
+
+	// TICK_PRICE / TICK_SIZE are also written to the table, if set, as they are decoded
+	void 			setQuoteTable			(		EQuoteTable* 	quotes 								);
+	EQuoteTable* 	quoteTable				(															) const;
+
+	// TICK_BY_TICK messages are also normalized to compact events, if set, as they are decoded
+	void 			setTickByTickNormalizer	(		ETickByTickNormalizer* 	normalizer 					);
+	ETickByTickNormalizer* tickByTickNormalizer(														) const;
+
 private:
 	
 	bool 			eConnectImpl			(		int 			clientId, 
 													bool 			extraAuth, 
 													ConnState* 		stateOutPt							);
 
+	bool 			prepareConnect			(		const char 		*host, 
+													int 			port 								);
+	bool 			resolveHost				(															);
+	int 			beginConnect			(															);
+	int 			pollConnect				(		int 			timeoutMs 							);
+	void 			armConnectDeadline		(															);
+	void 			applySocketOptions		(		int 			fd 									);
+	void 			readSocketOptions		(															);
+	void 			startPipelined			(															);
+
 private:
 	
 	void 			encodeMsgLen			(		std::string& 	msg, 
@@ -89,6 +179,11 @@ public:
 private:
 
 	void 			onClose();
+	void 			flushPaced();
+	bool 			sendFrame				(		std::string& 	msg 								);
+	void 			wakeSender				(															);
+	void 			discardSubmissions		(															);
+	bool 			pipelining				(															) const;
 
 private:
 
@@ -97,9 +192,41 @@ private:
     bool 					m_asyncEConnect;
     EReaderSignal*			m_pSignal;
     int 					m_redirectCount;
+	EPacer 					m_pacer;
+
+	bool 							m_concurrentSubmission;
+	std::atomic< bool > 			m_pipelining;		// startPipelined() running: its frames go straight to the held socket
+	std::atomic< std::thread::id > 	m_pipeliningThread;	// the one running it, every other producer still queues
+	EMpscQueue< std::string > 		m_submissions;
+	std::atomic< bool > 			m_wakePending;
+	int 							m_wakePipe[ 2 ];	// [0] read end selected by EReader, [1] write end
+
+	typedef std::chrono::steady_clock 	Clock;
+
+	std::vector< std::string > 		m_connectAddrs;		// resolved sockaddr blobs, tried in order
+	size_t 							m_connectAddrIdx;
+	std::atomic< bool > 			m_connectPending;	// non-blocking TCP connect in flight
+	std::atomic< bool > 			m_connectArmed;		// deadline runs until the server version arrives
+	Clock::time_point 				m_connectDeadline;
+	int 							m_connectTimeoutMs;
+
+	ESocketOptions 					m_socketOptions;
+	ESocketOptions 					m_effectiveOptions;
+
+	std::vector< StartupRequest > 	m_startupRequests;
+	EStartupTimeline 				m_startup;
+	std::atomic< unsigned > 		m_connections;
+
+	EMessageTap* 					m_pTap;
+	EQuoteTable* 					m_pQuotes;
+	ETickByTickNormalizer* 			m_pTickByTick;
 
     static const int 		REDIRECT_COUNT_MAX = 2;
 
+public:
+
+	static const int 		DEFAULT_CONNECT_TIMEOUT_MS = 10000;
+
 //EClientMsgSink implementation
 public:
 
@@ -109,6 +236,10 @@ public:
     void 			redirect				(		const char*		host, 
 													int 			port								);    
 
+    bool 			currentTimeReply		(		long 			time 								);
+
+    bool 			startupMessage			(		int 			msgId 								);
+
 };
 
 //******************************************************************************************
@@ -0,0 +1,343 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EContractRegistry.h"
+
+#include <string.h>
+
+
+const EContractHandle EContractRegistry::NO_CONTRACT;
+
+
+namespace {
+
+    //***********************************************************************************************
+    // FNV-1a over the fields, each followed by a separator so "AB" "C" differs from "A" "BC"
+
+    struct Hasher 
+    {
+
+        unsigned long long h;
+
+        Hasher() : h( 1469598103934665603ULL ) {}
+
+        void bytes( const void* data, size_t len )
+        {
+
+            const unsigned char* p = ( const unsigned char* )data;
+
+            for( size_t i = 0; i < len; ++i ) 
+            {
+                h ^= p[ i ];
+                h *= 1099511628211ULL;
+            }
+
+        }
+
+        void text( const std::string& s )   { bytes( s.data(), s.size() ); bytes( "", 1 ); }
+
+        template< class T >
+        void value( T v )                   { bytes( &v, sizeof( v ) ); }
+
+    };
+
+    // splitmix64 finalizer: spreads sequential conIds over the table
+    inline unsigned long long mix( unsigned long long h )
+    {
+
+        h ^= h >> 30;   h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;   h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+
+        return h;
+
+    }
+
+    inline size_t capacityFor( size_t expected )
+    {
+
+        size_t n = 16;
+
+        while( n < expected * 2 )
+            n *= 2;
+
+        return n;
+
+    }
+
+}
+
+
+//***************************************************************************************************
+
+EContractRegistry::EContractRegistry(   size_t  expected    )
+
+    : m_conIds      ( 0 )
+    , m_descriptors ( 0 )
+
+{
+
+    size_t n = capacityFor( expected );
+
+    m_byConId.keys.assign( n, 0 );
+    m_byConId.handles.assign( n, NO_CONTRACT );
+    m_byDescriptor.keys.assign( n, 0 );
+    m_byDescriptor.handles.assign( n, NO_CONTRACT );
+
+}
+
+//***************************************************************************************************
+
+unsigned long long EContractRegistry::descriptorHash(   const Contract&     contract    )
+{
+
+    Hasher h;
+
+    h.text( contract.symbol );
+    h.text( contract.secType );
+    h.text( contract.lastTradeDateOrContractMonth );
+    h.value( contract.strike );
+    h.text( contract.right );
+    h.text( contract.multiplier );
+    h.text( contract.currency );
+    h.text( contract.secIdType );
+    h.text( contract.secId );
+
+    if( contract.comboLegs ) 
+    {
+
+        const Contract::ComboLegList& legs = *contract.comboLegs;
+
+        for( size_t i = 0; i < legs.size(); ++i ) 
+        {
+            h.value( legs[ i ]->conId );
+            h.value( legs[ i ]->ratio );
+            h.text( legs[ i ]->action );
+        }
+
+    }
+
+    return mix( h.h );
+
+}
+
+//***************************************************************************************************
+
+bool EContractRegistry::sameDescriptor(     const Contract&     a, 
+                                            const Contract&     b   )
+{
+
+    if( a.symbol != b.symbol || a.secType != b.secType || a.lastTradeDateOrContractMonth != b.lastTradeDateOrContractMonth || 
+        a.strike != b.strike || a.right != b.right || a.multiplier != b.multiplier || a.currency != b.currency || 
+        a.secIdType != b.secIdType || a.secId != b.secId )
+        return false;
+
+    size_t na = a.comboLegs ? a.comboLegs->size() : 0;
+    size_t nb = b.comboLegs ? b.comboLegs->size() : 0;
+
+    if( na != nb )
+        return false;
+
+    for( size_t i = 0; i < na; ++i ) 
+    {
+
+        const ComboLeg& x = *( *a.comboLegs )[ i ];
+        const ComboLeg& y = *( *b.comboLegs )[ i ];
+
+        if( x.conId != y.conId || x.ratio != y.ratio || x.action != y.action )
+            return false;
+
+    }
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EContractRegistry::insert(     Index&              index, 
+                                    unsigned long long  key, 
+                                    EContractHandle     handle  )
+{
+
+    size_t mask = index.handles.size() - 1;
+    size_t slot = ( size_t )key & mask;
+
+    while( index.handles[ slot ] != NO_CONTRACT )
+        slot = ( slot + 1 ) & mask;
+
+    index.keys[ slot ]      = key;
+    index.handles[ slot ]   = handle;
+
+}
+
+//***************************************************************************************************
+
+void EContractRegistry::grow(   Index&  index   )
+{
+
+    Index bigger;
+
+    bigger.keys.assign( index.keys.size() * 2, 0 );
+    bigger.handles.assign( index.handles.size() * 2, NO_CONTRACT );
+
+    for( size_t i = 0; i < index.handles.size(); ++i ) 
+    {
+
+        if( index.handles[ i ] != NO_CONTRACT )
+            insert( bigger, index.keys[ i ], index.handles[ i ] );
+
+    }
+
+    index.keys.swap( bigger.keys );
+    index.handles.swap( bigger.handles );
+
+}
+
+//***************************************************************************************************
+
+EContractHandle EContractRegistry::findConId(   long    conId   ) const
+{
+
+    if( conId == 0 )
+        return NO_CONTRACT;
+
+    unsigned long long key = mix( ( unsigned long long )conId );
+
+    size_t mask = m_byConId.handles.size() - 1;
+
+    for( size_t slot = ( size_t )key & mask; m_byConId.handles[ slot ] != NO_CONTRACT; slot = ( slot + 1 ) & mask ) 
+    {
+
+        if( m_byConId.keys[ slot ] == key && m_contracts[ m_byConId.handles[ slot ] ].conId == conId )
+            return m_byConId.handles[ slot ];
+
+    }
+
+    return NO_CONTRACT;
+
+}
+
+//***************************************************************************************************
+
+EContractHandle EContractRegistry::findDescriptor(  const Contract&     contract, 
+                                                    unsigned long long  hash        ) const
+{
+
+    size_t mask = m_byDescriptor.handles.size() - 1;
+
+    for( size_t slot = ( size_t )hash & mask; m_byDescriptor.handles[ slot ] != NO_CONTRACT; slot = ( slot + 1 ) & mask ) 
+    {
+
+        EContractHandle handle = m_byDescriptor.handles[ slot ];
+
+        if( m_byDescriptor.keys[ slot ] == hash && sameDescriptor( m_contracts[ handle ], contract ) )
+            return handle;
+
+    }
+
+    return NO_CONTRACT;
+
+}
+
+//***************************************************************************************************
+
+void EContractRegistry::addConId(   long                conId, 
+                                    EContractHandle     handle  )
+{
+
+    insert( m_byConId, mix( ( unsigned long long )conId ), handle );
+
+    // at most half full, probes stay short
+    if( ++m_conIds * 2 > m_byConId.handles.size() )
+        grow( m_byConId );
+
+}
+
+//***************************************************************************************************
+
+EContractHandle EContractRegistry::find(    const Contract&     contract    ) const
+{
+
+    EContractHandle handle = findConId( contract.conId );
+
+    if( handle != NO_CONTRACT )
+        return handle;
+
+    handle = findDescriptor( contract, descriptorHash( contract ) );
+
+    // a descriptor match with another conId is another contract
+    if( handle != NO_CONTRACT && contract.conId != 0 && m_contracts[ handle ].conId != 0 )
+        return NO_CONTRACT;
+
+    return handle;
+
+}
+
+//***************************************************************************************************
+
+EContractHandle EContractRegistry::intern(  const Contract&     contract    )
+{
+
+    // the common case: a callback for a contract already known
+    EContractHandle handle = findConId( contract.conId );
+
+    if( handle != NO_CONTRACT )
+        return handle;
+
+    unsigned long long  hash    = descriptorHash( contract );
+    EContractHandle     known   = findDescriptor( contract, hash );
+
+    if( known != NO_CONTRACT ) 
+    {
+
+        Contract& stored = m_contracts[ known ];
+
+        if( contract.conId == 0 )
+            return known;
+
+        // known by descriptor only so far: learns its conId
+        if( stored.conId == 0 ) 
+        {
+            stored.conId = contract.conId;
+            addConId( contract.conId, known );
+            return known;
+        }
+
+    }
+
+    handle = ( EContractHandle )m_contracts.size();
+
+    m_contracts.push_back( contract );
+
+    Contract& stored = m_contracts.back();
+
+    // own copies: the caller's legs may change, its delta neutral contract go away
+    stored.comboLegs.reset();
+
+    if( contract.comboLegs ) 
+    {
+        stored.comboLegs.reset( new Contract::ComboLegList() );
+        Contract::CloneComboLegs( stored.comboLegs, contract.comboLegs );
+    }
+
+    stored.deltaNeutralContract = 0;
+
+    if( contract.conId != 0 )
+        addConId( contract.conId, handle );
+
+    // the first contract with a descriptor keeps it
+    if( known == NO_CONTRACT ) 
+    {
+
+        insert( m_byDescriptor, hash, handle );
+
+        if( ++m_descriptors * 2 > m_byDescriptor.handles.size() )
+            grow( m_byDescriptor );
+
+    }
+
+    return handle;
+
+}
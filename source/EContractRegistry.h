@@ -0,0 +1,93 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ECONTRACTREGISTRY_H
+#define TWS_API_CLIENT_ECONTRACTREGISTRY_H
+
+#include <deque>
+#include <vector>
+#include "platformspecific.h"
+#include "Contract.h"
+
+
+
+//******************************************************************************************
+
+typedef int EContractHandle;
+
+//******************************************************************************************
+// every distinct contract seen by the application, stored once, named by a small dense
+// integer ( 0, 1, 2 ... in order of first appearance ) that positions, portfolios, order
+// books can keep instead of a Contract copy: 4 bytes against some 500.
+//
+// Contracts are identified by conId. One without ( a request built by hand ) falls back
+// to a hash of its descriptor: symbol, secType, expiry, strike, right, multiplier,
+// currency, secIdType / secId and the combo legs. The exchanges and what TWS fills in
+// ( localSymbol, tradingClass ) are not part of it. When the conId of a contract known
+// only by descriptor shows up, the entry learns it and keeps its handle.
+//
+// Callbacks intern the contract they are given ( one hash probe, no copy when it is
+// known ); requests take the stored one by reference, registry[ handle ]. Stored
+// contracts never move, own their combo legs and have no deltaNeutralContract.
+// Not thread safe.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EContractRegistry
+{
+
+    struct Index 
+    {
+        std::vector< unsigned long long >   keys;
+        std::vector< EContractHandle >      handles;    // NO_CONTRACT: empty, size a power of two
+    };
+
+    std::deque< Contract >                  m_contracts;
+    Index                                   m_byConId;
+    Index                                   m_byDescriptor;
+    size_t                                  m_conIds;       // entries of m_byConId
+    size_t                                  m_descriptors;  // entries of m_byDescriptor
+
+
+    static void         insert              (       Index&              index, 
+                                                    unsigned long long  key, 
+                                                    EContractHandle     handle                      );
+    static void         grow                (       Index&              index                       );
+
+    EContractHandle     findDescriptor      (       const Contract&     contract, 
+                                                    unsigned long long  hash                        ) const;
+    void                addConId            (       long                conId, 
+                                                    EContractHandle     handle                      );
+
+public:
+
+    static const EContractHandle    NO_CONTRACT = -1;
+
+    explicit EContractRegistry(                     size_t              expected    = 1024          );
+
+    // handle of the contract, stored if new
+    EContractHandle     intern              (       const Contract&     contract                    );
+
+    // NO_CONTRACT if not stored
+    EContractHandle     find                (       const Contract&     contract                    ) const;
+    EContractHandle     findConId           (       long                conId                       ) const;
+
+    const Contract&     contract            (       EContractHandle     handle                      ) const { return m_contracts[ handle ];     }
+    const Contract&     operator[]          (       EContractHandle     handle                      ) const { return m_contracts[ handle ];     }
+
+    size_t              size                (                                                       ) const { return m_contracts.size();        }
+
+    static unsigned long long   descriptorHash( const Contract&     contract                        );
+    static bool                 sameDescriptor( const Contract&     a, 
+                                                const Contract&     b                               );
+
+private:
+
+    EContractRegistry(                              const EContractRegistry&                        );
+    EContractRegistry&  operator=           (       const EContractRegistry&                        );
+
+};
+
+//******************************************************************************************
+
+#endif
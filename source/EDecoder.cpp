@@ -12,6 +12,8 @@
 #include "CommissionReport.h"
 #include "TwsSocketClientErrors.h"
 #include "EDecoder.h"
+#include "EQuoteTable.h"
+#include "ETickByTick.h"
 #include "EClientMsgSink.h"
 #include "PriceIncrement.h"
 #include "EOrderDecoder.h"
@@ -36,6 +38,27 @@ EDecoder::EDecoder(				int 				serverVersion,
 	m_pEWrapper 		= callback;
 	m_serverVersion 	= serverVersion;
 	m_pClientMsgSink 	= clientMsgSink;
+	m_watchStartup 		= clientMsgSink != 0;
+	m_pQuotes 			= 0;
+	m_pTickByTick 		= 0;
+
+}
+
+//**************************************************************************************************************
+
+void EDecoder::setQuoteTable( EQuoteTable* quotes )
+{
+
+	m_pQuotes = quotes;
+
+}
+
+//**************************************************************************************************************
+
+void EDecoder::setTickByTickNormalizer( ETickByTickNormalizer* normalizer )
+{
+
+	m_pTickByTick = normalizer;
 
 }
 
@@ -82,6 +105,9 @@ const char* EDecoder::processTickPriceMsg(			const char* 	ptr,
 
 	}
 
+	if( m_pQuotes )
+		m_pQuotes->applyPrice( tickerId, tickTypeInt, price, size );
+
 	//********************************************************************
 	// callback
 	//********************************************************************
@@ -165,6 +191,9 @@ const char* EDecoder::processTickSizeMsg(			const char* 	ptr,
 	DECODE_FIELD( tickTypeInt	);
 	DECODE_FIELD( size			);
 
+	if( m_pQuotes )
+		m_pQuotes->applySize( tickerId, tickTypeInt, size );
+
 	//****************************************************************************
 	// callback
 	//****************************************************************************
@@ -1661,6 +1690,10 @@ const char* EDecoder::processCurrentTimeMsg(			const char* 	ptr,
 	DECODE_FIELD(			version				);
 	DECODE_FIELD(			time				);
 
+	// replies to the client's own latency probes stop here
+	if( m_pClientMsgSink && m_pClientMsgSink->currentTimeReply( time ) )
+		return ptr;
+
 	//*********************************
 	// callback
 	//*********************************
@@ -3550,6 +3583,9 @@ const char* EDecoder::processTickByTickDataMsg(				const char* 	ptr,
             DECODE_FIELD(			exchange					);
             DECODE_FIELD(			specialConditions			);
 
+			if( m_pTickByTick )
+				m_pTickByTick->last( reqId, tickType, time, price, size, attrMask, exchange, specialConditions );
+
 			//************************************************************************
 			// callback
 			//************************************************************************
@@ -3589,6 +3625,9 @@ const char* EDecoder::processTickByTickDataMsg(				const char* 	ptr,
             tickAttribBidAsk.bidPastLow  = mask[ 0 ];
             tickAttribBidAsk.askPastHigh = mask[ 1 ];
 
+			if( m_pTickByTick )
+				m_pTickByTick->bidAsk( reqId, time, bidPrice, askPrice, bidSize, askSize, attrMask );
+
 			//************************************************************************
 			// callback
 			//************************************************************************
@@ -3611,6 +3650,9 @@ const char* EDecoder::processTickByTickDataMsg(				const char* 	ptr,
 
             DECODE_FIELD(			midPoint			);
 
+			if( m_pTickByTick )
+				m_pTickByTick->midPoint( reqId, time, midPoint );
+
 			//********************************************************************
 			// callback
 			//********************************************************************
@@ -3828,6 +3870,9 @@ int EDecoder::parseAndProcessMsg(			const char*& 	beginPtr,
 
 		DECODE_FIELD(  msgId  );
 
+		if( m_watchStartup )
+			m_watchStartup = m_pClientMsgSink->startupMessage( msgId );
+
 
 		switch( msgId ) 
 		{
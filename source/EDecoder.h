@@ -238,6 +238,8 @@ namespace
 } // end of anonymous namespace
 
 class  EWrapper;
+class  EQuoteTable;
+class  ETickByTickNormalizer;
 struct EClientMsgSink;
 
 
@@ -250,6 +252,9 @@ class TWSAPIDLLEXP EDecoder
     EWrapper           *m_pEWrapper;
     int                 m_serverVersion;
     EClientMsgSink     *m_pClientMsgSink;
+    bool                m_watchStartup;     // msg ids still go to m_pClientMsgSink->startupMessage
+    EQuoteTable        *m_pQuotes;          // top of book written as ticks are decoded, optional
+    ETickByTickNormalizer *m_pTickByTick;   // compact events of TICK_BY_TICK, optional
 
 
     const char*     processTickPriceMsg                 (       const char* ptr,    const char* endPtr          );
@@ -380,6 +385,9 @@ public:
     int                 parseAndProcessMsg(     const char*&    beginPtr, 
                                                 const char*     endPtr                      );
 
+    void                setQuoteTable   (       EQuoteTable*    quotes                                          );
+    void                setTickByTickNormalizer(    ETickByTickNormalizer*  normalizer                          );
+
 
 };
 
@@ -0,0 +1,190 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EFrameScanner.h"
+#include "EDecoder.h"
+#include "EWrapper.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+
+//***************************************************************************************************
+
+const char* EFrameScanner::skipFields(          const char*     ptr, 
+                                                const char*     end, 
+                                                int             count           )
+{
+
+    while( ptr && count-- > 0 ) 
+    {
+
+        const char* sep = ( const char* )memchr( ptr, 0, end - ptr );
+
+        ptr = sep ? sep + 1 : 0;
+
+    }
+
+    return ptr;
+
+}
+
+//***************************************************************************************************
+
+const char* EFrameScanner::readInt(             const char*     ptr, 
+                                                const char*     end, 
+                                                int&            value           )
+{
+
+    if( !ptr )
+        return 0;
+
+    const char* sep = ( const char* )memchr( ptr, 0, end - ptr );
+
+    if( !sep )
+        return 0;
+
+    // same conversion as DECODE_FIELD for an int
+    value = atoi( ptr );
+
+    return sep + 1;
+
+}
+
+//***************************************************************************************************
+
+bool EFrameScanner::knows( int msgId )
+{
+
+    switch( msgId ) 
+    {
+
+        case TICK_PRICE:
+        case TICK_SIZE:
+        case ORDER_STATUS:
+        case ERR_MSG:
+        case ACCT_VALUE:
+        case ACCT_UPDATE_TIME:
+        case NEXT_VALID_ID:
+        case MARKET_DEPTH:
+        case MARKET_DEPTH_L2:
+        case TICK_OPTION_COMPUTATION:
+        case TICK_GENERIC:
+        case TICK_STRING:
+        case TICK_EFP:
+        case CURRENT_TIME:
+        case REAL_TIME_BARS:
+        case TICK_SNAPSHOT_END:
+        case MARKET_DATA_TYPE:
+        case TICK_REQ_PARAMS:
+        case HISTORICAL_DATA_UPDATE:
+        case TICK_BY_TICK:
+            return true;
+
+        default:
+            return false;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+int EFrameScanner::scan(        const char*     begin, 
+                                const char*     end, 
+                                int             serverVersion       )
+{
+
+    int msgId = 0;
+
+    const char* ptr = readInt( begin, end, msgId );
+
+    if( !ptr )
+        return 0;
+
+    if( !knows( msgId ) )
+        return UNKNOWN_LAYOUT;
+
+    switch( msgId ) 
+    {
+
+        // version, id and the values
+        case TICK_PRICE:                ptr = skipFields( ptr, end,  6 );     break;
+        case TICK_SIZE:                 ptr = skipFields( ptr, end,  4 );     break;
+        case TICK_GENERIC:              ptr = skipFields( ptr, end,  4 );     break;
+        case TICK_STRING:               ptr = skipFields( ptr, end,  4 );     break;
+        case TICK_EFP:                  ptr = skipFields( ptr, end, 10 );     break;
+        case ERR_MSG:                   ptr = skipFields( ptr, end,  4 );     break;
+        case ACCT_VALUE:                ptr = skipFields( ptr, end,  5 );     break;
+        case ACCT_UPDATE_TIME:          ptr = skipFields( ptr, end,  2 );     break;
+        case NEXT_VALID_ID:             ptr = skipFields( ptr, end,  2 );     break;
+        case CURRENT_TIME:              ptr = skipFields( ptr, end,  2 );     break;
+        case MARKET_DEPTH:              ptr = skipFields( ptr, end,  7 );     break;
+        case REAL_TIME_BARS:            ptr = skipFields( ptr, end, 10 );     break;
+        case TICK_SNAPSHOT_END:         ptr = skipFields( ptr, end,  2 );     break;
+        case MARKET_DATA_TYPE:          ptr = skipFields( ptr, end,  3 );     break;
+        case TICK_REQ_PARAMS:           ptr = skipFields( ptr, end,  4 );     break;
+        case HISTORICAL_DATA_UPDATE:    ptr = skipFields( ptr, end,  9 );     break;
+
+        case MARKET_DEPTH_L2:
+            ptr = skipFields( ptr, end, serverVersion >= MIN_SERVER_VER_SMART_DEPTH ? 9 : 8 );
+            break;
+
+        // version before MIN_SERVER_VER_MARKET_CAP_PRICE, mktCapPrice from it on
+        case ORDER_STATUS:
+            ptr = skipFields( ptr, end, 11 );
+            break;
+
+        case TICK_OPTION_COMPUTATION: 
+        {
+
+            int version     = serverVersion;
+            int tickType    = 0;
+
+            if( serverVersion < MIN_SERVER_VER_PRICE_BASED_VOLATILITY )
+                ptr = readInt( ptr, end, version );
+
+            ptr = skipFields( ptr, end, 1 );                // tickerId
+            ptr = readInt( ptr, end, tickType );
+
+            if( serverVersion >= MIN_SERVER_VER_PRICE_BASED_VOLATILITY )
+                ptr = skipFields( ptr, end, 1 );            // tickAttrib
+
+            ptr = skipFields( ptr, end, 2 );                // impliedVol, delta
+
+            if( version >= 6 || tickType == MODEL_OPTION || tickType == DELAYED_MODEL_OPTION_COMPUTATION )
+                ptr = skipFields( ptr, end, 2 );            // optPrice, pvDividend
+
+            if( version >= 6 )
+                ptr = skipFields( ptr, end, 4 );            // gamma, vega, theta, undPrice
+
+            break;
+
+        }
+
+        case TICK_BY_TICK: 
+        {
+
+            int tickType = 0;
+
+            ptr = skipFields( ptr, end, 1 );                // reqId
+            ptr = readInt( ptr, end, tickType );
+            ptr = skipFields( ptr, end, 1 );                // time
+
+            if( tickType == 1 || tickType == 2 )            // Last / AllLast
+                ptr = skipFields( ptr, end, 5 );
+            else if( tickType == 3 )                        // BidAsk
+                ptr = skipFields( ptr, end, 5 );
+            else if( tickType == 4 )                        // MidPoint
+                ptr = skipFields( ptr, end, 1 );
+
+            break;
+
+        }
+
+    }
+
+    return ptr ? ( int )( ptr - begin ) : 0;
+
+}
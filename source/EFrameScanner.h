@@ -0,0 +1,50 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EFRAMESCANNER_H
+#define TWS_API_CLIENT_EFRAMESCANNER_H
+
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// finds where a message ends on a connection without V100 length prefixes, by counting
+// its null terminated fields instead of decoding them. Knows the layout of the frequent
+// fixed-shape messages ( ticks, depth, bars, order status, errors, account values, ... )
+// and mirrors exactly what EDecoder reads for them at the given server version; for
+// any other message scan() says so and the caller measures it with EDecoder.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EFrameScanner
+{
+
+public:
+
+    static const int    UNKNOWN_LAYOUT  = -1;
+
+    // length of the message starting at 'begin', 0 if it is not complete yet,
+    // UNKNOWN_LAYOUT if the message id has no known layout
+    static int          scan                (       const char*     begin, 
+                                                    const char*     end, 
+                                                    int             serverVersion                   );
+
+    // true if scan() knows the layout of the message id
+    static bool         knows               (       int             msgId                           );
+
+private:
+
+    static const char*  skipFields          (       const char*     ptr, 
+                                                    const char*     end, 
+                                                    int             count                           );
+
+    static const char*  readInt             (       const char*     ptr, 
+                                                    const char*     end, 
+                                                    int&            value                           );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,910 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EPosixClientSocketPlatform.h"
+#include "EGateway.h"
+#include "EClientSocket.h"
+#include "EDecoder.h"
+#include "ERequestRouter.h"
+#include "ERequestJournal.h"
+#include "TwsSocketClientErrors.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+namespace {
+
+    const int   FIELDS_MAX  = 4;    // only the leading fields are ever looked at
+
+    //***************************************************************************************************
+    // splits the first fields of a message, returns how many were found
+
+    int splitFields(        const char*     begin, 
+                            const char*     end, 
+                            const char*     fields[],       // FIELDS_MAX + 1 starts, the last one past the last field
+                            int             max             )
+    {
+
+        int         n   = 0;
+        const char* ptr = begin;
+
+        while( n < max && ptr < end ) 
+        {
+
+            const char* sep = ( const char* )memchr( ptr, 0, end - ptr );
+
+            if( !sep )
+                break;
+
+            fields[ n++ ]   = ptr;
+            ptr             = sep + 1;
+
+        }
+
+        fields[ n ] = ptr;
+
+        return n;
+
+    }
+
+    //***************************************************************************************************
+    // the message with field 'index' replaced by 'id', framed
+
+    void appendRewritten(   std::string&    out, 
+                            const char*     begin, 
+                            const char*     end, 
+                            int             index, 
+                            int             id          )
+    {
+
+        const char* fields[ FIELDS_MAX + 1 ];
+
+        if( splitFields( begin, end, fields, index + 1 ) != index + 1 )
+            return;
+
+        char idText[ 16 ];
+
+        int idLen = snprintf( idText, sizeof( idText ), "%d", id );
+
+        size_t len = ( fields[ index ] - begin ) + idLen + 1 + ( end - fields[ index + 1 ] );
+
+        out += ( char )( ( len >> 24 ) & 0xFF );
+        out += ( char )( ( len >> 16 ) & 0xFF );
+        out += ( char )( ( len >>  8 ) & 0xFF );
+        out += ( char )(   len         & 0xFF );
+
+        out.append( begin, fields[ index ] - begin );
+        out.append( idText, idLen + 1 );                // with the separator
+        out.append( fields[ index + 1 ], end - fields[ index + 1 ] );
+
+    }
+
+    //***************************************************************************************************
+
+    void appendFrame(       std::string&        out, 
+                            const std::string&  fields      )
+    {
+
+        size_t len = fields.size();
+
+        out += ( char )( ( len >> 24 ) & 0xFF );
+        out += ( char )( ( len >> 16 ) & 0xFF );
+        out += ( char )( ( len >>  8 ) & 0xFF );
+        out += ( char )(   len         & 0xFF );
+
+        out += fields;
+
+    }
+
+    //***************************************************************************************************
+
+    void appendField(       std::string&        fields, 
+                            const std::string&  value       )
+    {
+
+        fields += value;
+        fields += '\0';
+
+    }
+
+    //***************************************************************************************************
+
+    void appendField(       std::string&        fields, 
+                            long                value       )
+    {
+
+        char text[ 24 ];
+
+        snprintf( text, sizeof( text ), "%ld", value );
+
+        appendField( fields, std::string( text ) );
+
+    }
+
+}
+
+
+//***************************************************************************************************
+
+EGateway::EGateway( EClientSocket* client )
+
+    : m_pClient             (   client                      )
+    , m_pNextTap            (   client->messageTap()        )
+    , m_nextPeerId          (   1                           )
+    , m_nextTickerId        (   DEFAULT_FIRST_TICKER_ID     )
+    , m_nextValidId         (   1                           )
+{
+
+    m_pClient->setMessageTap( this );
+
+}
+
+//***************************************************************************************************
+
+EGateway::~EGateway()
+{
+
+    if( m_pClient->messageTap() == this )
+        m_pClient->setMessageTap( m_pNextTap );
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool EGateway::listen(          int             port, 
+                                const char*     host            )
+{
+
+    close();
+
+    return m_server.listen( port, host, 16 );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::close()
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    while( !m_peers.empty() )
+        dropPeer( m_peers.begin()->first );
+
+    m_server.close();
+
+}
+
+//***************************************************************************************************
+
+void EGateway::setFirstTickerId( int tickerId )
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    m_nextTickerId = tickerId;
+
+}
+
+//***************************************************************************************************
+
+size_t EGateway::peers() const
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    return m_peers.size();
+
+}
+
+//***************************************************************************************************
+
+size_t EGateway::upstreamSubscriptions() const
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    return m_subscriptions.size();
+
+}
+
+//***************************************************************************************************
+
+size_t EGateway::downstreamSubscriptions() const
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    size_t count = 0;
+
+    for( std::map< int, Peer >::const_iterator it = m_peers.begin(); it != m_peers.end(); ++it )
+        count += it->second.tickers.size();
+
+    return count;
+
+}
+
+//***************************************************************************************************
+
+void EGateway::acceptPeers()
+{
+
+    int fd;
+
+    while( ( fd = m_server.accept() ) >= 0 ) 
+    {
+
+        Peer& peer = m_peers[ m_nextPeerId++ ];
+
+        peer.fd         = fd;
+        peer.handshaken = false;
+        peer.started    = false;
+
+    }
+
+}
+
+//***************************************************************************************************
+// "API\0", then a framed "v<min>..<max>[ options]"; answered with the upstream server
+// version, which every downstream client then encodes its requests for
+
+bool EGateway::handshake( Peer& peer )
+{
+
+    if( peer.in.size() < 8 )
+        return true;
+
+    if( peer.in.compare( 0, 4, "API\0", 4 ) != 0 )
+        return false;
+
+    const unsigned char* p = ( const unsigned char* )peer.in.data() + 4;
+
+    size_t len = ( ( size_t )p[ 0 ] << 24 ) | ( p[ 1 ] << 16 ) | ( p[ 2 ] << 8 ) | p[ 3 ];
+
+    if( len > 1024 )
+        return false;
+
+    if( peer.in.size() < 8 + len )
+        return true;
+
+    std::string versions( peer.in, 8, len );
+
+    peer.in.erase( 0, 8 + len );
+
+    int minVersion = 0;
+    int maxVersion = 0;
+
+    int serverVersion = m_pClient->EClient::serverVersion();
+
+    if( sscanf( versions.c_str(), "v%d..%d", &minVersion, &maxVersion ) != 2 || 
+        serverVersion < minVersion || serverVersion > maxVersion || 
+        serverVersion < MIN_CLIENT_VER )
+        return false;       // upstream not connected, or a client that cannot talk to it
+
+    char        now[ 64 ];
+    time_t      t = time( 0 );
+
+    strftime( now, sizeof( now ), "%Y%m%d %H:%M:%S %Z", localtime( &t ) );
+
+    std::string fields;
+
+    appendField( fields, ( long )serverVersion );
+    appendField( fields, std::string( now ) );
+
+    appendFrame( peer.out, fields );
+
+    peer.handshaken = true;
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+bool EGateway::parse(           int             peerId, 
+                                Peer&           peer            )
+{
+
+    if( !peer.handshaken ) 
+    {
+
+        if( !handshake( peer ) )
+            return false;
+
+        if( !peer.handshaken )
+            return true;
+
+    }
+
+    size_t pos = 0;
+
+    while( peer.in.size() - pos >= 4 ) 
+    {
+
+        const unsigned char* p = ( const unsigned char* )peer.in.data() + pos;
+
+        size_t len = ( ( size_t )p[ 0 ] << 24 ) | ( p[ 1 ] << 16 ) | ( p[ 2 ] << 8 ) | p[ 3 ];
+
+        if( len > MAX_MSG_LEN )
+            return false;
+
+        if( peer.in.size() - pos - 4 < len )
+            break;
+
+        const char* begin = peer.in.data() + pos + 4;
+
+        handle( peerId, peer, begin, begin + len );
+
+        pos += 4 + len;
+
+    }
+
+    peer.in.erase( 0, pos );
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EGateway::handle(          int             peerId, 
+                                Peer&           peer, 
+                                const char*     begin, 
+                                const char*     end             )
+{
+
+    using namespace ibapi::client_constants;
+
+    const char* fields[ FIELDS_MAX + 1 ];
+
+    int n = splitFields( begin, end, fields, 3 );
+
+    if( n < 1 )
+        return;
+
+    int msgId = atoi( fields[ 0 ] );
+
+    std::string reply;
+
+    switch( msgId ) 
+    {
+
+        case START_API:
+
+            peer.started = true;
+
+            appendField( reply, ( long )NEXT_VALID_ID );
+            appendField( reply, 1L );
+            appendField( reply, m_nextValidId );
+
+            appendFrame( peer.out, reply );
+
+            reply.clear();
+
+            appendField( reply, ( long )MANAGED_ACCTS );
+            appendField( reply, 1L );
+            appendField( reply, m_accounts );
+
+            appendFrame( peer.out, reply );
+
+            break;
+
+        case REQ_IDS:
+
+            appendField( reply, ( long )NEXT_VALID_ID );
+            appendField( reply, 1L );
+            appendField( reply, m_nextValidId );
+
+            appendFrame( peer.out, reply );
+
+            break;
+
+        case REQ_CURRENT_TIME:
+
+            appendField( reply, ( long )CURRENT_TIME );
+            appendField( reply, 1L );
+            appendField( reply, ( long )time( 0 ) );
+
+            appendFrame( peer.out, reply );
+
+            break;
+
+        case REQ_MKT_DATA:
+
+            if( n == 3 )
+                subscribe( peerId, peer, atoi( fields[ 2 ] ), fields[ 3 ], end );
+
+            break;
+
+        case CANCEL_MKT_DATA:
+
+            if( n == 3 )
+                unsubscribe( peerId, peer, atoi( fields[ 2 ] ) );
+
+            break;
+
+        default: 
+        {
+
+            char text[ 32 ];
+
+            snprintf( text, sizeof( text ), "message id %d", msgId );
+
+            sendError( peer, NO_VALID_ID, text );
+
+            break;
+
+        }
+
+    }
+
+}
+
+//***************************************************************************************************
+// 'begin' points at the fields after the tickerId: contract, generic ticks, snapshot flags
+// and options, all encoded for the upstream server version
+
+void EGateway::subscribe(       int             peerId, 
+                                Peer&           peer, 
+                                int             tickerId, 
+                                const char*     begin, 
+                                const char*     end             )
+{
+
+    using namespace ibapi::client_constants;
+
+    if( peer.tickers.count( tickerId ) ) 
+    {
+
+        sendError( peer, tickerId, "duplicate ticker id" );
+
+        return;
+
+    }
+
+    // snapshot and regulatory snapshot flags come right before the options
+    int serverVersion = m_pClient->EClient::serverVersion();
+
+    std::vector< const char* > tail;
+
+    for( const char* ptr = begin; ptr < end; ) 
+    {
+
+        const char* sep = ( const char* )memchr( ptr, 0, end - ptr );
+
+        if( !sep )
+            break;
+
+        tail.push_back( ptr );
+
+        ptr = sep + 1;
+
+    }
+
+    int flags = ( int )tail.size() - 1;
+
+    if( serverVersion >= MIN_SERVER_VER_LINKING )
+        --flags;
+
+    bool snapshot = false;
+
+    if( serverVersion >= MIN_SERVER_VER_REQ_SMART_COMPONENTS && flags >= 0 )
+        snapshot = atoi( tail[ flags-- ] ) != 0;
+
+    if( flags < 0 ) 
+    {
+
+        sendError( peer, tickerId, "malformed market data request" );
+
+        return;
+
+    }
+
+    snapshot = snapshot || atoi( tail[ flags ] ) != 0;
+
+    std::string key( begin, end - begin );
+
+    int upstreamId;
+
+    std::map< std::string, int >::iterator shared = m_streaming.find( key );
+
+    if( !snapshot && shared != m_streaming.end() ) 
+    {
+
+        upstreamId = shared->second;
+
+    }
+    else 
+    {
+
+        upstreamId = m_nextTickerId++;
+
+        std::string fields;
+
+        appendField( fields, ( long )REQ_MKT_DATA );
+        appendField( fields, 11L );
+        appendField( fields, ( long )upstreamId );
+
+        fields += key;
+
+        if( !m_pClient->forwardRequest( REQ_MKT_DATA, upstreamId, fields, !snapshot ) ) 
+        {
+
+            sendError( peer, tickerId, "not connected" );
+
+            return;
+
+        }
+
+        Subscription& created = m_subscriptions[ upstreamId ];
+
+        created.key         = key;
+        created.snapshot    = snapshot;
+
+        if( !snapshot )
+            m_streaming[ key ] = upstreamId;
+
+    }
+
+    Subscription& sub = m_subscriptions[ upstreamId ];
+
+    Subscriber subscriber;
+
+    subscriber.peer     = peerId;
+    subscriber.tickerId = tickerId;
+
+    sub.subscribers.push_back( subscriber );
+
+    peer.tickers[ tickerId ] = upstreamId;
+
+    // bring the late subscriber up to date; each frame is kept with its id field index
+    for( std::map< std::string, std::string >::const_iterator it = sub.last.begin(); it != sub.last.end(); ++it ) 
+    {
+
+        const std::string& frame = it->second;
+
+        appendRewritten(    peer.out, 
+                            frame.data() + 1, 
+                            frame.data() + frame.size(), 
+                            frame[ 0 ], 
+                            tickerId                        );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EGateway::unsubscribe(     int             peerId, 
+                                Peer&           peer, 
+                                int             tickerId        )
+{
+
+    std::map< int, int >::iterator ticker = peer.tickers.find( tickerId );
+
+    if( ticker == peer.tickers.end() )
+        return;
+
+    int upstreamId = ticker->second;
+
+    peer.tickers.erase( ticker );
+
+    std::map< int, Subscription >::iterator it = m_subscriptions.find( upstreamId );
+
+    if( it == m_subscriptions.end() )
+        return;
+
+    std::vector< Subscriber >& subscribers = it->second.subscribers;
+
+    for( size_t i = 0; i < subscribers.size(); ++i ) 
+    {
+
+        if( subscribers[ i ].peer == peerId && subscribers[ i ].tickerId == tickerId ) 
+        {
+            subscribers.erase( subscribers.begin() + i );
+            break;
+        }
+
+    }
+
+    if( !subscribers.empty() )
+        return;
+
+    // last one out cancels; a snapshot simply runs to its end unobserved
+    if( !it->second.snapshot ) 
+    {
+
+        m_streaming.erase( it->second.key );
+
+        m_pClient->cancelMktData( upstreamId );
+
+    }
+
+    m_subscriptions.erase( it );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::retire( std::map< int, Subscription >::iterator it )
+{
+
+    using namespace ibapi::client_constants;
+
+    for( size_t i = 0; i < it->second.subscribers.size(); ++i ) 
+    {
+
+        std::map< int, Peer >::iterator peer = m_peers.find( it->second.subscribers[ i ].peer );
+
+        if( peer != m_peers.end() )
+            peer->second.tickers.erase( it->second.subscribers[ i ].tickerId );
+
+    }
+
+    if( !it->second.snapshot ) 
+    {
+
+        std::map< std::string, int >::iterator shared = m_streaming.find( it->second.key );
+
+        if( shared != m_streaming.end() && shared->second == it->first )
+            m_streaming.erase( shared );
+
+        // TWS dropped it already, a replay after reconnect would only fail again
+        if( m_pClient->requestJournal() )
+            m_pClient->requestJournal()->erase( REQ_MKT_DATA, it->first );
+
+    }
+
+    m_subscriptions.erase( it );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::dropPeer( int peerId )
+{
+
+    std::map< int, Peer >::iterator it = m_peers.find( peerId );
+
+    if( it == m_peers.end() )
+        return;
+
+    Peer& peer = it->second;
+
+    while( !peer.tickers.empty() )
+        unsubscribe( peerId, peer, peer.tickers.begin()->first );
+
+    SocketClose( peer.fd );
+
+    m_peers.erase( it );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::sendError(       Peer&               peer, 
+                                int                 id, 
+                                const std::string&  text            )
+{
+
+    std::string fields;
+
+    appendField( fields, ( long )ERR_MSG );
+    appendField( fields, 2L );
+    appendField( fields, ( long )id );
+    appendField( fields, ( long )GATEWAY_REJECTED.code() );
+    appendField( fields, GATEWAY_REJECTED.msg() + text );
+
+    appendFrame( peer.out, fields );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::route(           int                 upstreamId, 
+                                const char*         begin, 
+                                const char*         end, 
+                                int                 idField, 
+                                const std::string&  cacheKey        )
+{
+
+    std::map< int, Subscription >::iterator it = m_subscriptions.find( upstreamId );
+
+    if( it == m_subscriptions.end() )
+        return;
+
+    Subscription& sub = it->second;
+
+    if( !cacheKey.empty() ) 
+    {
+
+        std::string& frame = sub.last[ cacheKey ];
+
+        frame.assign( 1, ( char )idField );
+        frame.append( begin, end - begin );
+
+    }
+
+    for( size_t i = 0; i < sub.subscribers.size(); ++i ) 
+    {
+
+        std::map< int, Peer >::iterator peer = m_peers.find( sub.subscribers[ i ].peer );
+
+        if( peer != m_peers.end() )
+            appendRewritten( peer->second.out, begin, end, idField, sub.subscribers[ i ].tickerId );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EGateway::onMessage(       const char*     begin, 
+                                const char*     end             )
+{
+
+    {
+
+        EMutexGuard lock( m_csGateway );
+
+        const char* fields[ FIELDS_MAX + 1 ];
+
+        int n = splitFields( begin, end, fields, 4 );
+
+        int msgId   = n > 0 ? atoi( fields[ 0 ] ) : 0;
+        int idField = 2;
+
+        bool cached = true;
+
+        switch( msgId ) 
+        {
+
+            case NEXT_VALID_ID:
+
+                if( n >= 3 )
+                    m_nextValidId = atol( fields[ 2 ] );
+
+                msgId = 0;
+
+                break;
+
+            case MANAGED_ACCTS:
+
+                if( n >= 3 )
+                    m_accounts.assign( fields[ 2 ], fields[ 3 ] - fields[ 2 ] - 1 );
+
+                msgId = 0;
+
+                break;
+
+            case TICK_PRICE:
+            case TICK_SIZE:
+            case TICK_GENERIC:
+            case TICK_STRING:
+            case TICK_EFP:
+                break;
+
+            case TICK_OPTION_COMPUTATION:
+
+                if( m_pClient->EClient::serverVersion() >= MIN_SERVER_VER_PRICE_BASED_VOLATILITY )
+                    idField = 1;
+
+                break;
+
+            case MARKET_DATA_TYPE:
+                break;
+
+            case TICK_REQ_PARAMS:
+                idField = 1;
+                break;
+
+            case TICK_NEWS:
+                idField = 1;
+                cached  = false;
+                break;
+
+            case TICK_SNAPSHOT_END:
+            case ERR_MSG:
+                cached = false;
+                break;
+
+            default:
+                msgId = 0;
+                break;
+
+        }
+
+        if( msgId && n > idField ) 
+        {
+
+            int id = atoi( fields[ idField ] );
+
+            if( msgId == ERR_MSG && id == NO_VALID_ID ) 
+            {
+
+                // connectivity notices concern every process
+                for( std::map< int, Peer >::iterator it = m_peers.begin(); it != m_peers.end(); ++it ) 
+                {
+
+                    if( it->second.started )
+                        appendRewritten( it->second.out, begin, end, idField, id );
+
+                }
+
+            }
+            else 
+            {
+
+                // per tick type for the tick messages, one per subscription otherwise
+                std::string cacheKey;
+
+                if( cached ) 
+                {
+
+                    cacheKey.assign( fields[ 0 ], fields[ 1 ] - fields[ 0 ] );
+
+                    if( n > idField + 1 && msgId != MARKET_DATA_TYPE && msgId != TICK_REQ_PARAMS )
+                        cacheKey.append( fields[ idField + 1 ], fields[ idField + 2 ] - fields[ idField + 1 ] );
+
+                }
+
+                route( id, begin, end, idField, cacheKey );
+
+                std::map< int, Subscription >::iterator it = m_subscriptions.find( id );
+
+                if( it != m_subscriptions.end() ) 
+                {
+
+                    // errors are not cached, so a dead upstream id must not be joined again
+                    if( msgId == ERR_MSG && n > 3 && ERequestRouter::terminatesRequest( atoi( fields[ 3 ] ) ) )
+                        retire( it );
+                    else if( msgId == TICK_SNAPSHOT_END && it->second.snapshot )
+                        retire( it );
+
+                }
+
+            }
+
+        }
+
+    }
+
+    if( m_pNextTap )
+        m_pNextTap->onMessage( begin, end );
+
+}
+
+//***************************************************************************************************
+
+void EGateway::pump()
+{
+
+    EMutexGuard lock( m_csGateway );
+
+    acceptPeers();
+
+    for( std::map< int, Peer >::iterator it = m_peers.begin(); it != m_peers.end(); ) 
+    {
+
+        int     peerId  = it->first;
+        Peer&   peer    = it->second;
+
+        bool open = ELocalServer::receive( peer.fd, peer.in );
+
+        // serve what arrived even if the process went away right after sending it
+        bool alive = parse( peerId, peer ) && open && ELocalServer::flush( peer.fd, peer.out );
+
+        ++it;
+
+        if( !alive )
+            dropPeer( peerId );
+
+    }
+
+}
@@ -0,0 +1,145 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EGATEWAY_H
+#define TWS_API_CLIENT_EGATEWAY_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "ELocalServer.h"
+#include "EMessageTap.h"
+#include "EMutex.h"
+
+
+class EClientSocket;
+
+
+
+//******************************************************************************************
+// local multiplexing gateway: shares the TWS connection of one client among any number
+// of local processes. Downstream it speaks the TWS socket protocol ( v100+ handshake,
+// framed messages ), so an unmodified EClientSocket connects to it as it would to TWS.
+//
+// Market data is deduplicated: identical reqMktData requests ( same contract, generic
+// ticks and options ) from different processes share one upstream subscription, whose
+// ticks are fanned out with each subscriber's own tickerId. A late subscriber first gets
+// the latest value of every tick type already received. Snapshots are never shared.
+//
+// Served locally: startApi ( nextValidId + managedAccounts ), reqIds, reqCurrentTime.
+// Anything else is answered with a GATEWAY_REJECTED error.
+//
+// Upstream subscriptions go through the client's journal, so an ESession reconnect
+// restores them without the downstream processes noticing. onMessage() runs on the
+// processMsgs thread; pump() must be called regularly from the application loop.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EGateway : public EMessageTap
+{
+
+    struct Peer 
+    {
+        int                         fd;
+        bool                        handshaken;     // version exchanged
+        bool                        started;        // startApi received
+        std::string                 in;             // bytes not parsed yet
+        std::string                 out;            // bytes not written yet
+        std::map< int, int >        tickers;        // downstream tickerId -> upstream tickerId
+    };
+
+    struct Subscriber 
+    {
+        int                         peer;
+        int                         tickerId;
+    };
+
+    struct Subscription 
+    {
+        std::string                             key;        // request fields after the tickerId
+        bool                                    snapshot;
+        std::vector< Subscriber >               subscribers;
+        std::map< std::string, std::string >    last;       // latest frame per message / tick type
+    };
+
+    EClientSocket*                  m_pClient;
+    EMessageTap*                    m_pNextTap;         // tap installed before the gateway
+
+    mutable EMutex                  m_csGateway;
+
+    ELocalServer                    m_server;
+    std::map< int, Peer >           m_peers;            // by a gateway local peer id
+    int                             m_nextPeerId;
+
+    std::map< int, Subscription >   m_subscriptions;    // by upstream tickerId
+    std::map< std::string, int >    m_streaming;        // key -> upstream tickerId
+    int                             m_nextTickerId;
+
+    long                            m_nextValidId;
+    std::string                     m_accounts;
+
+
+    void                acceptPeers         (                                                       );
+    bool                parse               (       int             peerId, 
+                                                    Peer&           peer                            );
+    bool                handshake           (       Peer&           peer                            );
+    void                handle              (       int             peerId, 
+                                                    Peer&           peer, 
+                                                    const char*     begin, 
+                                                    const char*     end                             );
+
+    void                subscribe           (       int             peerId, 
+                                                    Peer&           peer, 
+                                                    int             tickerId, 
+                                                    const char*     begin, 
+                                                    const char*     end                             );
+    void                unsubscribe         (       int             peerId, 
+                                                    Peer&           peer, 
+                                                    int             tickerId                        );
+    void                dropPeer            (       int             peerId                          );
+
+    // forgets an upstream subscription that ended ( snapshot end or a terminal error )
+    void                retire              (       std::map< int, Subscription >::iterator it      );
+
+    void                route               (       int             upstreamId, 
+                                                    const char*     begin, 
+                                                    const char*     end, 
+                                                    int             idField, 
+                                                    const std::string& cacheKey                     );
+    void                sendError           (       Peer&           peer, 
+                                                    int             id, 
+                                                    const std::string& text                         );
+
+public:
+
+    static const int    DEFAULT_FIRST_TICKER_ID = 1 << 28;              // clear of the client's own ids
+
+    // installs itself as the client's message tap, in front of any tap already set
+    explicit EGateway(                              EClientSocket*  client                          );
+            ~EGateway();
+
+    // listens for local processes, on the loopback interface unless another host is given
+    bool                listen              (       int             port, 
+                                                    const char*     host        = 0                 );
+    void                close               (                                                       );
+
+    // accepts, serves the downstream requests and writes the fanned out messages
+    void                pump                (                                                       );
+
+    // first upstream tickerId used, before any subscription is made
+    void                setFirstTickerId    (       int             tickerId                        );
+
+    size_t              peers               (                                                       ) const;
+    size_t              upstreamSubscriptions(                                                      ) const;
+    size_t              downstreamSubscriptions(                                                    ) const;
+
+    // EMessageTap
+    void                onMessage           (       const char*     begin, 
+                                                    const char*     end                             );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,535 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EIndicators.h"
+
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define INDICATORS_SSE2
+#endif
+
+
+namespace {
+
+    const size_t    CHUNK   = 256;      // stack scratch when the caller wants no per element output
+
+    //***************************************************************************************************
+    // tr[ i ] = max( high - low, | high - previous close |, | low - previous close | ); the
+    // first element uses prevClose, or high - low if there is none ( NaN )
+
+    void trueRanges(        const double*   high, 
+                            const double*   low, 
+                            const double*   close, 
+                            size_t          n, 
+                            double          prevClose, 
+                            double*         tr          )
+    {
+
+        if( n == 0 )
+            return;
+
+        tr[ 0 ] = high[ 0 ] - low[ 0 ];
+
+        if( prevClose == prevClose ) 
+        {
+            tr[ 0 ] = fmax( tr[ 0 ], fabs( high[ 0 ] - prevClose ) );
+            tr[ 0 ] = fmax( tr[ 0 ], fabs( low[ 0 ]  - prevClose ) );
+        }
+
+        size_t i = 1;
+
+#if defined(INDICATORS_SSE2)
+
+        const __m128d signMask = _mm_set1_pd( -0.0 );
+
+        for( ; i + 2 <= n; i += 2 ) 
+        {
+
+            __m128d h   = _mm_loadu_pd( high + i );
+            __m128d l   = _mm_loadu_pd( low + i );
+            __m128d pc  = _mm_loadu_pd( close + i - 1 );
+
+            __m128d r   = _mm_sub_pd( h, l );
+            __m128d up  = _mm_andnot_pd( signMask, _mm_sub_pd( h, pc ) );
+            __m128d dn  = _mm_andnot_pd( signMask, _mm_sub_pd( l, pc ) );
+
+            _mm_storeu_pd( tr + i, _mm_max_pd( r, _mm_max_pd( up, dn ) ) );
+
+        }
+
+#endif
+
+        for( ; i < n; ++i ) 
+        {
+
+            double r = high[ i ] - low[ i ];
+
+            r = fmax( r, fabs( high[ i ] - close[ i - 1 ] ) );
+            r = fmax( r, fabs( low[ i ]  - close[ i - 1 ] ) );
+
+            tr[ i ] = r;
+
+        }
+
+    }
+
+    //***************************************************************************************************
+    // out[ i ] = a[ i ] * b[ i ]
+
+    void products(          const double*   a, 
+                            const double*   b, 
+                            size_t          n, 
+                            double*         out         )
+    {
+
+        size_t i = 0;
+
+#if defined(INDICATORS_SSE2)
+
+        for( ; i + 2 <= n; i += 2 )
+            _mm_storeu_pd( out + i, _mm_mul_pd( _mm_loadu_pd( a + i ), _mm_loadu_pd( b + i ) ) );
+
+#endif
+
+        for( ; i < n; ++i )
+            out[ i ] = a[ i ] * b[ i ];
+
+    }
+
+    //***************************************************************************************************
+    // out[ i ] = values[ i ] - shift
+
+    void shifted(           const double*   values, 
+                            size_t          n, 
+                            double          shift, 
+                            double*         out         )
+    {
+
+        size_t i = 0;
+
+#if defined(INDICATORS_SSE2)
+
+        const __m128d s = _mm_set1_pd( shift );
+
+        for( ; i + 2 <= n; i += 2 )
+            _mm_storeu_pd( out + i, _mm_sub_pd( _mm_loadu_pd( values + i ), s ) );
+
+#endif
+
+        for( ; i < n; ++i )
+            out[ i ] = values[ i ] - shift;
+
+    }
+
+}
+
+
+//***************************************************************************************************
+//***************************************************************************************************
+
+EEma::EEma( int period )
+
+    : m_alpha   (   2.0 / ( ( period > 0 ? period : 1 ) + 1 )   )
+    , m_value   (   0                                           )
+    , m_period  (   period > 0 ? period : 1                     )
+    , m_count   (   0                                           )
+{
+}
+
+//***************************************************************************************************
+
+double EEma::update( double value )
+{
+
+    m_value = m_count++ ? m_value + m_alpha * ( value - m_value ) : value;
+
+    return m_value;
+
+}
+
+//***************************************************************************************************
+
+void EEma::backfill(            const double*   values, 
+                                size_t          n, 
+                                double*         out             )
+{
+
+    if( n == 0 )
+        return;
+
+    size_t i = 0;
+
+    if( m_count == 0 )
+        m_value = values[ 0 ];
+
+    double ema      = m_value;
+    double alpha    = m_alpha;
+
+    if( m_count == 0 ) 
+    {
+
+        if( out )
+            out[ 0 ] = ema;
+
+        i = 1;
+
+    }
+
+    if( out ) 
+    {
+        for( ; i < n; ++i )
+            out[ i ] = ema += alpha * ( values[ i ] - ema );
+    }
+    else 
+    {
+        for( ; i < n; ++i )
+            ema += alpha * ( values[ i ] - ema );
+    }
+
+    m_value  = ema;
+    m_count += n;
+
+}
+
+//***************************************************************************************************
+
+void EEma::reset()
+{
+
+    m_value = 0;
+    m_count = 0;
+
+}
+
+//***************************************************************************************************
+//***************************************************************************************************
+
+EVwap::EVwap()
+
+    : m_notional    (   0   )
+    , m_volume      (   0   )
+    , m_value       (   0   )
+{
+}
+
+//***************************************************************************************************
+
+double EVwap::update(           double          price, 
+                                double          volume          )
+{
+
+    if( volume <= 0 )
+        return m_value;
+
+    m_notional  += price * volume;
+    m_volume    += volume;
+    m_value      = m_notional / m_volume;
+
+    return m_value;
+
+}
+
+//***************************************************************************************************
+
+void EVwap::backfill(           const double*   prices, 
+                                const double*   volumes, 
+                                size_t          n, 
+                                double*         out             )
+{
+
+    double scratch[ CHUNK ];
+
+    for( size_t begin = 0; begin < n; begin += CHUNK ) 
+    {
+
+        size_t  count       = n - begin < CHUNK ? n - begin : CHUNK;
+        double* notional    = out ? out + begin : scratch;
+
+        products( prices + begin, volumes + begin, count, notional );
+
+        for( size_t i = 0; i < count; ++i ) 
+        {
+
+            double volume = volumes[ begin + i ];
+
+            if( volume > 0 ) 
+            {
+                m_notional  += notional[ i ];
+                m_volume    += volume;
+            }
+
+            // the division only when the caller wants every value
+            if( out )
+                notional[ i ] = m_volume > 0 ? m_notional / m_volume : m_value;
+
+        }
+
+    }
+
+    if( m_volume > 0 )
+        m_value = m_notional / m_volume;
+
+}
+
+//***************************************************************************************************
+
+void EVwap::reset()
+{
+
+    m_notional  = 0;
+    m_volume    = 0;
+    m_value     = 0;
+
+}
+
+//***************************************************************************************************
+//***************************************************************************************************
+
+ERollingStdev::ERollingStdev( int window )
+
+    : m_window      (   window > 0 ? window : 1     )
+{
+
+    reset();
+
+}
+
+//***************************************************************************************************
+
+void ERollingStdev::reset()
+{
+
+    m_next          = 0;
+    m_count         = 0;
+    m_wraps         = 0;
+    m_shift         = 0;
+    m_sum           = 0;
+    m_sumSquares    = 0;
+
+}
+
+//***************************************************************************************************
+
+void ERollingStdev::recompute()
+{
+
+    m_sum           = 0;
+    m_sumSquares    = 0;
+
+    for( size_t i = 0; i < m_count; ++i ) 
+    {
+        m_sum          += m_window[ i ];
+        m_sumSquares   += m_window[ i ] * m_window[ i ];
+    }
+
+}
+
+//***************************************************************************************************
+
+void ERollingStdev::push( double shifted )
+{
+
+    if( m_count == m_window.size() ) 
+    {
+
+        double old = m_window[ m_next ];
+
+        m_sum          -= old;
+        m_sumSquares   -= old * old;
+
+    }
+    else
+        ++m_count;
+
+    m_window[ m_next ] = shifted;
+
+    m_sum          += shifted;
+    m_sumSquares   += shifted * shifted;
+
+    if( ++m_next == m_window.size() ) 
+    {
+
+        m_next = 0;
+
+        // every 64 windows, O( 1 ) amortized
+        if( ++m_wraps % 64 == 0 )
+            recompute();
+
+    }
+
+}
+
+//***************************************************************************************************
+
+double ERollingStdev::update( double value )
+{
+
+    if( m_count == 0 && m_next == 0 )
+        m_shift = value;
+
+    push( value - m_shift );
+
+    return this->value();
+
+}
+
+//***************************************************************************************************
+
+void ERollingStdev::backfill(   const double*   values, 
+                                size_t          n, 
+                                double*         out             )
+{
+
+    if( n == 0 )
+        return;
+
+    if( m_count == 0 && m_next == 0 )
+        m_shift = values[ 0 ];
+
+    double scratch[ CHUNK ];
+
+    for( size_t begin = 0; begin < n; begin += CHUNK ) 
+    {
+
+        size_t count = n - begin < CHUNK ? n - begin : CHUNK;
+
+        shifted( values + begin, count, m_shift, scratch );
+
+        for( size_t i = 0; i < count; ++i ) 
+        {
+
+            push( scratch[ i ] );
+
+            if( out )
+                out[ begin + i ] = value();
+
+        }
+
+    }
+
+}
+
+//***************************************************************************************************
+
+double ERollingStdev::mean() const
+{
+
+    return m_count ? m_shift + m_sum / m_count : 0;
+
+}
+
+//***************************************************************************************************
+
+double ERollingStdev::value() const
+{
+
+    if( m_count == 0 )
+        return 0;
+
+    double m        = m_sum / m_count;
+    double variance = m_sumSquares / m_count - m * m;
+
+    return variance > 0 ? sqrt( variance ) : 0;
+
+}
+
+//***************************************************************************************************
+//***************************************************************************************************
+
+EAtr::EAtr( int period )
+
+    : m_value       (   0                       )
+    , m_prevClose   (   NAN                     )
+    , m_period      (   period > 0 ? period : 1 )
+    , m_count       (   0                       )
+{
+}
+
+//***************************************************************************************************
+
+double EAtr::update(            double          high, 
+                                double          low, 
+                                double          close           )
+{
+
+    double tr;
+
+    trueRanges( &high, &low, &close, 1, m_prevClose, &tr );
+
+    m_prevClose = close;
+
+    ++m_count;
+
+    // mean of the first 'period' ranges, Wilder's smoothing after
+    if( m_count <= m_period )
+        m_value += ( tr - m_value ) / m_count;
+    else
+        m_value += ( tr - m_value ) * ( 1.0 / m_period );     // as backfill() does
+
+    return m_value;
+
+}
+
+//***************************************************************************************************
+
+void EAtr::backfill(            const double*   highs, 
+                                const double*   lows, 
+                                const double*   closes, 
+                                size_t          n, 
+                                double*         out             )
+{
+
+    if( n == 0 )
+        return;
+
+    double scratch[ CHUNK ];
+
+    double      atr     = m_value;
+    long long   count   = m_count;
+    double      factor  = 1.0 / m_period;
+
+    for( size_t begin = 0; begin < n; begin += CHUNK ) 
+    {
+
+        size_t  chunk   = n - begin < CHUNK ? n - begin : CHUNK;
+        double* tr      = out ? out + begin : scratch;
+
+        trueRanges(     highs + begin, 
+                        lows + begin, 
+                        closes + begin, 
+                        chunk, 
+                        begin ? closes[ begin - 1 ] : m_prevClose, 
+                        tr                                          );
+
+        size_t i = 0;
+
+        for( ; i < chunk && count < m_period; ++i ) 
+        {
+            ++count;
+            tr[ i ] = atr += ( tr[ i ] - atr ) / count;
+        }
+
+        for( ; i < chunk; ++i )
+            tr[ i ] = atr += ( tr[ i ] - atr ) * factor;
+
+    }
+
+    m_value     = atr;
+    m_count     = count;
+    m_prevClose = closes[ n - 1 ];
+
+}
+
+//***************************************************************************************************
+
+void EAtr::reset()
+{
+
+    m_value     = 0;
+    m_prevClose = NAN;
+    m_count     = 0;
+
+}
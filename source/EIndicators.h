@@ -0,0 +1,155 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EINDICATORS_H
+#define TWS_API_CLIENT_EINDICATORS_H
+
+#include <stddef.h>
+#include <vector>
+#include "platformspecific.h"
+#include "bar.h"
+#include "EBarAggregator.h"
+
+
+
+//******************************************************************************************
+// incremental indicators: each update() is O(1) and allocation free, fed with bars
+// ( historicalData's Bar, EBarAggregator's EBar ), realtimeBar values or trades.
+//
+// backfill() warms an indicator from arrays of past values ( columns of historicalData )
+// and leaves it in the same state as the equivalent sequence of update() calls. The
+// element-wise parts ( true range, price x volume, deviations ) run on SSE2 two doubles
+// at a time where available; the recurrences themselves are serial by nature and run
+// as tight scalar loops. 'out', if given, receives the value after each element.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EEma
+{
+
+    double              m_alpha;
+    double              m_value;
+    int                 m_period;
+    long long           m_count;
+
+public:
+
+    // alpha = 2 / ( period + 1 ); seeded with the first value, ready after 'period' values
+    explicit EEma(                                  int             period                          );
+
+    double              update              (       double          value                           );
+    void                backfill            (       const double*   values, 
+                                                    size_t          n, 
+                                                    double*         out         = 0                 );
+    void                reset               (                                                       );
+
+    double              value               (                                                       ) const { return m_value;                   }
+    bool                ready               (                                                       ) const { return m_count >= m_period;       }
+    int                 period              (                                                       ) const { return m_period;                  }
+
+};
+
+//******************************************************************************************
+// volume weighted average price since the last reset() ( typically the session start )
+
+class TWSAPIDLLEXP EVwap
+{
+
+    double              m_notional;
+    double              m_volume;
+    double              m_value;
+
+public:
+
+    EVwap();
+
+    double              update              (       double          price, 
+                                                    double          volume                          );
+    double              update              (       const Bar&      bar                             ) { return update( bar.wap > 0 ? bar.wap : ( bar.high + bar.low + bar.close ) / 3, ( double )bar.volume );   }
+    double              update              (       const EBar&     bar                             ) { return update( bar.wap, ( double )bar.volume );  }
+
+    void                backfill            (       const double*   prices, 
+                                                    const double*   volumes, 
+                                                    size_t          n, 
+                                                    double*         out         = 0                 );
+    void                reset               (                                                       );
+
+    double              value               (                                                       ) const { return m_value;           }
+    double              volume              (                                                       ) const { return m_volume;          }
+
+};
+
+//******************************************************************************************
+// mean and population standard deviation of the last 'window' values. Sums are kept on
+// values shifted by the first one seen ( no cancellation on prices far from 0 ) and
+// recomputed from the window now and then so rounding cannot drift
+
+class TWSAPIDLLEXP ERollingStdev
+{
+
+    std::vector< double >   m_window;       // shifted values, ring
+    size_t                  m_next;
+    size_t                  m_count;        // values in the window
+    unsigned                m_wraps;
+    double                  m_shift;
+    double                  m_sum;
+    double                  m_sumSquares;
+
+    void                push                (       double          shifted                         );
+    void                recompute           (                                                       );
+
+public:
+
+    explicit ERollingStdev(                         int             window                          );
+
+    double              update              (       double          value                           );
+    void                backfill            (       const double*   values, 
+                                                    size_t          n, 
+                                                    double*         out         = 0                 );
+    void                reset               (                                                       );
+
+    double              mean                (                                                       ) const;
+    double              value               (                                                       ) const;
+    bool                ready               (                                                       ) const { return m_count == m_window.size();    }
+    int                 window              (                                                       ) const { return ( int )m_window.size();        }
+
+};
+
+//******************************************************************************************
+// average true range, Wilder's smoothing: the first value is the mean of 'period' true
+// ranges, then atr += ( tr - atr ) / period
+
+class TWSAPIDLLEXP EAtr
+{
+
+    double              m_value;
+    double              m_prevClose;
+    int                 m_period;
+    long long           m_count;
+
+public:
+
+    explicit EAtr(                                  int             period                          );
+
+    double              update              (       double          high, 
+                                                    double          low, 
+                                                    double          close                           );
+    double              update              (       const Bar&      bar                             ) { return update( bar.high, bar.low, bar.close );   }
+    double              update              (       const EBar&     bar                             ) { return update( bar.high, bar.low, bar.close );   }
+
+    void                backfill            (       const double*   highs, 
+                                                    const double*   lows, 
+                                                    const double*   closes, 
+                                                    size_t          n, 
+                                                    double*         out         = 0                 );
+    void                reset               (                                                       );
+
+    double              value               (                                                       ) const { return m_value;               }
+    bool                ready               (                                                       ) const { return m_count >= m_period;   }
+    int                 period              (                                                       ) const { return m_period;              }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,237 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ELatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+
+    const int       SUB_BUCKETS         = 1 << ELatencyHistogram::SUB_BUCKET_BITS;
+    const int       HALF_BUCKETS        = SUB_BUCKETS / 2;
+
+    int highestBit( uint64_t v )
+    {
+
+        int bit = 0;
+
+        while( v >>= 1 )
+            ++bit;
+
+        return bit;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+ELatencyHistogram::ELatencyHistogram()
+{
+
+    reset();
+
+}
+
+//***************************************************************************************************
+
+int ELatencyHistogram::bucketFor( int64_t valueUs )
+{
+
+    if( valueUs < 0 )
+        valueUs = 0;
+
+    if( valueUs > MAX_VALUE_US )
+        valueUs = MAX_VALUE_US;
+
+    if( valueUs < SUB_BUCKETS )
+        return ( int )valueUs;
+
+    // shift that brings the value into [ HALF_BUCKETS, SUB_BUCKETS )
+    int shift = highestBit( ( uint64_t )valueUs ) - SUB_BUCKET_BITS + 1;
+
+    return shift * HALF_BUCKETS + ( int )( valueUs >> shift );
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyHistogram::bucketLow( int bucket )
+{
+
+    if( bucket < SUB_BUCKETS )
+        return bucket;
+
+    int shift = bucket / HALF_BUCKETS - 1;
+
+    return int64_t( bucket - shift * HALF_BUCKETS ) << shift;
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyHistogram::bucketHigh( int bucket )
+{
+
+    if( bucket < SUB_BUCKETS )
+        return bucket;
+
+    int shift = bucket / HALF_BUCKETS - 1;
+
+    return ( int64_t( bucket - shift * HALF_BUCKETS + 1 ) << shift ) - 1;
+
+}
+
+//***************************************************************************************************
+
+void ELatencyHistogram::record( int64_t valueUs )
+{
+
+    if( valueUs < 0 )
+        valueUs = 0;
+
+    m_counts[ bucketFor( valueUs ) ].fetch_add( 1, std::memory_order_relaxed );
+
+    m_sum.fetch_add( valueUs, std::memory_order_relaxed );
+
+    int64_t cur = m_min.load( std::memory_order_relaxed );
+
+    while( valueUs < cur && !m_min.compare_exchange_weak( cur, valueUs, std::memory_order_relaxed ) )
+        ;
+
+    cur = m_max.load( std::memory_order_relaxed );
+
+    while( valueUs > cur && !m_max.compare_exchange_weak( cur, valueUs, std::memory_order_relaxed ) )
+        ;
+
+    // published last, a reader seeing the count sees the bucket too
+    m_total.fetch_add( 1, std::memory_order_release );
+
+}
+
+//***************************************************************************************************
+
+void ELatencyHistogram::reset()
+{
+
+    for( int i = 0; i < BUCKET_COUNT; ++i )
+        m_counts[ i ].store( 0, std::memory_order_relaxed );
+
+    m_sum.store( 0, std::memory_order_relaxed );
+    m_min.store( INT64_MAX, std::memory_order_relaxed );
+    m_max.store( 0, std::memory_order_relaxed );
+
+    m_total.store( 0, std::memory_order_release );
+
+}
+
+//***************************************************************************************************
+
+uint64_t ELatencyHistogram::count() const
+{
+
+    return m_total.load( std::memory_order_acquire );
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyHistogram::min() const
+{
+
+    return count() ? m_min.load( std::memory_order_relaxed ) : 0;
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyHistogram::max() const
+{
+
+    return m_max.load( std::memory_order_relaxed );
+
+}
+
+//***************************************************************************************************
+
+double ELatencyHistogram::mean() const
+{
+
+    uint64_t n = count();
+
+    return n ? ( double )m_sum.load( std::memory_order_relaxed ) / n : 0.0;
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyHistogram::percentile( double percentile ) const
+{
+
+    uint64_t n = count();
+
+    if( !n )
+        return 0;
+
+    percentile = ( std::min )( ( std::max )( percentile, 0.0 ), 100.0 );
+
+    uint64_t rank = ( uint64_t )std::ceil( percentile / 100.0 * n );
+
+    if( rank == 0 )
+        rank = 1;
+
+    uint64_t seen = 0;
+
+    for( int i = 0; i < BUCKET_COUNT; ++i ) 
+    {
+
+        seen += m_counts[ i ].load( std::memory_order_relaxed );
+
+        if( seen >= rank )
+            return ( std::min )( bucketHigh( i ), max() );
+
+    }
+
+    return max();
+
+}
+
+//***************************************************************************************************
+
+void ELatencyHistogram::add( const ELatencyHistogram& other )
+{
+
+    if( &other == this || !other.count() )
+        return;
+
+    for( int i = 0; i < BUCKET_COUNT; ++i ) 
+    {
+
+        uint64_t n = other.m_counts[ i ].load( std::memory_order_relaxed );
+
+        if( n )
+            m_counts[ i ].fetch_add( n, std::memory_order_relaxed );
+
+    }
+
+    m_sum.fetch_add( other.m_sum.load( std::memory_order_relaxed ), std::memory_order_relaxed );
+
+    int64_t v   = other.m_min.load( std::memory_order_relaxed );
+    int64_t cur = m_min.load( std::memory_order_relaxed );
+
+    while( v < cur && !m_min.compare_exchange_weak( cur, v, std::memory_order_relaxed ) )
+        ;
+
+    v   = other.m_max.load( std::memory_order_relaxed );
+    cur = m_max.load( std::memory_order_relaxed );
+
+    while( v > cur && !m_max.compare_exchange_weak( cur, v, std::memory_order_relaxed ) )
+        ;
+
+    m_total.fetch_add( other.count(), std::memory_order_release );
+
+}
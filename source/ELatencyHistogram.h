@@ -0,0 +1,72 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ELATENCYHISTOGRAM_H
+#define TWS_API_CLIENT_ELATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <cstdint>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// HDR-style histogram of latencies in microseconds: values below 2^SUB_BUCKET_BITS are
+// counted exactly, above that every power of two is split in 2^( SUB_BUCKET_BITS - 1 )
+// linear buckets, so any recorded value is known to within 1/64 ( ~1.6% ) of itself.
+// Values above MAX_VALUE_US are counted in the last bucket.
+//
+// record() is wait-free and may run concurrently with the queries, which then see a
+// consistent enough snapshot for monitoring ( counts are read one bucket at a time ).
+//******************************************************************************************
+
+class TWSAPIDLLEXP ELatencyHistogram
+{
+
+public:
+
+    static const int        SUB_BUCKET_BITS     = 7;
+    static const int        MAX_VALUE_BITS      = 36;       // ~19 hours
+
+    static const int64_t    MAX_VALUE_US        = ( int64_t( 1 ) << MAX_VALUE_BITS ) - 1;
+
+    static const int        BUCKET_COUNT        = ( MAX_VALUE_BITS - SUB_BUCKET_BITS + 2 ) << ( SUB_BUCKET_BITS - 1 );
+
+    ELatencyHistogram();
+
+    void                record              (       int64_t         valueUs                         );
+    void                reset               (                                                       );
+
+    uint64_t            count               (                                                       ) const;
+    int64_t             min                 (                                                       ) const;
+    int64_t             max                 (                                                       ) const;
+    double              mean                (                                                       ) const;
+
+    // value below which 'percentile' ( 0 - 100 ) percent of the samples fall, reported as
+    // the top of the bucket holding it, 0 if nothing was recorded
+    int64_t             percentile          (       double          percentile                      ) const;
+
+    // folds the counts of 'other' into this one
+    void                add                 (       const ELatencyHistogram&    other               );
+
+    static int          bucketFor           (       int64_t         valueUs                         );
+    static int64_t      bucketLow           (       int             bucket                          );
+    static int64_t      bucketHigh          (       int             bucket                          );
+
+private:
+
+    ELatencyHistogram                       (       const ELatencyHistogram&                        );
+    ELatencyHistogram&  operator=           (       const ELatencyHistogram&                        );
+
+    std::atomic< uint64_t >     m_counts[ BUCKET_COUNT ];
+    std::atomic< uint64_t >     m_total;
+    std::atomic< int64_t >      m_sum;
+    std::atomic< int64_t >      m_min;
+    std::atomic< int64_t >      m_max;
+
+};
+
+//******************************************************************************************
+
+#endif
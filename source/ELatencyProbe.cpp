@@ -0,0 +1,273 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ELatencyProbe.h"
+
+
+//***************************************************************************************************
+
+ELatencyProbe::ELatencyProbe( int intervalMs )
+
+    : m_nextProbe   (   Clock::now()            )
+    , m_intervalMs  (   intervalMs              )
+    , m_timeoutMs   (   DEFAULT_TIMEOUT_MS      )
+    , m_sent        (   0                       )
+    , m_received    (   0                       )
+    , m_lost        (   0                       )
+    , m_lastUs      (   -1                      )
+{
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::setInterval( int intervalMs )
+{
+
+    EMutexGuard lock( m_csPending );
+
+    m_intervalMs    = intervalMs;
+    m_nextProbe     = Clock::now();
+
+}
+
+//***************************************************************************************************
+
+int ELatencyProbe::interval() const
+{
+
+    return m_intervalMs;
+
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::setTimeout( int timeoutMs )
+{
+
+    EMutexGuard lock( m_csPending );
+
+    m_timeoutMs = timeoutMs;
+
+}
+
+//***************************************************************************************************
+
+int ELatencyProbe::timeout() const
+{
+
+    return m_timeoutMs;
+
+}
+
+//***************************************************************************************************
+
+bool ELatencyProbe::due() const
+{
+
+    Clock::time_point now = Clock::now();
+
+    EMutexGuard lock( m_csPending );
+
+    if( m_intervalMs <= 0 || now < m_nextProbe )
+        return false;
+
+    // one probe in flight at a time, a stalled gateway must not pile them up. One past
+    // the timeout no longer counts, or a single lost reply would stop the probing
+    for( size_t i = 0; i < m_pending.size(); ++i ) 
+    {
+
+        const Pending& p = m_pending[ i ];
+
+        if( p.probe && !p.lost && ( m_timeoutMs <= 0 || now - p.sentAt < std::chrono::milliseconds( m_timeoutMs ) ) )
+            return false;
+
+    }
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::requestSent( bool probe )
+{
+
+    Pending p;
+
+    p.sentAt    = Clock::now();
+    p.probe     = probe;
+    p.lost      = false;
+
+    {
+
+        EMutexGuard lock( m_csPending );
+
+        expire( p.sentAt );
+
+        m_pending.push_back( p );
+
+        if( probe )
+            m_nextProbe = p.sentAt + std::chrono::milliseconds( m_intervalMs );
+
+    }
+
+    ++m_sent;
+
+}
+
+//***************************************************************************************************
+
+bool ELatencyProbe::replyReceived()
+{
+
+    Clock::time_point now = Clock::now();
+
+    Pending p;
+
+    {
+
+        EMutexGuard lock( m_csPending );
+
+        expire( now );
+
+        // empty: answer to a request sent before the probe was set
+        if( m_pending.empty() )
+            return false;
+
+        // TWS answers in order: the oldest request is the one answered, even if given up on
+        p = m_pending.front();
+
+        m_pending.pop_front();
+
+    }
+
+    if( p.lost )
+        return p.probe;
+
+    int64_t us = std::chrono::duration_cast< std::chrono::microseconds >( now - p.sentAt ).count();
+
+    m_histogram.record( us );
+
+    m_lastUs = us;
+
+    ++m_received;
+
+    return p.probe;
+
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::expire( Clock::time_point now )
+{
+
+    if( m_timeoutMs <= 0 )
+        return;
+
+    Clock::time_point limit = now - std::chrono::milliseconds( m_timeoutMs );
+
+    // oldest first: stop at the first one still in time
+    for( size_t i = 0; i < m_pending.size() && m_pending[ i ].sentAt < limit; ++i ) 
+    {
+
+        if( !m_pending[ i ].lost ) 
+        {
+            m_pending[ i ].lost = true;
+            ++m_lost;
+        }
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::connectionClosed()
+{
+
+    EMutexGuard lock( m_csPending );
+
+    for( size_t i = 0; i < m_pending.size(); ++i ) 
+    {
+
+        if( !m_pending[ i ].lost )
+            ++m_lost;
+
+    }
+
+    m_pending.clear();
+
+    m_nextProbe = Clock::now();
+
+}
+
+//***************************************************************************************************
+
+const ELatencyHistogram& ELatencyProbe::histogram() const
+{
+
+    return m_histogram;
+
+}
+
+//***************************************************************************************************
+
+unsigned long long ELatencyProbe::sent() const
+{
+
+    return m_sent;
+
+}
+
+//***************************************************************************************************
+
+unsigned long long ELatencyProbe::received() const
+{
+
+    return m_received;
+
+}
+
+//***************************************************************************************************
+
+unsigned long long ELatencyProbe::lost() const
+{
+
+    return m_lost;
+
+}
+
+//***************************************************************************************************
+
+size_t ELatencyProbe::outstanding() const
+{
+
+    EMutexGuard lock( m_csPending );
+
+    return m_pending.size();
+
+}
+
+//***************************************************************************************************
+
+int64_t ELatencyProbe::lastRttUs() const
+{
+
+    return m_lastUs;
+
+}
+
+//***************************************************************************************************
+
+void ELatencyProbe::reset()
+{
+
+    m_histogram.reset();
+
+    m_sent      = 0;
+    m_received  = 0;
+    m_lost      = 0;
+    m_lastUs    = -1;
+
+}
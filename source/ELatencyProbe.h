@@ -0,0 +1,105 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ELATENCYPROBE_H
+#define TWS_API_CLIENT_ELATENCYPROBE_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include "platformspecific.h"
+#include "EMutex.h"
+#include "ELatencyHistogram.h"
+
+
+
+//******************************************************************************************
+// application level round trip of a connection, measured with reqCurrentTime.
+//
+// Once set on a client ( EClient::setLatencyProbe, before connecting ) every
+// reqCurrentTime is timestamped and, since TWS answers them in order, each currentTime
+// reply is matched to the oldest one outstanding. On top of that the client sends a
+// probe of its own every interval() ms from processMsgs; replies to those are recorded
+// and swallowed, the EWrapper only sees currentTime for the requests it made itself.
+//
+// The round trip includes the client side pacer queue and the time the reply waits
+// for processMsgs, i.e. what the application would actually experience.
+//
+// Thread safe: sends, replies and queries may come from different threads.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ELatencyProbe
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    struct Pending 
+    {
+        Clock::time_point   sentAt;
+        bool                probe;          // sent by the probe itself, reply is not forwarded
+        bool                lost;           // timed out, already counted in m_lost
+    };
+
+    std::deque< Pending >           m_pending;
+    Clock::time_point               m_nextProbe;
+    int                             m_intervalMs;
+    int                             m_timeoutMs;
+
+    ELatencyHistogram               m_histogram;
+
+    std::atomic< unsigned long long >   m_sent;
+    std::atomic< unsigned long long >   m_received;
+    std::atomic< unsigned long long >   m_lost;
+    std::atomic< int64_t >              m_lastUs;
+
+    mutable EMutex                  m_csPending;
+
+
+    void                expire              (       Clock::time_point   now                         );
+
+public:
+
+    static const int    DEFAULT_INTERVAL_MS     = 1000;
+    static const int    DEFAULT_TIMEOUT_MS      = 10000;
+
+    explicit ELatencyProbe(                         int             intervalMs  = DEFAULT_INTERVAL_MS   );
+
+    // <= 0 stops the periodic probes, reqCurrentTime calls of the application are still measured
+    void                setInterval         (       int             intervalMs                      );
+    int                 interval            (                                                       ) const;
+
+    // a request without reply after this long counts as lost; it stays in line so that a
+    // late reply still consumes its own request, but no round trip is recorded for it
+    void                setTimeout          (       int             timeoutMs                       );
+    int                 timeout             (                                                       ) const;
+
+    // client side: true when the next probe should go out
+    bool                due                 (                                                       ) const;
+
+    void                requestSent         (       bool            probe                           );
+
+    // true if the reply answered a probe and must not reach the EWrapper
+    bool                replyReceived       (                                                       );
+
+    // the connection went away: outstanding requests will never be answered
+    void                connectionClosed    (                                                       );
+
+    const ELatencyHistogram&    histogram   (                                                       ) const;
+
+    unsigned long long  sent                (                                                       ) const;
+    unsigned long long  received            (                                                       ) const;
+    unsigned long long  lost                (                                                       ) const;
+    size_t              outstanding         (                                                       ) const;    // lost ones included
+
+    // last measured round trip in microseconds, -1 before the first reply
+    int64_t             lastRttUs           (                                                       ) const;
+
+    // clears the histogram and counters, not the requests in flight
+    void                reset               (                                                       );
+
+};
+
+//******************************************************************************************
+
+#endif
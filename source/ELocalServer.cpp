@@ -0,0 +1,186 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EPosixClientSocketPlatform.h"
+#include "ELocalServer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+#if defined(MSG_NOSIGNAL)
+    #define LOCAL_SEND_FLAGS    MSG_NOSIGNAL    // a peer going away must not SIGPIPE the server
+#else
+    #define LOCAL_SEND_FLAGS    0
+#endif
+
+
+const size_t ELocalServer::MAX_PEER_BACKLOG;
+
+//***************************************************************************************************
+
+ELocalServer::ELocalServer()
+
+    : m_listenFd            (   -1                          )
+{
+
+    SocketsInit();
+
+}
+
+//***************************************************************************************************
+
+ELocalServer::~ELocalServer()
+{
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool ELocalServer::listen(      int             port, 
+                                const char*     host, 
+                                int             backlog         )
+{
+
+    close();
+
+    struct addrinfo hints;
+
+    memset( &hints, 0, sizeof( hints ) );
+
+    hints.ai_family     = AF_UNSPEC;
+    hints.ai_socktype   = SOCK_STREAM;
+    hints.ai_flags      = AI_PASSIVE;
+
+    char service[ 16 ];
+
+    snprintf( service, sizeof( service ), "%d", port );
+
+    struct addrinfo* res = 0;
+
+    if( getaddrinfo( ( host && *host ) ? host : "127.0.0.1", service, &hints, &res ) != 0 || !res )
+        return false;
+
+    for( struct addrinfo* ai = res; ai && m_listenFd < 0; ai = ai->ai_next ) 
+    {
+
+        int fd = ( int )socket( ai->ai_family, ai->ai_socktype, ai->ai_protocol );
+
+        if( fd < 0 )
+            continue;
+
+        int on = 1;
+
+        setsockopt( fd, SOL_SOCKET, SO_REUSEADDR, ( const char* )&on, sizeof( on ) );
+
+        if( bind( fd, ai->ai_addr, ( int )ai->ai_addrlen ) == 0 && 
+            ::listen( fd, backlog ) == 0 && 
+            SetSocketNonBlocking( fd ) ) 
+        {
+            m_listenFd = fd;
+        }
+        else
+            SocketClose( fd );
+
+    }
+
+    freeaddrinfo( res );
+
+    return m_listenFd >= 0;
+
+}
+
+//***************************************************************************************************
+
+void ELocalServer::close()
+{
+
+    if( m_listenFd >= 0 )
+        SocketClose( m_listenFd );
+
+    m_listenFd = -1;
+
+}
+
+//***************************************************************************************************
+
+int ELocalServer::accept()
+{
+
+    while( m_listenFd >= 0 ) 
+    {
+
+        int fd = ( int )::accept( m_listenFd, 0, 0 );
+
+        if( fd < 0 )
+            return -1;
+
+        if( SetSocketNonBlocking( fd ) )
+            return fd;
+
+        SocketClose( fd );
+
+    }
+
+    return -1;
+
+}
+
+//***************************************************************************************************
+
+bool ELocalServer::receive(     int             fd, 
+                                std::string&    in              )
+{
+
+    char buf[ 8192 ];
+
+    for( ;; ) 
+    {
+
+        int n = ( int )::recv( fd, buf, sizeof( buf ), 0 );
+
+        if( n > 0 ) 
+        {
+            in.append( buf, n );
+            continue;
+        }
+
+        if( n < 0 && ( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) )
+            return true;
+
+        return false;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+bool ELocalServer::flush(       int             fd, 
+                                std::string&    out             )
+{
+
+    while( !out.empty() ) 
+    {
+
+        int n = ( int )::send( fd, out.data(), ( int )out.size(), LOCAL_SEND_FLAGS );
+
+        if( n > 0 ) 
+        {
+            out.erase( 0, n );
+            continue;
+        }
+
+        if( n < 0 && ( errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR ) )
+            break;
+
+        return false;
+
+    }
+
+    return out.size() <= MAX_PEER_BACKLOG;
+
+}
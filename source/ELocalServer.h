@@ -0,0 +1,51 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ELOCALSERVER_H
+#define TWS_API_CLIENT_ELOCALSERVER_H
+
+#include <string>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// listening socket plus the non blocking peer i/o shared by the local servers ( EGateway,
+// EReplicaPublisher ): each keeps its own peer list and protocol, this only moves bytes.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ELocalServer
+{
+
+    int                 m_listenFd;
+
+public:
+
+    static const size_t MAX_PEER_BACKLOG    = 64 * 1024 * 1024;     // a peer this far behind is dropped
+
+    ELocalServer();
+    ~ELocalServer();
+
+    // on the loopback interface unless another host is given
+    bool                listen              (       int             port, 
+                                                    const char*     host, 
+                                                    int             backlog                         );
+    void                close               (                                                       );
+    bool                listening           (                                                       ) const { return m_listenFd >= 0; }
+
+    // next pending connection, already non blocking; -1 when there is none
+    int                 accept              (                                                       );
+
+    // read / write until the socket would block; false once the peer is gone, or for
+    // flush() when more than MAX_PEER_BACKLOG bytes are still waiting
+    static bool         receive             (       int             fd, 
+                                                    std::string&    in                              );
+    static bool         flush               (       int             fd, 
+                                                    std::string&    out                             );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,24 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EMESSAGETAP_H
+#define TWS_API_CLIENT_EMESSAGETAP_H
+
+
+//******************************************************************************************
+// sees every incoming message, undecoded, right before EReader::processMsgs decodes it
+// ( fields only, no length prefix ). Runs on the thread calling processMsgs.
+
+struct EMessageTap
+{
+
+    virtual void    onMessage       (       const char*     begin   ,   const char*     end     ) = 0;
+
+    virtual        ~EMessageTap     () {}
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,159 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EMPSCQUEUE_H
+#define TWS_API_CLIENT_EMPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+
+
+//******************************************************************************************
+// intrusive multi-producer / single-consumer queue ( D. Vyukov )
+//
+// push() may be called from any number of threads at once and never blocks: a producer
+// swings m_head to its node with one atomic exchange and then links the previous head.
+// pop() must only ever be called from one thread at a time.
+//
+// Between those two steps of a producer the list is briefly cut; pop() then reports
+// empty and the consumer simply picks the element up on its next pass.
+//******************************************************************************************
+
+template< class T >
+class EMpscQueue
+{
+
+    struct Node 
+    {
+
+        std::atomic< Node* >    next;
+        T                       value;
+
+        Node() : next( nullptr ) {}
+
+        explicit Node( T&& v ) : next( nullptr ), value( std::move( v ) ) {}
+
+    };
+
+    std::atomic< Node* >    m_head;     // last pushed node, producers side
+    Node*                   m_tail;     // next node to pop, consumer side
+    Node                    m_stub;
+
+    std::atomic< size_t >   m_size;
+
+
+    void                    link            (       Node*   node        )
+    {
+
+        Node* prev = m_head.exchange(   node, 
+                                        std::memory_order_acq_rel       );
+
+        prev->next.store(               node, 
+                                        std::memory_order_release       );
+
+    }
+
+    // disable copy ctor and assignment
+    EMpscQueue              (       const EMpscQueue&       );
+    EMpscQueue& operator=   (       const EMpscQueue&       );
+
+public:
+
+    EMpscQueue() : m_head( &m_stub ), m_tail( &m_stub ), m_size( 0 ) {}
+
+   ~EMpscQueue() 
+    {
+
+        T value;
+
+        while( pop( value ) );
+
+    }
+
+    //******************************************************************************************
+
+    void                    push            (       T&&     value       )
+    {
+
+        Node* node = new Node( std::move( value ) );
+
+        m_size.fetch_add( 1, std::memory_order_relaxed );
+
+        link( node );
+
+    }
+
+    //******************************************************************************************
+
+    bool                    pop             (       T&      value       )
+    {
+
+        Node* tail = m_tail;
+        Node* next = tail->next.load( std::memory_order_acquire );
+
+        if( tail == &m_stub ) 
+        {
+
+            if( !next )
+                return false;
+
+            m_tail  = next;
+            tail    = next;
+            next    = next->next.load( std::memory_order_acquire );
+
+        }
+
+        if( !next ) 
+        {
+
+            // a producer is between its exchange and its link
+            if( tail != m_head.load( std::memory_order_acquire ) )
+                return false;
+
+            m_stub.next.store( nullptr, std::memory_order_relaxed );
+
+            link( &m_stub );
+
+            next = tail->next.load( std::memory_order_acquire );
+
+            if( !next )
+                return false;
+
+        }
+
+        m_tail = next;
+
+        value = std::move( tail->value );
+
+        delete tail;
+
+        m_size.fetch_sub( 1, std::memory_order_relaxed );
+
+        return true;
+
+    }
+
+    //******************************************************************************************
+
+    // approximate while producers are active
+    size_t                  size            (                           ) const
+    {
+
+        return m_size.load( std::memory_order_relaxed );
+
+    }
+
+    bool                    empty           (                           ) const
+    {
+
+        return size() == 0;
+
+    }
+
+};
+
+//******************************************************************************************
+
+#endif
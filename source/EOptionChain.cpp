@@ -0,0 +1,526 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EOptionChain.h"
+#include "Contract.h"
+#include "EClient.h"
+#include "EOptionSurface.h"
+
+#include <algorithm>
+#include <math.h>
+
+
+namespace {
+
+    // strikes come back from contractDetails through a different decimal conversion
+    inline bool sameStrike( double a, double b )    { return fabs( a - b ) <= 1e-6 * ( 1 + fabs( a ) ); }
+
+}
+
+
+//***************************************************************************************************
+
+EOptionChain::EOptionChain()
+
+    : m_underlyingConId ( 0 )
+    , m_secType         ( "OPT" )
+    , m_currency        ( "USD" )
+    , m_conIds          ( std::make_shared< ConIdTable >() )
+
+{
+}
+
+//***************************************************************************************************
+
+void EOptionChain::assign(      const std::string&              exchange, 
+                                int                             underlyingConId, 
+                                const std::string&              tradingClass, 
+                                const std::string&              multiplier, 
+                                const std::set< std::string >&  expirations, 
+                                const std::set< double >&       strikes         )
+{
+
+    // a refresh of the same chain keeps what was learned: the table is keyed by value
+    if( underlyingConId != m_underlyingConId || tradingClass != m_tradingClass )
+        m_conIds = std::make_shared< ConIdTable >();
+
+    m_underlyingConId   = underlyingConId;
+    m_exchange          = exchange;
+    m_tradingClass      = tradingClass;
+    m_multiplier        = multiplier;
+
+    // std::set is already sorted
+    m_strikes.assign( strikes.begin(), strikes.end() );
+
+    m_expiries.clear();
+    m_expiries.reserve( expirations.size() );
+
+    for( std::set< std::string >::const_iterator it = expirations.begin(); it != expirations.end(); ++it ) 
+    {
+
+        int date = parseDate( *it );
+
+        if( date > 0 )
+            m_expiries.push_back( date );
+
+    }
+
+    std::sort( m_expiries.begin(), m_expiries.end() );
+    m_expiries.erase( std::unique( m_expiries.begin(), m_expiries.end() ), m_expiries.end() );
+
+}
+
+//***************************************************************************************************
+
+void EOptionChain::setUnderlying(   const std::string&  symbol, 
+                                    const std::string&  currency, 
+                                    const std::string&  secType     )
+{
+
+    m_symbol    = symbol;
+    m_currency  = currency;
+    m_secType   = secType;
+
+}
+
+//***************************************************************************************************
+
+EOptionChain::ConIdKey EOptionChain::key(  const EOptionChainNode& node    ) const
+{
+
+    ConIdKey k;
+
+    k.expiry    = m_expiries[ node.expiry ];
+    k.strike    = llround( m_strikes[ node.strike ] * 1e4 );
+    k.right     = node.right;
+
+    return k;
+
+}
+
+//***************************************************************************************************
+
+bool EOptionChain::learn(   const Contract&     contract    )
+{
+
+    if( contract.conId == 0 || contract.tradingClass != m_tradingClass || contract.right.empty() )
+        return false;
+
+    EOptionChainNode node;
+
+    node.expiry = expiryIndex( parseDate( contract.lastTradeDateOrContractMonth ) );
+    node.strike = strikeIndex( contract.strike );
+    node.right  = contract.right[ 0 ] == 'C' || contract.right[ 0 ] == 'c' ? 'C' : 'P';
+
+    if( node.expiry < 0 || node.strike < 0 )
+        return false;
+
+    ( *m_conIds )[ key( node ) ] = contract.conId;
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EOptionChain::shareConIds(     const EOptionChain& other   )
+{
+
+    m_conIds = other.m_conIds;
+
+}
+
+//***************************************************************************************************
+
+int EOptionChain::strikeIndex(  double  strike  ) const
+{
+
+    int i = atmIndex( strike );
+
+    return i >= 0 && sameStrike( m_strikes[ i ], strike ) ? i : -1;
+
+}
+
+//***************************************************************************************************
+
+int EOptionChain::expiryIndex(  int     yyyymmdd    ) const
+{
+
+    std::vector< int >::const_iterator it = std::lower_bound( m_expiries.begin(), m_expiries.end(), yyyymmdd );
+
+    return it != m_expiries.end() && *it == yyyymmdd ? ( int )( it - m_expiries.begin() ) : -1;
+
+}
+
+//***************************************************************************************************
+
+int EOptionChain::atmIndex(     double  underlying  ) const
+{
+
+    if( m_strikes.empty() )
+        return -1;
+
+    size_t i = std::lower_bound( m_strikes.begin(), m_strikes.end(), underlying ) - m_strikes.begin();
+
+    if( i == m_strikes.size() )
+        return ( int )i - 1;
+
+    if( i > 0 && underlying - m_strikes[ i - 1 ] < m_strikes[ i ] - underlying )
+        return ( int )i - 1;
+
+    return ( int )i;
+
+}
+
+//***************************************************************************************************
+
+int EOptionChain::firstExpiry(  int     yyyymmdd    ) const
+{
+
+    return ( int )( std::lower_bound( m_expiries.begin(), m_expiries.end(), yyyymmdd ) - m_expiries.begin() );
+
+}
+
+//***************************************************************************************************
+
+long EOptionChain::conId(   const EOptionChainNode& node    ) const
+{
+
+    ConIdTable::const_iterator it = m_conIds->find( key( node ) );
+
+    return it != m_conIds->end() ? it->second : 0;
+
+}
+
+//***************************************************************************************************
+
+size_t EOptionChain::select(    double                          underlying, 
+                                int                             strikesEachSide, 
+                                int                             expiries, 
+                                int                             fromDate, 
+                                char                            right, 
+                                std::vector< EOptionChainNode >& out            ) const
+{
+
+    int atm = atmIndex( underlying );
+
+    if( atm < 0 || strikesEachSide < 0 || expiries <= 0 )
+        return 0;
+
+    int lowStrike   = std::max( atm - strikesEachSide, 0 );
+    int highStrike  = std::min( atm + strikesEachSide, ( int )m_strikes.size() - 1 );
+    int firstExp    = firstExpiry( fromDate );
+    int lastExp     = std::min( firstExp + expiries, ( int )m_expiries.size() );
+
+    if( firstExp >= lastExp )
+        return 0;
+
+    size_t before   = out.size();
+    int    rights   = right == 0 ? 2 : 1;
+
+    out.reserve( before + ( size_t )( lastExp - firstExp ) * ( highStrike - lowStrike + 1 ) * rights );
+
+    EOptionChainNode node;
+
+    for( node.expiry = firstExp; node.expiry < lastExp; ++node.expiry ) 
+    {
+
+        for( node.strike = lowStrike; node.strike <= highStrike; ++node.strike ) 
+        {
+
+            if( right != 'P' ) 
+            {
+                node.right = 'C';
+                out.push_back( node );
+            }
+
+            if( right != 'C' ) 
+            {
+                node.right = 'P';
+                out.push_back( node );
+            }
+
+        }
+
+    }
+
+    return out.size() - before;
+
+}
+
+//***************************************************************************************************
+
+void EOptionChain::contractFor(     const EOptionChainNode& node, 
+                                    Contract&               contract    ) const
+{
+
+    // short strings: assignments into a reused Contract do not allocate
+    contract.conId          = conId( node );
+    contract.symbol         = m_symbol;
+    contract.secType        = m_secType;
+    contract.exchange       = m_exchange;
+    contract.currency       = m_currency;
+    contract.tradingClass   = m_tradingClass;
+    contract.multiplier     = m_multiplier;
+    contract.strike         = m_strikes[ node.strike ];
+    contract.right          = node.right == 'C' ? "C" : "P";
+
+    char date[ 16 ];
+
+    snprintf( date, sizeof( date ), "%08d", m_expiries[ node.expiry ] );
+
+    contract.lastTradeDateOrContractMonth = date;
+
+}
+
+//***************************************************************************************************
+
+TickerId EOptionChain::subscribe(   EClient&                                client, 
+                                    const std::vector< EOptionChainNode >&  nodes, 
+                                    TickerId                                firstTickerId, 
+                                    const std::string&                      genericTicks    ) const
+{
+
+    Contract contract;
+
+    TickerId tickerId = firstTickerId;
+
+    for( size_t i = 0; i < nodes.size(); ++i ) 
+    {
+
+        contractFor( nodes[ i ], contract );
+
+        client.reqMktData( tickerId++, contract, genericTicks, false, false, TagValueListSPtr() );
+
+    }
+
+    return tickerId;
+
+}
+
+//***************************************************************************************************
+
+void EOptionChain::addTo(       EOptionSurface&                         surface, 
+                                const std::vector< EOptionChainNode >&  nodes, 
+                                TickerId                                firstTickerId, 
+                                int                                     closeSeconds    ) const
+{
+
+    for( size_t i = 0; i < nodes.size(); ++i ) 
+    {
+
+        const EOptionChainNode& node = nodes[ i ];
+
+        surface.addOption(  m_strikes[ node.strike ], 
+                            toTime( m_expiries[ node.expiry ], closeSeconds ), 
+                            node.right == 'C', 
+                            ( int )( firstTickerId + i )                        );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+int EOptionChain::parseDate(    const std::string&  text    )
+{
+
+    if( text.size() < 8 )
+        return 0;
+
+    int date = 0;
+
+    for( int i = 0; i < 8; ++i ) 
+    {
+
+        char c = text[ i ];
+
+        if( c < '0' || c > '9' )
+            return 0;
+
+        date = date * 10 + ( c - '0' );
+
+    }
+
+    return date;
+
+}
+
+//***************************************************************************************************
+
+time_t EOptionChain::toTime(    int     yyyymmdd, 
+                                int     secondsUtc  )
+{
+
+    // days since 1970-01-01 of a proleptic Gregorian date ( no timegm on every platform )
+    int y = yyyymmdd / 10000;
+    int m = yyyymmdd / 100 % 100;
+    int d = yyyymmdd % 100;
+
+    y -= m <= 2;
+
+    int  era    = ( y >= 0 ? y : y - 399 ) / 400;
+    int  yoe    = y - era * 400;
+    int  doy    = ( 153 * ( m + ( m > 2 ? -3 : 9 ) ) + 2 ) / 5 + d - 1;
+    int  doe    = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long days   = ( long )era * 146097 + doe - 719468;
+
+    return ( time_t )days * 86400 + secondsUtc;
+
+}
+
+
+//***************************************************************************************************
+
+void EOptionChainRegistry::setUnderlying(   int                 underlyingConId, 
+                                            const std::string&  symbol, 
+                                            const std::string&  currency, 
+                                            const std::string&  secType     )
+{
+
+    Underlying* entry = 0;
+
+    for( size_t i = 0; i < m_underlyings.size() && !entry; ++i ) 
+    {
+
+        if( m_underlyings[ i ].conId == underlyingConId )
+            entry = &m_underlyings[ i ];
+
+    }
+
+    if( !entry ) 
+    {
+        m_underlyings.push_back( Underlying() );
+        entry = &m_underlyings.back();
+        entry->conId = underlyingConId;
+    }
+
+    entry->symbol   = symbol;
+    entry->currency = currency;
+    entry->secType  = secType;
+
+    for( size_t i = 0; i < m_chains.size(); ++i ) 
+    {
+
+        if( m_chains[ i ].underlyingConId() == underlyingConId )
+            m_chains[ i ].setUnderlying( symbol, currency, secType );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+EOptionChain& EOptionChainRegistry::onParameter(    const std::string&              exchange, 
+                                                    int                             underlyingConId, 
+                                                    const std::string&              tradingClass, 
+                                                    const std::string&              multiplier, 
+                                                    const std::set< std::string >&  expirations, 
+                                                    const std::set< double >&       strikes         )
+{
+
+    EOptionChain* entry = chain( underlyingConId, exchange, tradingClass );
+
+    if( !entry ) 
+    {
+
+        m_chains.push_back( EOptionChain() );
+        entry = &m_chains.back();
+
+        for( size_t i = 0; i < m_underlyings.size(); ++i ) 
+        {
+
+            const Underlying& u = m_underlyings[ i ];
+
+            if( u.conId == underlyingConId )
+                entry->setUnderlying( u.symbol, u.currency, u.secType );
+
+        }
+
+        entry->assign( exchange, underlyingConId, tradingClass, multiplier, expirations, strikes );
+
+        // the other exchanges of this trading class already hold its conIds
+        for( size_t i = 0; i + 1 < m_chains.size(); ++i ) 
+        {
+
+            const EOptionChain& c = m_chains[ i ];
+
+            if( c.underlyingConId() == underlyingConId && c.tradingClass() == tradingClass ) 
+            {
+                entry->shareConIds( c );
+                break;
+            }
+
+        }
+
+        return *entry;
+
+    }
+
+    entry->assign( exchange, underlyingConId, tradingClass, multiplier, expirations, strikes );
+
+    return *entry;
+
+}
+
+//***************************************************************************************************
+
+bool EOptionChainRegistry::onContractDetails(   const ContractDetails&  details     )
+{
+
+    std::vector< const EOptionChain* > learnedBy;
+
+    for( size_t i = 0; i < m_chains.size(); ++i ) 
+    {
+
+        EOptionChain& c = m_chains[ i ];
+
+        if( details.underConId != 0 && details.underConId != c.underlyingConId() )
+            continue;
+
+        bool shared = false;
+
+        for( size_t j = 0; j < learnedBy.size() && !shared; ++j )
+            shared = c.sharesConIds( *learnedBy[ j ] );
+
+        // one listing that knows the option is enough: the others read the same table
+        if( !shared && c.learn( details.contract ) )
+            learnedBy.push_back( &c );
+
+    }
+
+    return !learnedBy.empty();
+
+}
+
+//***************************************************************************************************
+
+EOptionChain* EOptionChainRegistry::chain(  int                 underlyingConId, 
+                                            const std::string&  exchange, 
+                                            const std::string&  tradingClass    )
+{
+
+    for( size_t i = 0; i < m_chains.size(); ++i ) 
+    {
+
+        EOptionChain& c = m_chains[ i ];
+
+        if( c.underlyingConId() == underlyingConId && c.exchange() == exchange && c.tradingClass() == tradingClass )
+            return &c;
+
+    }
+
+    return 0;
+
+}
+
+//***************************************************************************************************
+
+void EOptionChainRegistry::clear()
+{
+
+    m_chains.clear();
+    m_underlyings.clear();
+
+}
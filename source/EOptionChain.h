@@ -0,0 +1,214 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EOPTIONCHAIN_H
+#define TWS_API_CLIENT_EOPTIONCHAIN_H
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <time.h>
+#include <vector>
+#include "platformspecific.h"
+#include "CommonDefs.h"
+
+
+class  EClient;
+class  EOptionSurface;
+struct Contract;
+struct ContractDetails;
+
+
+//******************************************************************************************
+// one option of a chain, by position: 12 bytes instead of a Contract
+
+struct EOptionChainNode 
+{
+
+    int                 expiry;         // index into expiries()
+    int                 strike;         // index into strikes()
+    char                right;          // 'C' or 'P'
+
+};
+
+//******************************************************************************************
+// the options of one underlying on one exchange and trading class, as delivered by
+// securityDefinitionOptionalParameter: strikes sorted ascending, expiries parsed to
+// yyyymmdd integers, conIds filled in as contractDetails come back ( learn ). The conIds
+// live in a sparse table shared by the chains of one underlying and trading class, so a
+// listing on several exchanges is learned and stored once.
+//
+// select() picks "n strikes each side of the money for the next k expiries" with two
+// binary searches; contractFor() / subscribe() turn the nodes into requests, rewriting
+// only the fields that differ from one option to the next in a reused Contract.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOptionChain
+{
+
+    int                             m_underlyingConId;
+    std::string                     m_exchange;
+    std::string                     m_tradingClass;
+    std::string                     m_multiplier;
+
+    std::string                     m_symbol;
+    std::string                     m_secType;
+    std::string                     m_currency;
+
+    std::vector< double >           m_strikes;
+    std::vector< int >              m_expiries;
+    struct ConIdKey 
+    {
+        int             expiry;                         // yyyymmdd
+        long long       strike;                         // 1e-4 units: immune to decimal conversion
+        char            right;
+
+        bool operator<( const ConIdKey& o ) const 
+        {
+            return expiry != o.expiry ? expiry < o.expiry : strike != o.strike ? strike < o.strike : right < o.right;
+        }
+    };
+
+    typedef std::map< ConIdKey, long >  ConIdTable;
+
+    std::shared_ptr< ConIdTable >   m_conIds;           // learned options only, shared across exchanges
+
+
+    ConIdKey            key                 (       const EOptionChainNode& node                    ) const;
+
+public:
+
+    EOptionChain();
+
+    void                assign              (       const std::string&              exchange, 
+                                                    int                             underlyingConId, 
+                                                    const std::string&              tradingClass, 
+                                                    const std::string&              multiplier, 
+                                                    const std::set< std::string >&  expirations, 
+                                                    const std::set< double >&       strikes         );
+
+    // what securityDefinitionOptionalParameter does not say ( secType FOP for futures )
+    void                setUnderlying       (       const std::string&  symbol, 
+                                                    const std::string&  currency    = "USD", 
+                                                    const std::string&  secType     = "OPT"         );
+
+    // records the conId of an option of this chain; false if it is not one
+    bool                learn               (       const Contract&     contract                    );
+
+    // use the conId table of another listing of the same underlying and trading class
+    void                shareConIds         (       const EOptionChain& other                       );
+    bool                sharesConIds        (       const EOptionChain& other                       ) const { return m_conIds == other.m_conIds; }
+
+    //********************************************************
+    // lookup
+    //********************************************************
+
+    int                 strikeIndex         (       double          strike                          ) const;    // -1: not listed
+    int                 expiryIndex         (       int             yyyymmdd                        ) const;    // -1: not listed
+    int                 atmIndex            (       double          underlying                      ) const;    // nearest strike
+    int                 firstExpiry         (       int             yyyymmdd                        ) const;    // first on or after
+
+    long                conId               (       const EOptionChainNode& node                    ) const;    // 0: not learned yet
+
+    // n strikes each side of the one nearest the underlying ( 2n + 1 ) for the k expiries
+    // from fromDate on, expiry major, calls before puts; right 0 for both. Appends to out
+    // and returns the count appended
+    size_t              select              (       double                          underlying, 
+                                                    int                             strikesEachSide, 
+                                                    int                             expiries, 
+                                                    int                             fromDate, 
+                                                    char                            right, 
+                                                    std::vector< EOptionChainNode >& out            ) const;
+
+    //********************************************************
+    // subscription
+    //********************************************************
+
+    void                contractFor         (       const EOptionChainNode& node, 
+                                                    Contract&               contract                ) const;
+
+    // one reqMktData per node, tickerIds firstTickerId on; returns the next free tickerId
+    TickerId            subscribe           (       EClient&                                client, 
+                                                    const std::vector< EOptionChainNode >&  nodes, 
+                                                    TickerId                                firstTickerId, 
+                                                    const std::string&                      genericTicks    = "" ) const;
+
+    // the same nodes ( and tickerIds ) as options of a surface; expiry at closeSeconds UTC
+    void                addTo               (       EOptionSurface&                         surface, 
+                                                    const std::vector< EOptionChainNode >&  nodes, 
+                                                    TickerId                                firstTickerId, 
+                                                    int                                     closeSeconds    = 20 * 3600 ) const;
+
+    //********************************************************
+
+    int                 underlyingConId     (                                                       ) const { return m_underlyingConId; }
+    const std::string&  exchange            (                                                       ) const { return m_exchange;        }
+    const std::string&  tradingClass        (                                                       ) const { return m_tradingClass;    }
+    const std::string&  multiplier          (                                                       ) const { return m_multiplier;      }
+
+    const std::vector< double >&    strikes (                                                       ) const { return m_strikes;         }
+    const std::vector< int >&       expiries(                                                       ) const { return m_expiries;        }
+
+    // of this trading class, whichever exchange chain learned them
+    size_t              knownConIds         (                                                       ) const { return m_conIds->size();  }
+
+    // "20240119" or "20240119 16:00 US/Eastern" -> 20240119, 0 if malformed
+    static int          parseDate           (       const std::string&  text                        );
+    static time_t       toTime              (       int                 yyyymmdd, 
+                                                    int                 secondsUtc                  );
+
+};
+
+//******************************************************************************************
+// every chain of every underlying requested with reqSecDefOptParams; forward the two
+// callbacks ( securityDefinitionOptionalParameter, contractDetails ) to it
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOptionChainRegistry
+{
+
+    struct Underlying 
+    {
+        int             conId;
+        std::string     symbol;
+        std::string     currency;
+        std::string     secType;
+    };
+
+    std::deque< EOptionChain >      m_chains;           // chains never move: references stay valid
+    std::vector< Underlying >       m_underlyings;
+
+public:
+
+    // applied to the chains of that underlying, present and future
+    void                setUnderlying       (       int                 underlyingConId, 
+                                                    const std::string&  symbol, 
+                                                    const std::string&  currency    = "USD", 
+                                                    const std::string&  secType     = "OPT"         );
+
+    EOptionChain&       onParameter         (       const std::string&              exchange, 
+                                                    int                             underlyingConId, 
+                                                    const std::string&              tradingClass, 
+                                                    const std::string&              multiplier, 
+                                                    const std::set< std::string >&  expirations, 
+                                                    const std::set< double >&       strikes         );
+
+    // an option conId serves every exchange it is listed on: learned once per shared table
+    bool                onContractDetails   (       const ContractDetails&          details         );
+
+    EOptionChain*       chain               (       int                 underlyingConId, 
+                                                    const std::string&  exchange, 
+                                                    const std::string&  tradingClass                );
+
+    size_t              size                (                                                       ) const { return m_chains.size();  }
+    EOptionChain&       at                  (       size_t              i                           )       { return m_chains[ i ];     }
+    void                clear               (                                                       );
+
+};
+
+//******************************************************************************************
+
+#endif
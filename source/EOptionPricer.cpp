@@ -0,0 +1,331 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EOptionPricer.h"
+
+#include <math.h>
+#include <vector>
+
+
+namespace {
+
+    const double    INV_SQRT_2      = 0.70710678118654752440;
+    const double    INV_SQRT_2PI    = 0.39894228040143267794;
+    const double    DAYS_PER_YEAR   = 365.0;
+
+    const double    VOL_MIN         = 1e-4;
+    const double    VOL_MAX         = 10.0;
+    const double    PRICE_TOLERANCE = 1e-10;
+
+    const size_t    CHUNK           = 256;
+
+    inline double normCdf( double x )   { return 0.5 * erfc( -x * INV_SQRT_2 ); }
+    inline double normPdf( double x )   { return INV_SQRT_2PI * exp( -0.5 * x * x ); }
+
+    //***************************************************************************************************
+    // everything derives from the forward F and the discount factor; for Black-Scholes the
+    // spot S relates as S e^( -qT ) = df F
+
+    struct Greeks 
+    {
+        double  price;
+        double  delta;
+        double  gamma;
+        double  vega;
+        double  theta;
+    };
+
+    inline void evaluate(   EOptionModel    model, 
+                            bool            isCall, 
+                            double          underlying, 
+                            double          strike, 
+                            double          time, 
+                            double          rate, 
+                            double          yield, 
+                            double          vol, 
+                            Greeks&         g           )
+    {
+
+        double df       = exp( -rate * time );
+        double carry    = model == OPTION_BLACK_SCHOLES ? exp( ( rate - yield ) * time ) : 1.0;
+        double forward  = underlying * carry;
+
+        if( time <= 0 || vol <= 0 || strike <= 0 || forward <= 0 ) 
+        {
+
+            // expired or deterministic: discounted intrinsic value
+            double intrinsic = isCall ? forward - strike : strike - forward;
+
+            g.price = intrinsic > 0 ? df * intrinsic : 0;
+            g.delta = intrinsic > 0 ? ( isCall ? 1 : -1 ) * df * carry : 0;
+            g.gamma = 0;
+            g.vega  = 0;
+            g.theta = 0;
+
+            return;
+
+        }
+
+        double sqrtT    = sqrt( time );
+        double sigmaT   = vol * sqrtT;
+        double d1       = ( log( forward / strike ) + 0.5 * sigmaT * sigmaT ) / sigmaT;
+        double d2       = d1 - sigmaT;
+        double pdf      = normPdf( d1 );
+        double sign     = isCall ? 1.0 : -1.0;
+        double nd1      = normCdf( sign * d1 );
+        double nd2      = normCdf( sign * d2 );
+
+        g.price = sign * df * ( forward * nd1 - strike * nd2 );
+
+        // derivatives with respect to the underlying given ( spot or forward )
+        g.delta = sign * df * carry * nd1;
+        g.gamma = df * carry * pdf / ( underlying * sigmaT );
+        g.vega  = df * forward * pdf * sqrtT / 100;
+
+        double decay = -df * forward * pdf * vol / ( 2 * sqrtT );
+
+        if( model == OPTION_BLACK_SCHOLES )
+            g.theta = decay - sign * rate * strike * df * nd2 + sign * yield * df * forward * nd1;
+        else
+            g.theta = decay + rate * g.price;
+
+        g.theta /= DAYS_PER_YEAR;
+
+    }
+
+    //***************************************************************************************************
+    // no arbitrage bounds of the price, for any volatility
+
+    inline void bounds(     EOptionModel    model, 
+                            bool            isCall, 
+                            double          underlying, 
+                            double          strike, 
+                            double          time, 
+                            double          rate, 
+                            double          yield, 
+                            double&         lower, 
+                            double&         upper       )
+    {
+
+        double df       = exp( -rate * time );
+        double forward  = underlying * ( model == OPTION_BLACK_SCHOLES ? exp( ( rate - yield ) * time ) : 1.0 );
+        double intrinsic= df * ( isCall ? forward - strike : strike - forward );
+
+        lower = intrinsic > 0 ? intrinsic : 0;
+        upper = df * ( isCall ? forward : strike );
+
+    }
+
+}
+
+
+//***************************************************************************************************
+
+double EOptionPricer::price(            EOptionModel    model, 
+                                        bool            isCall, 
+                                        double          underlying, 
+                                        double          strike, 
+                                        double          time, 
+                                        double          rate, 
+                                        double          yield, 
+                                        double          vol, 
+                                        double*         delta, 
+                                        double*         gamma, 
+                                        double*         vega, 
+                                        double*         theta           )
+{
+
+    Greeks g;
+
+    evaluate( model, isCall, underlying, strike, time, rate, yield, vol, g );
+
+    if( delta ) *delta = g.delta;
+    if( gamma ) *gamma = g.gamma;
+    if( vega  ) *vega  = g.vega;
+    if( theta ) *theta = g.theta;
+
+    return g.price;
+
+}
+
+//***************************************************************************************************
+
+double EOptionPricer::impliedVol(       EOptionModel    model, 
+                                        bool            isCall, 
+                                        double          underlying, 
+                                        double          strike, 
+                                        double          time, 
+                                        double          rate, 
+                                        double          yield, 
+                                        double          target          )
+{
+
+    unsigned char   call    = isCall ? 1 : 0;
+    double          vol     = 0;
+
+    impliedVolBatch( model, underlying, rate, yield, 1, &strike, &time, &call, &target, &vol );
+
+    return vol;
+
+}
+
+//***************************************************************************************************
+
+void EOptionPricer::priceBatch(         EOptionModel            model, 
+                                        double                  underlying, 
+                                        double                  rate, 
+                                        double                  yield, 
+                                        size_t                  n, 
+                                        const double*           strike, 
+                                        const double*           time, 
+                                        const double*           vol, 
+                                        const unsigned char*    isCall, 
+                                        double*                 price, 
+                                        double*                 delta, 
+                                        double*                 gamma, 
+                                        double*                 vega, 
+                                        double*                 theta           )
+{
+
+    for( size_t i = 0; i < n; ++i ) 
+    {
+
+        Greeks g;
+
+        evaluate( model, isCall[ i ] != 0, underlying, strike[ i ], time[ i ], rate, yield, vol[ i ], g );
+
+        if( price ) price[ i ] = g.price;
+        if( delta ) delta[ i ] = g.delta;
+        if( gamma ) gamma[ i ] = g.gamma;
+        if( vega  ) vega[ i ]  = g.vega;
+        if( theta ) theta[ i ] = g.theta;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+size_t EOptionPricer::impliedVolBatch(  EOptionModel            model, 
+                                        double                  underlying, 
+                                        double                  rate, 
+                                        double                  yield, 
+                                        size_t                  n, 
+                                        const double*           strike, 
+                                        const double*           time, 
+                                        const unsigned char*    isCall, 
+                                        const double*           target, 
+                                        double*                 vol             )
+{
+
+    size_t solved = 0;
+
+    // chunks keep the working set ( bracket, state ) in L1
+    double          lo[ CHUNK ];
+    double          hi[ CHUNK ];
+    unsigned char   active[ CHUNK ];
+
+    for( size_t begin = 0; begin < n; begin += CHUNK ) 
+    {
+
+        size_t count = n - begin < CHUNK ? n - begin : CHUNK;
+        size_t left  = 0;
+
+        for( size_t j = 0; j < count; ++j ) 
+        {
+
+            size_t i = begin + j;
+
+            double lower, upper;
+
+            bounds( model, isCall[ i ] != 0, underlying, strike[ i ], time[ i ], rate, yield, lower, upper );
+
+            lo[ j ]     = VOL_MIN;
+            hi[ j ]     = VOL_MAX;
+            active[ j ] = time[ i ] > 0 && target[ i ] > lower && target[ i ] < upper;
+
+            if( !active[ j ] ) 
+            {
+                vol[ i ] = NAN;
+                continue;
+            }
+
+            // a previous solution is the best guess; otherwise Brenner-Subrahmanyam
+            if( !( vol[ i ] > VOL_MIN && vol[ i ] < VOL_MAX ) ) 
+            {
+
+                double guess = sqrt( 2 * M_PI / time[ i ] ) * target[ i ] / underlying;
+
+                vol[ i ] = guess > 0.05 && guess < 3 ? guess : 0.3;
+
+            }
+
+            ++left;
+
+        }
+
+        for( int iteration = 0; iteration < MAX_IV_ITERATIONS && left > 0; ++iteration ) 
+        {
+
+            for( size_t j = 0; j < count; ++j ) 
+            {
+
+                if( !active[ j ] )
+                    continue;
+
+                size_t i = begin + j;
+
+                Greeks g;
+
+                evaluate( model, isCall[ i ] != 0, underlying, strike[ i ], time[ i ], rate, yield, vol[ i ], g );
+
+                double diff = g.price - target[ i ];
+
+                if( fabs( diff ) <= PRICE_TOLERANCE * ( 1 + target[ i ] ) ) 
+                {
+                    active[ j ] = 0;
+                    --left;
+                    ++solved;
+                    continue;
+                }
+
+                // price increases with volatility: shrink the bracket
+                if( diff > 0 )
+                    hi[ j ] = vol[ i ];
+                else
+                    lo[ j ] = vol[ i ];
+
+                double vega = g.vega * 100;
+                double next = vega > 1e-12 ? vol[ i ] - diff / vega : -1;
+
+                if( !( next > lo[ j ] && next < hi[ j ] ) )
+                    next = 0.5 * ( lo[ j ] + hi[ j ] );
+
+                vol[ i ] = next;
+
+                if( hi[ j ] - lo[ j ] < 1e-12 ) 
+                {
+                    active[ j ] = 0;
+                    --left;
+                    ++solved;
+                }
+
+            }
+
+        }
+
+        // not converged in MAX_IV_ITERATIONS
+        for( size_t j = 0; j < count; ++j ) 
+        {
+
+            if( active[ j ] )
+                vol[ begin + j ] = NAN;
+
+        }
+
+    }
+
+    return solved;
+
+}
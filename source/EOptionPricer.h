@@ -0,0 +1,101 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EOPTIONPRICER_H
+#define TWS_API_CLIENT_EOPTIONPRICER_H
+
+#include <stddef.h>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+
+enum EOptionModel 
+{
+
+    OPTION_BLACK_SCHOLES,       // underlying is the spot, with a continuous dividend yield
+    OPTION_BLACK_76             // underlying is the forward ( futures options ), yield ignored
+
+};
+
+//******************************************************************************************
+// European option prices, greeks and implied volatilities computed in process, instead
+// of a calculateOptionPrice / calculateImpliedVolatility round trip per contract.
+//
+// The batch functions take one underlying and arrays ( structure of arrays ) of strikes,
+// times and volatilities: a whole chain per call, sharing the underlying dependent terms
+// and walking contiguous arrays instead of chasing a Contract and a request per option.
+// Implied volatilities are solved for all elements in lockstep: Newton steps, falling
+// back to bisection inside a bracket whenever Newton leaves it or vega vanishes.
+//
+// Units: time in years, rates and volatilities annualized ( 0.25 = 25% ); vega per
+// volatility point ( 0.01 ), theta per calendar day.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOptionPricer
+{
+
+public:
+
+    static const int    MAX_IV_ITERATIONS   = 64;
+
+    // one option; any greek pointer may be 0
+    static double       price               (       EOptionModel    model, 
+                                                    bool            isCall, 
+                                                    double          underlying, 
+                                                    double          strike, 
+                                                    double          time, 
+                                                    double          rate, 
+                                                    double          yield, 
+                                                    double          vol, 
+                                                    double*         delta   = 0, 
+                                                    double*         gamma   = 0, 
+                                                    double*         vega    = 0, 
+                                                    double*         theta   = 0             );
+
+    // NaN when no volatility reproduces the price ( below intrinsic, above the bound )
+    static double       impliedVol          (       EOptionModel    model, 
+                                                    bool            isCall, 
+                                                    double          underlying, 
+                                                    double          strike, 
+                                                    double          time, 
+                                                    double          rate, 
+                                                    double          yield, 
+                                                    double          target                  );
+
+    // n options on one underlying; output arrays may be 0
+    static void         priceBatch          (       EOptionModel            model, 
+                                                    double                  underlying, 
+                                                    double                  rate, 
+                                                    double                  yield, 
+                                                    size_t                  n, 
+                                                    const double*           strike, 
+                                                    const double*           time, 
+                                                    const double*           vol, 
+                                                    const unsigned char*    isCall, 
+                                                    double*                 price, 
+                                                    double*                 delta   = 0, 
+                                                    double*                 gamma   = 0, 
+                                                    double*                 vega    = 0, 
+                                                    double*                 theta   = 0     );
+
+    // vol: starting guesses in ( 0 or NaN for none ), implied volatilities out. Returns
+    // how many were solved
+    static size_t       impliedVolBatch     (       EOptionModel            model, 
+                                                    double                  underlying, 
+                                                    double                  rate, 
+                                                    double                  yield, 
+                                                    size_t                  n, 
+                                                    const double*           strike, 
+                                                    const double*           time, 
+                                                    const unsigned char*    isCall, 
+                                                    const double*           target, 
+                                                    double*                 vol             );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,184 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EOptionSurface.h"
+#include "EQuoteTable.h"
+
+#include <math.h>
+
+
+namespace {
+
+    const double SECONDS_PER_YEAR = 365.0 * 24 * 60 * 60;
+
+}
+
+
+//***************************************************************************************************
+
+EOptionSurface::EOptionSurface(     EOptionModel    model, 
+                                    double          rate, 
+                                    double          yield       )
+
+    : m_model       ( model )
+    , m_rate        ( rate )
+    , m_yield       ( yield )
+    , m_underlying  ( 0 )
+    , m_priced      ( 0 )
+
+{
+}
+
+//***************************************************************************************************
+
+int EOptionSurface::addOption(      double          strike, 
+                                    time_t          expiry, 
+                                    bool            isCall, 
+                                    int             tickerId, 
+                                    double          vol         )
+{
+
+    m_strike.push_back( strike );
+    m_expiry.push_back( expiry );
+    m_isCall.push_back( isCall ? 1 : 0 );
+    m_tickerId.push_back( tickerId );
+    m_modelVol.push_back( vol );
+    m_mid.push_back( NAN );
+
+    m_time.push_back( 0 );
+    m_iv.push_back( NAN );
+    m_vol.push_back( vol );
+    m_price.push_back( 0 );
+    m_delta.push_back( 0 );
+    m_gamma.push_back( 0 );
+    m_vega.push_back( 0 );
+    m_theta.push_back( 0 );
+
+    // forces the next refresh
+    m_priced = NAN;
+
+    return (int)m_strike.size() - 1;
+
+}
+
+//***************************************************************************************************
+
+void EOptionSurface::clear()
+{
+
+    m_strike.clear();
+    m_expiry.clear();
+    m_isCall.clear();
+    m_tickerId.clear();
+    m_modelVol.clear();
+    m_mid.clear();
+
+    m_time.clear();
+    m_iv.clear();
+    m_vol.clear();
+    m_price.clear();
+    m_delta.clear();
+    m_gamma.clear();
+    m_vega.clear();
+    m_theta.clear();
+
+    m_priced = NAN;
+
+}
+
+//***************************************************************************************************
+
+void EOptionSurface::setRates(      double          rate, 
+                                    double          yield       )
+{
+
+    m_rate      = rate;
+    m_yield     = yield;
+    m_priced    = NAN;
+
+}
+
+//***************************************************************************************************
+
+void EOptionSurface::setVolatility( int             index, 
+                                    double          vol         )
+{
+
+    if( index >= 0 && index < size() )
+        m_modelVol[ index ] = vol;
+
+}
+
+//***************************************************************************************************
+
+void EOptionSurface::setQuote(      int             index, 
+                                    double          bid, 
+                                    double          ask         )
+{
+
+    if( index < 0 || index >= size() )
+        return;
+
+    // a one sided or crossed market says nothing about the volatility
+    m_mid[ index ] = bid > 0 && ask >= bid ? 0.5 * ( bid + ask ) : NAN;
+
+}
+
+//***************************************************************************************************
+
+bool EOptionSurface::pull(          const EQuoteTable&  table, 
+                                    int                 underlyingTickerId  )
+{
+
+    EQuote quote;
+
+    if( table.snapshot( underlyingTickerId, quote ) ) 
+    {
+
+        if( quote.bid > 0 && quote.ask >= quote.bid )
+            m_underlying = 0.5 * ( quote.bid + quote.ask );
+        else if( quote.last > 0 )
+            m_underlying = quote.last;
+
+    }
+
+    for( int i = 0; i < size(); ++i ) 
+    {
+
+        if( m_tickerId[ i ] >= 0 && table.snapshot( m_tickerId[ i ], quote ) )
+            setQuote( i, quote.bid, quote.ask );
+
+    }
+
+    return moved();
+
+}
+
+//***************************************************************************************************
+
+void EOptionSurface::refresh(       time_t          now         )
+{
+
+    size_t n = m_strike.size();
+
+    m_priced = m_underlying;
+
+    if( n == 0 || !( m_underlying > 0 ) )
+        return;
+
+    for( size_t i = 0; i < n; ++i )
+        m_time[ i ] = difftime( m_expiry[ i ], now ) / SECONDS_PER_YEAR;
+
+    // options without a quote come back NaN and keep no seed
+    EOptionPricer::impliedVolBatch( m_model, m_underlying, m_rate, m_yield, n, 
+                                    &m_strike[ 0 ], &m_time[ 0 ], &m_isCall[ 0 ], &m_mid[ 0 ], &m_iv[ 0 ] );
+
+    for( size_t i = 0; i < n; ++i )
+        m_vol[ i ] = isnan( m_iv[ i ] ) ? m_modelVol[ i ] : m_iv[ i ];
+
+    EOptionPricer::priceBatch(  m_model, m_underlying, m_rate, m_yield, n, 
+                                &m_strike[ 0 ], &m_time[ 0 ], &m_vol[ 0 ], &m_isCall[ 0 ], 
+                                &m_price[ 0 ], &m_delta[ 0 ], &m_gamma[ 0 ], &m_vega[ 0 ], &m_theta[ 0 ] );
+
+}
@@ -0,0 +1,110 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EOPTIONSURFACE_H
+#define TWS_API_CLIENT_EOPTIONSURFACE_H
+
+#include <time.h>
+#include <vector>
+#include "EOptionPricer.h"
+#include "platformspecific.h"
+
+class EQuoteTable;
+
+
+
+//******************************************************************************************
+// the options of one underlying as parallel arrays, repriced as a batch whenever the
+// underlying moves: implied volatilities from the option quotes ( seeded with the previous
+// solution, so a refresh usually takes a couple of Newton steps ), then prices and greeks.
+// Options without a usable quote are priced with the volatility set for them.
+//
+// Quotes come either from setUnderlying / setQuote ( tickPrice ) or from an EQuoteTable
+// the decoder fills, for the underlying and every option given a tickerId.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOptionSurface
+{
+
+    EOptionModel                    m_model;
+    double                          m_rate;
+    double                          m_yield;
+    double                          m_underlying;
+    double                          m_priced;           // underlying of the last refresh
+
+    std::vector< double >           m_strike;
+    std::vector< time_t >           m_expiry;
+    std::vector< unsigned char >    m_isCall;
+    std::vector< int >              m_tickerId;
+    std::vector< double >           m_modelVol;
+    std::vector< double >           m_mid;              // NaN: no quote
+
+    std::vector< double >           m_time;
+    std::vector< double >           m_iv;               // NaN: not solved
+    std::vector< double >           m_vol;              // used for pricing
+    std::vector< double >           m_price;
+    std::vector< double >           m_delta;
+    std::vector< double >           m_gamma;
+    std::vector< double >           m_vega;
+    std::vector< double >           m_theta;
+
+public:
+
+    explicit EOptionSurface(                        EOptionModel    model   = OPTION_BLACK_SCHOLES, 
+                                                    double          rate    = 0, 
+                                                    double          yield   = 0                     );
+
+    // expiry: time the option stops trading; returns the index of the option
+    int                 addOption           (       double          strike, 
+                                                    time_t          expiry, 
+                                                    bool            isCall, 
+                                                    int             tickerId    = -1, 
+                                                    double          vol         = 0.3               );
+    void                clear               (                                                       );
+
+    void                setRates            (       double          rate, 
+                                                    double          yield                           );
+    void                setVolatility       (       int             index, 
+                                                    double          vol                             );
+
+    void                setUnderlying       (       double          price                           ) { m_underlying = price;   }
+    void                setQuote            (       int             index, 
+                                                    double          bid, 
+                                                    double          ask                             );
+
+    // reads the underlying ( mid, else last ) and the options that have a tickerId; true
+    // if the underlying moved since the last refresh
+    bool                pull                (       const EQuoteTable&  table, 
+                                                    int                 underlyingTickerId          );
+
+    // solves the implied volatilities, then prices and greeks of every option
+    void                refresh             (       time_t          now                             );
+
+    bool                moved               (                                                       ) const { return m_underlying != m_priced; }
+
+    int                 size                (                                                       ) const { return (int)m_strike.size(); }
+    double              underlying          (                                                       ) const { return m_underlying;  }
+
+    const double*       strikes             (                                                       ) const { return data( m_strike );  }
+    const double*       times               (                                                       ) const { return data( m_time );    }
+    const double*       impliedVols         (                                                       ) const { return data( m_iv );      }
+    const double*       prices              (                                                       ) const { return data( m_price );   }
+    const double*       deltas              (                                                       ) const { return data( m_delta );   }
+    const double*       gammas              (                                                       ) const { return data( m_gamma );   }
+    const double*       vegas               (                                                       ) const { return data( m_vega );    }
+    const double*       thetas              (                                                       ) const { return data( m_theta );   }
+
+    bool                isCall              (       int             index                           ) const { return m_isCall[ index ] != 0;   }
+    time_t              expiry              (       int             index                           ) const { return m_expiry[ index ];        }
+    int                 tickerId            (       int             index                           ) const { return m_tickerId[ index ];      }
+
+private:
+
+    static const double* data               (       const std::vector< double >&    v               )       { return v.empty() ? 0 : &v[ 0 ]; }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,174 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EOrderBook.h"
+
+#include <string.h>
+
+
+//***************************************************************************************************
+
+EOrderBook::EOrderBook( int maxDepth )
+
+    : m_levels      (   2 * ( maxDepth > 0 ? maxDepth : 1 )     )
+    , m_maxDepth    (   maxDepth > 0 ? maxDepth : 1             )
+    , m_updates     (   0                                       )
+    , m_rejected    (   0                                       )
+{
+
+    m_count[ SIDE_ASK ] = 0;
+    m_count[ SIDE_BID ] = 0;
+
+}
+
+//***************************************************************************************************
+
+bool EOrderBook::apply(         int             position, 
+                                int             operation, 
+                                int             side, 
+                                double          price, 
+                                int             size            )
+{
+
+    ++m_updates;
+
+    if( ( side != SIDE_ASK && side != SIDE_BID ) || position < 0 ) 
+    {
+        ++m_rejected;
+        return false;
+    }
+
+    EBookLevel* rows    = &m_levels[ side * m_maxDepth ];
+    int&        count   = m_count[ side ];
+
+    switch( operation ) 
+    {
+
+        case OP_INSERT: 
+        {
+
+            if( position > count || position >= m_maxDepth )
+                break;
+
+            // a full side drops its worst row
+            int moved = ( count < m_maxDepth ? count : m_maxDepth - 1 ) - position;
+
+            if( moved > 0 )
+                memmove( rows + position + 1, rows + position, moved * sizeof( EBookLevel ) );
+
+            rows[ position ].price  = price;
+            rows[ position ].size   = size;
+
+            if( count < m_maxDepth )
+                ++count;
+
+            return true;
+
+        }
+
+        case OP_UPDATE:
+
+            if( position >= count )
+                break;
+
+            rows[ position ].price  = price;
+            rows[ position ].size   = size;
+
+            return true;
+
+        case OP_DELETE:
+
+            if( position >= count )
+                break;
+
+            --count;
+
+            if( count > position )
+                memmove( rows + position, rows + position + 1, ( count - position ) * sizeof( EBookLevel ) );
+
+            return true;
+
+        default:
+            break;
+
+    }
+
+    ++m_rejected;
+
+    return false;
+
+}
+
+//***************************************************************************************************
+
+void EOrderBook::clear()
+{
+
+    m_count[ SIDE_ASK ] = 0;
+    m_count[ SIDE_BID ] = 0;
+
+}
+
+//***************************************************************************************************
+
+double EOrderBook::mid() const
+{
+
+    return hasTop() ? 0.5 * ( bestBid() + bestAsk() ) : 0;
+
+}
+
+//***************************************************************************************************
+
+double EOrderBook::spread() const
+{
+
+    return hasTop() ? bestAsk() - bestBid() : 0;
+
+}
+
+//***************************************************************************************************
+
+double EOrderBook::imbalance( int rows ) const
+{
+
+    const EBookLevel* asks = levels( SIDE_ASK );
+    const EBookLevel* bids = levels( SIDE_BID );
+
+    int askRows = rows < m_count[ SIDE_ASK ] ? rows : m_count[ SIDE_ASK ];
+    int bidRows = rows < m_count[ SIDE_BID ] ? rows : m_count[ SIDE_BID ];
+
+    double askSize = 0;
+    double bidSize = 0;
+
+    for( int i = 0; i < askRows; ++i )
+        askSize += asks[ i ].size;
+
+    for( int i = 0; i < bidRows; ++i )
+        bidSize += bids[ i ].size;
+
+    double total = askSize + bidSize;
+
+    return total > 0 ? ( bidSize - askSize ) / total : 0;
+
+}
+
+//***************************************************************************************************
+
+int EOrderBook::snapshot(       int             side, 
+                                EBookLevel*     out, 
+                                int             maxLevels       ) const
+{
+
+    if( side != SIDE_ASK && side != SIDE_BID )
+        return 0;
+
+    int rows = maxLevels < m_count[ side ] ? maxLevels : m_count[ side ];
+
+    if( rows > 0 )
+        memcpy( out, levels( side ), rows * sizeof( EBookLevel ) );
+
+    return rows > 0 ? rows : 0;
+
+}
@@ -0,0 +1,100 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EORDERBOOK_H
+#define TWS_API_CLIENT_EORDERBOOK_H
+
+#include <vector>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+
+struct EBookLevel 
+{
+
+    double              price;
+    int                 size;
+
+};
+
+//******************************************************************************************
+// limit order book of one reqMktDepth subscription, maintained from updateMktDepth /
+// updateMktDepthL2 exactly as TWS describes it: rows addressed by position, per side.
+//
+// Each side is a flat array preallocated for maxDepth rows, best price first. An insert
+// or delete moves the rows below it ( a few dozen bytes, TWS books are shallow ), so the
+// top of book is always row 0 and reading it costs nothing.
+//
+// An operation that does not fit the book ( update or delete of a missing row, position
+// past the end ) is rejected and counted: the book is out of sync and should be rebuilt
+// by cancelling and re-requesting the depth.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOrderBook
+{
+
+    std::vector< EBookLevel >   m_levels;           // [ ask rows ][ bid rows ], maxDepth each
+    int                         m_maxDepth;
+    int                         m_count[ 2 ];
+    unsigned long long          m_updates;
+    unsigned long long          m_rejected;
+
+public:
+
+    // side values used by updateMktDepth
+    static const int    SIDE_ASK            = 0;
+    static const int    SIDE_BID            = 1;
+
+    // operation values used by updateMktDepth
+    static const int    OP_INSERT           = 0;
+    static const int    OP_UPDATE           = 1;
+    static const int    OP_DELETE           = 2;
+
+    static const int    DEFAULT_MAX_DEPTH   = 64;
+
+    explicit EOrderBook(                            int             maxDepth    = DEFAULT_MAX_DEPTH );
+
+    // applies one updateMktDepth; false if rejected
+    bool                apply               (       int             position, 
+                                                    int             operation, 
+                                                    int             side, 
+                                                    double          price, 
+                                                    int             size                            );
+
+    void                clear               (                                                       );
+
+    // top of book; 0 when the side is empty
+    double              bestBid             (                                                       ) const { return m_count[ SIDE_BID ] ? m_levels[ m_maxDepth ].price : 0;    }
+    double              bestAsk             (                                                       ) const { return m_count[ SIDE_ASK ] ? m_levels[ 0 ].price : 0;             }
+    int                 bestBidSize         (                                                       ) const { return m_count[ SIDE_BID ] ? m_levels[ m_maxDepth ].size : 0;     }
+    int                 bestAskSize         (                                                       ) const { return m_count[ SIDE_ASK ] ? m_levels[ 0 ].size : 0;              }
+
+    bool                hasTop              (                                                       ) const { return m_count[ SIDE_BID ] && m_count[ SIDE_ASK ];                }
+    double              mid                 (                                                       ) const;
+    double              spread              (                                                       ) const;
+
+    // ( bid size - ask size ) / ( bid size + ask size ) over the first 'rows' rows of each
+    // side, in [ -1, 1 ], 0 when both are empty
+    double              imbalance           (       int             rows        = 1                 ) const;
+
+    // rows of a side, best first
+    int                 depth               (       int             side                            ) const { return m_count[ side ];                          }
+    const EBookLevel*   levels              (       int             side                            ) const { return &m_levels[ side * m_maxDepth ];           }
+
+    // copies at most maxLevels rows of a side, returns how many
+    int                 snapshot            (       int             side, 
+                                                    EBookLevel*     out, 
+                                                    int             maxLevels                       ) const;
+
+    int                 maxDepth            (                                                       ) const { return m_maxDepth;    }
+    unsigned long long  updates             (                                                       ) const { return m_updates;     }
+    unsigned long long  rejected            (                                                       ) const { return m_rejected;    }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,246 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EOrderTemplate.h"
+#include "EDecoder.h"
+#include "Order.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+
+
+//***************************************************************************************************
+
+EOrderTemplate::EOrderTemplate()
+{
+
+    reset();
+
+}
+
+//***************************************************************************************************
+
+void EOrderTemplate::reset()
+{
+
+    m_frame.clear();
+
+    for( int i = 0; i < FIELD_COUNT; ++i ) 
+    {
+
+        m_begin[ i ] = std::string::npos;
+        m_end  [ i ] = std::string::npos;
+
+    }
+
+    m_serverVersion     = 0;
+    m_fractionalQty     = false;
+    m_lmtUnsetAsEmpty   = false;
+    m_auxUnsetAsEmpty   = false;
+
+}
+
+//***************************************************************************************************
+
+bool EOrderTemplate::valid() const
+{
+
+    if( m_frame.empty() || m_serverVersion <= 0 )
+        return false;
+
+    // fields must have been seen in frame order
+    size_t prev = 0;
+
+    for( int i = 0; i < FIELD_COUNT; ++i ) 
+    {
+
+        if( m_begin[ i ] == std::string::npos || m_end[ i ] == std::string::npos )
+            return false;
+
+        if( m_begin[ i ] < prev || m_end[ i ] < m_begin[ i ] || m_end[ i ] >= m_frame.size() )
+            return false;
+
+        prev = m_end[ i ];
+
+    }
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+bool EOrderTemplate::isSupportedOrderType( const std::string& orderType )
+{
+
+    return orderType == "LMT" || orderType == "MKT" || orderType == "STP";
+
+}
+
+//***************************************************************************************************
+
+void EOrderTemplate::markBegin(         Field               field, 
+                                        std::streamoff      pos             )
+{
+
+    m_begin[ field ] = static_cast< size_t >( pos );
+
+}
+
+//***************************************************************************************************
+
+void EOrderTemplate::markEnd(           Field               field, 
+                                        std::streamoff      pos             )
+{
+
+    // pos is past the field separator
+    m_end[ field ] = static_cast< size_t >( pos ) - 1;
+
+}
+
+//***************************************************************************************************
+
+void EOrderTemplate::capture(           const std::string&  frame, 
+                                        int                 serverVersion   )
+{
+
+    m_frame             = frame;
+    m_serverVersion     = serverVersion;
+
+    // mirror the version checks EClient::encodePlaceOrder applies to these fields
+    m_fractionalQty     = serverVersion >= MIN_SERVER_VER_FRACTIONAL_POSITIONS;
+    m_lmtUnsetAsEmpty   = serverVersion >= MIN_SERVER_VER_ORDER_COMBO_LEGS_PRICE;
+    m_auxUnsetAsEmpty   = serverVersion >= MIN_SERVER_VER_TRAILING_PERCENT;
+
+}
+
+//***************************************************************************************************
+
+size_t EOrderTemplate::formatPrice(     char*               buf, 
+                                        size_t              sz, 
+                                        double              price, 
+                                        bool                unsetAsEmpty    )
+{
+
+    if( price == UNSET_DOUBLE ) 
+    {
+
+        if( unsetAsEmpty ) 
+        {
+
+            buf[ 0 ] = 0;
+            
+            return 0;
+
+        }
+
+        price = 0;
+
+    }
+
+    // same formatting as EClient::EncodeField<double>
+    int n = snprintf(           buf, 
+                                sz, 
+                                "%.10g", 
+                                price                   );
+
+    return n > 0 ? static_cast< size_t >( n ) : 0;
+
+}
+
+//***************************************************************************************************
+
+void EOrderTemplate::render(            std::string&        out, 
+                                        OrderId             id, 
+                                        const std::string&  action, 
+                                        double              totalQuantity, 
+                                        const std::string&  orderType, 
+                                        double              lmtPrice, 
+                                        double              auxPrice        ) const
+{
+
+    assert( valid() );
+
+    char    values  [ FIELD_COUNT ][ 64 ];
+    size_t  lengths [ FIELD_COUNT ];
+
+    const char* strValues[ FIELD_COUNT ] = { 0 };
+
+    lengths[ FIELD_ORDER_ID ] = snprintf(       values[ FIELD_ORDER_ID ], 
+                                                sizeof( values[ 0 ] ), 
+                                                "%ld", 
+                                                id                                  );
+
+    strValues[ FIELD_ACTION ]       = action.c_str();
+    lengths  [ FIELD_ACTION ]       = action.size();
+
+    if( m_fractionalQty ) 
+    {
+
+        lengths[ FIELD_TOTAL_QUANTITY ] = snprintf(     values[ FIELD_TOTAL_QUANTITY ], 
+                                                        sizeof( values[ 0 ] ), 
+                                                        "%.10g", 
+                                                        totalQuantity               );
+
+    }
+    else 
+    {
+
+        lengths[ FIELD_TOTAL_QUANTITY ] = snprintf(     values[ FIELD_TOTAL_QUANTITY ], 
+                                                        sizeof( values[ 0 ] ), 
+                                                        "%ld", 
+                                                        (long)totalQuantity         );
+
+    }
+
+    strValues[ FIELD_ORDER_TYPE ]   = orderType.c_str();
+    lengths  [ FIELD_ORDER_TYPE ]   = orderType.size();
+
+    lengths[ FIELD_LMT_PRICE ] = formatPrice(   values[ FIELD_LMT_PRICE ], 
+                                                sizeof( values[ 0 ] ), 
+                                                lmtPrice, 
+                                                m_lmtUnsetAsEmpty                   );
+
+    lengths[ FIELD_AUX_PRICE ] = formatPrice(   values[ FIELD_AUX_PRICE ], 
+                                                sizeof( values[ 0 ] ), 
+                                                auxPrice, 
+                                                m_auxUnsetAsEmpty                   );
+
+    //************************************************************
+    // stitch: template bytes between fields + the new values
+    //************************************************************
+
+    size_t total = m_frame.size();
+
+    for( int i = 0; i < FIELD_COUNT; ++i )
+        total += lengths[ i ] - ( m_end[ i ] - m_begin[ i ] );
+
+    out.clear();
+    out.reserve( total );
+
+    size_t pos = 0;
+
+    for( int i = 0; i < FIELD_COUNT; ++i ) 
+    {
+
+        out.append(         m_frame, 
+                            pos, 
+                            m_begin[ i ] - pos                                  );
+
+        out.append(         strValues[ i ] ? strValues[ i ] : values[ i ], 
+                            lengths[ i ]                                        );
+
+        pos = m_end[ i ];
+
+    }
+
+    out.append(             m_frame, 
+                            pos, 
+                            std::string::npos                                   );
+
+}
+
+//***************************************************************************************************
@@ -0,0 +1,97 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EORDERTEMPLATE_H
+#define TWS_API_CLIENT_EORDERTEMPLATE_H
+
+#include <string>
+#include "platformspecific.h"
+#include "CommonDefs.h"
+
+
+
+//******************************************************************************************
+// a PLACE_ORDER frame encoded once by EClient::prepareOrderTemplate for the negotiated
+// server version, with the byte range of every per-order field remembered.
+// EClient::placeOrderFast only re-renders those fields and copies the rest verbatim,
+// skipping the walk over all Order members and server version checks.
+//
+// Only LMT, MKT and STP are accepted: for those the order type changes no other field
+// of the frame, so one template serves all three and order modifications
+// ( same orderId, new price / quantity ) as well.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EOrderTemplate
+{
+
+public:
+
+    enum Field 
+    {
+
+        FIELD_ORDER_ID,
+        FIELD_ACTION,
+        FIELD_TOTAL_QUANTITY,
+        FIELD_ORDER_TYPE,
+        FIELD_LMT_PRICE,
+        FIELD_AUX_PRICE,
+
+        FIELD_COUNT
+
+    };
+
+    EOrderTemplate();
+
+    bool                valid                   (                                               ) const;
+    int                 serverVersion           (                                               ) const { return m_serverVersion; }
+    size_t              frameSize               (                                               ) const { return m_frame.size();  }
+    void                reset                   (                                               );
+
+    // writes the complete frame for these values into out ( reusing its capacity )
+    void                render                  (       std::string&        out, 
+                                                        OrderId             id, 
+                                                        const std::string&  action, 
+                                                        double              totalQuantity, 
+                                                        const std::string&  orderType, 
+                                                        double              lmtPrice, 
+                                                        double              auxPrice        ) const;
+
+    static bool         isSupportedOrderType    (       const std::string&  orderType       );
+
+private:
+
+    friend class EClient;
+
+    void                markBegin               (       Field               field, 
+                                                        std::streamoff      pos             );
+
+    void                markEnd                 (       Field               field, 
+                                                        std::streamoff      pos             );
+
+    void                capture                 (       const std::string&  frame, 
+                                                        int                 serverVersion   );
+
+    static size_t       formatPrice             (       char*               buf, 
+                                                        size_t              sz, 
+                                                        double              price, 
+                                                        bool                unsetAsEmpty    );
+
+private:
+
+    std::string         m_frame;
+
+    size_t              m_begin[ FIELD_COUNT ];     // first byte of the field value
+    size_t              m_end  [ FIELD_COUNT ];     // one past the value ( the '\0' separator )
+
+    int                 m_serverVersion;
+
+    bool                m_fractionalQty;            // quantity as double, else as long
+    bool                m_lmtUnsetAsEmpty;          // EncodeFieldMax rule for lmtPrice, else UNSET -> 0
+    bool                m_auxUnsetAsEmpty;          // same for auxPrice
+
+};
+
+//******************************************************************************************
+
+#endif
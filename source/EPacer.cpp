@@ -0,0 +1,337 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EPacer.h"
+#include "EClient.h"
+
+#include <string.h>
+#include <algorithm>
+
+
+using namespace ibapi::client_constants;
+
+
+//***************************************************************************************************
+
+EPacer::EPacer()
+
+    : m_rate        (   0                   )
+    , m_burst       (   DEFAULT_BURST       )
+    , m_tokens      (   DEFAULT_BURST       )
+    , m_lastRefill  (   Clock::now()        )
+    , m_depth       (   0                   )
+{
+
+    resetStats();
+
+}
+
+//***************************************************************************************************
+
+void EPacer::configure(         double      rate, 
+                                double      burst           )
+{
+
+    m_rate          = rate;
+    m_burst         = ( std::max )( burst, 1.0 );
+    m_tokens        = m_burst;
+    m_lastRefill    = Clock::now();
+
+}
+
+//***************************************************************************************************
+
+bool EPacer::enabled() const
+{
+
+    return m_rate > 0;
+
+}
+
+//***************************************************************************************************
+
+void EPacer::refill()
+{
+
+    Clock::time_point now = Clock::now();
+
+    double elapsed = std::chrono::duration< double >( now - m_lastRefill ).count();
+
+    m_lastRefill = now;
+
+    m_tokens = ( std::min )(        m_burst, 
+                                    m_tokens + elapsed * m_rate         );
+
+}
+
+//***************************************************************************************************
+
+bool EPacer::admit( EPaceLane lane )
+{
+
+    if( !enabled() )
+        return true;
+
+    // frames already waiting in this or a more urgent lane go first
+    for( int i = 0; i <= lane; ++i ) 
+    {
+
+        if( !m_lanes[ i ].empty() )
+            return false;
+
+    }
+
+    refill();
+
+    if( m_tokens < 1.0 )
+        return false;
+
+    m_tokens -= 1.0;
+
+    ++m_stats[ lane ].sent;
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EPacer::push(          EPaceLane       lane, 
+                            std::string&    frame           )
+{
+
+    m_lanes[ lane ].push_back( QueuedFrame() );
+
+    QueuedFrame& queued = m_lanes[ lane ].back();
+
+    queued.frame.swap( frame );
+    queued.queuedAt = Clock::now();
+
+    ++m_stats[ lane ].depth;
+    ++m_depth;
+
+}
+
+//***************************************************************************************************
+
+bool EPacer::release( std::string& frame )
+{
+
+    if( m_depth == 0 )
+        return false;
+
+    refill();
+
+    if( enabled() && m_tokens < 1.0 )
+        return false;
+
+    for( int i = 0; i < PACE_LANE_COUNT; ++i ) 
+    {
+
+        if( m_lanes[ i ].empty() )
+            continue;
+
+        QueuedFrame& queued = m_lanes[ i ].front();
+
+        double waitMs = std::chrono::duration< double, std::milli >( Clock::now() - queued.queuedAt ).count();
+
+        frame.swap( queued.frame );
+
+        m_lanes[ i ].pop_front();
+
+        EPaceLaneStats& stats = m_stats[ i ];
+
+        --stats.depth;
+        ++stats.sent;
+        ++stats.delayed;
+
+        stats.totalWaitMs  += waitMs;
+        stats.maxWaitMs     = ( std::max )( stats.maxWaitMs, waitMs );
+
+        --m_depth;
+
+        if( enabled() )
+            m_tokens -= 1.0;
+
+        return true;
+
+    }
+
+    return false;
+
+}
+
+//***************************************************************************************************
+
+void EPacer::charge( EPaceLane lane )
+{
+
+    if( !enabled() )
+        return;
+
+    refill();
+
+    m_tokens -= 1.0;
+
+    ++m_stats[ lane ].sent;
+
+}
+
+//***************************************************************************************************
+
+void EPacer::clear()
+{
+
+    for( int i = 0; i < PACE_LANE_COUNT; ++i ) 
+    {
+
+        m_lanes[ i ].clear();
+        
+        m_stats[ i ].depth = 0;
+    
+    }
+
+    m_depth = 0;
+
+}
+
+//***************************************************************************************************
+
+size_t EPacer::queueDepth() const
+{
+
+    return m_depth;
+
+}
+
+//***************************************************************************************************
+
+size_t EPacer::queueDepth( EPaceLane lane ) const
+{
+
+    return m_lanes[ lane ].size();
+
+}
+
+//***************************************************************************************************
+
+double EPacer::nextTokenDelayMs()
+{
+
+    if( !enabled() )
+        return 0;
+
+    refill();
+
+    if( m_tokens >= 1.0 )
+        return 0;
+
+    return ( 1.0 - m_tokens ) * 1000.0 / m_rate;
+
+}
+
+//***************************************************************************************************
+
+double EPacer::oldestWaitMs() const
+{
+
+    double waitMs = 0;
+
+    Clock::time_point now = Clock::now();
+
+    for( int i = 0; i < PACE_LANE_COUNT; ++i ) 
+    {
+
+        if( m_lanes[ i ].empty() )
+            continue;
+
+        waitMs = ( std::max )(      waitMs, 
+                                    std::chrono::duration< double, std::milli >( now - m_lanes[ i ].front().queuedAt ).count()      );
+
+    }
+
+    return waitMs;
+
+}
+
+//***************************************************************************************************
+
+EPaceLaneStats EPacer::laneStats( EPaceLane lane ) const
+{
+
+    return m_stats[ lane ];
+
+}
+
+//***************************************************************************************************
+
+void EPacer::resetStats()
+{
+
+    for( int i = 0; i < PACE_LANE_COUNT; ++i ) 
+    {
+
+        size_t depth = m_lanes[ i ].size();
+
+        memset(             &m_stats[ i ], 
+                            0, 
+                            sizeof( EPaceLaneStats )            );
+
+        m_stats[ i ].depth = depth;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+EPaceLane EPacer::laneFor( int msgId )
+{
+
+    switch( msgId ) 
+    {
+
+        case PLACE_ORDER:
+        case CANCEL_ORDER:
+        case REQ_GLOBAL_CANCEL:
+        case EXERCISE_OPTIONS:
+            return PACE_LANE_ORDER;
+
+        case REQ_MKT_DATA:
+        case CANCEL_MKT_DATA:
+        case REQ_MKT_DEPTH:
+        case CANCEL_MKT_DEPTH:
+        case REQ_HISTORICAL_DATA:
+        case CANCEL_HISTORICAL_DATA:
+        case REQ_REAL_TIME_BARS:
+        case CANCEL_REAL_TIME_BARS:
+        case REQ_TICK_BY_TICK_DATA:
+        case CANCEL_TICK_BY_TICK_DATA:
+        case REQ_HISTORICAL_TICKS:
+        case REQ_SCANNER_SUBSCRIPTION:
+        case CANCEL_SCANNER_SUBSCRIPTION:
+        case REQ_FUNDAMENTAL_DATA:
+        case CANCEL_FUNDAMENTAL_DATA:
+        case REQ_CONTRACT_DATA:
+        case REQ_SEC_DEF_OPT_PARAMS:
+        case REQ_HEAD_TIMESTAMP:
+        case CANCEL_HEAD_TIMESTAMP:
+        case REQ_HISTOGRAM_DATA:
+        case CANCEL_HISTOGRAM_DATA:
+        case REQ_HISTORICAL_NEWS:
+        case REQ_NEWS_ARTICLE:
+        case REQ_CALC_IMPLIED_VOLAT:
+        case CANCEL_CALC_IMPLIED_VOLAT:
+        case REQ_CALC_OPTION_PRICE:
+        case CANCEL_CALC_OPTION_PRICE:
+            return PACE_LANE_BULK;
+
+        default:
+            return PACE_LANE_DEFAULT;
+
+    }
+
+}
+
+//***************************************************************************************************
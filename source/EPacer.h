@@ -0,0 +1,129 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EPACER_H
+#define TWS_API_CLIENT_EPACER_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// priority lanes, lower value is released first.
+// A request and its matching cancel always share a lane so a cancel can never
+// overtake the request it cancels.
+//******************************************************************************************
+
+enum EPaceLane 
+{
+
+    PACE_LANE_ORDER,        // placeOrder ( new and modify ), cancelOrder, reqGlobalCancel, exerciseOptions
+    PACE_LANE_DEFAULT,      // account, positions, ids and everything not listed elsewhere
+    PACE_LANE_BULK,         // market data / depth / bars / historical / scanner subscriptions and their cancels
+
+    PACE_LANE_COUNT
+
+};
+
+//******************************************************************************************
+
+struct EPaceLaneStats
+{
+
+    size_t                  depth;          // frames currently waiting
+    unsigned long long      sent;           // frames released through this lane
+    unsigned long long      delayed;        // frames that had to wait for a token
+    double                  totalWaitMs;    // sum of waits of delayed frames
+    double                  maxWaitMs;      // longest single wait
+
+};
+
+//******************************************************************************************
+// token bucket in front of EClientSocket::closeAndSend: 'rate' tokens per second
+// are added up to 'burst'; every outgoing frame costs one token. Frames that find
+// the bucket empty are parked in their lane until EClientSocket::onSend releases them.
+//
+// Not thread safe, same contract as EClient itself: used from the thread issuing
+// requests and the one calling EReader::processMsgs. queueDepth() may be read anywhere.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EPacer
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    struct QueuedFrame 
+    {
+        std::string         frame;
+        Clock::time_point   queuedAt;
+    };
+
+    double                          m_rate;         // tokens per second, <= 0 disables pacing
+    double                          m_burst;        // bucket capacity
+    double                          m_tokens;
+    Clock::time_point               m_lastRefill;
+
+    std::deque< QueuedFrame >       m_lanes[ PACE_LANE_COUNT ];
+    EPaceLaneStats                  m_stats[ PACE_LANE_COUNT ];
+
+    std::atomic< size_t >           m_depth;        // frames waiting in all lanes
+
+
+    void                refill              (                                                       );
+
+public:
+
+    // TWS rejects clients going above 50 msg/s; rate + burst <= 50 keeps any one second window under it
+    static const int    DEFAULT_RATE    = 45;
+    static const int    DEFAULT_BURST   = 5;
+
+    EPacer();
+
+    void                configure           (       double          rate, 
+                                                    double          burst                           );
+
+    bool                enabled             (                                                       ) const;
+    double              rate                (                                                       ) const { return m_rate;  }
+    double              burst               (                                                       ) const { return m_burst; }
+
+    // true if a frame of this lane may go out right now ( consumes a token )
+    bool                admit               (       EPaceLane       lane                            );
+
+    // parks a frame that was not admitted, takes ownership of the string contents
+    void                push                (       EPaceLane       lane, 
+                                                    std::string&    frame                           );
+
+    // hands out the next frame in priority order if a token is available
+    bool                release             (       std::string&    frame                           );
+
+    // a frame that went out without asking ( the pipelined startup ): takes its token
+    // anyway, going into debt if need be, so what follows still respects the rate
+    void                charge              (       EPaceLane       lane                            );
+
+    // drops every parked frame, used when the connection goes away
+    void                clear               (                                                       );
+
+    size_t              queueDepth          (                                                       ) const;
+    size_t              queueDepth          (       EPaceLane       lane                            ) const;
+
+    // milliseconds until the next token is available, 0 if one is available now
+    double              nextTokenDelayMs    (                                                       );
+
+    // wait of the oldest parked frame in milliseconds
+    double              oldestWaitMs        (                                                       ) const;
+
+    EPaceLaneStats      laneStats           (       EPaceLane       lane                            ) const;
+    void                resetStats          (                                                       );
+
+    static EPaceLane    laneFor             (       int             msgId                           );
+
+};
+
+//******************************************************************************************
+
+#endif
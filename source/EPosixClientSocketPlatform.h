@@ -9,6 +9,7 @@
 	// Windows
 	// includes
 	#include <WinSock2.h>
+	#include <WS2tcpip.h>
 	#include <time.h>
 
 	// defines
@@ -35,12 +36,17 @@
 		return ( ioctlsocket( sockfd, FIONBIO, &mode) == 0);
 	}
 
+	inline bool SocketConnectInProgress() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+
 #else
 	// LINUX
 	// includes
 
 	#include <arpa/inet.h>
 	#include <netdb.h>
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <sys/socket.h>
 	#include <errno.h>
 	#include <sys/select.h>
 	#include <sys/fcntl.h>
@@ -109,6 +115,15 @@
 	}
 
 	//***************************************************************************************
+	// true when connect() on a non-blocking socket went on in the background
+
+	inline 
+	bool	SocketConnectInProgress() 
+	{
+		return ( errno == EINPROGRESS );
+	}
+
+	//***************************************************************************************
 
 #endif
 
@@ -0,0 +1,278 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EQuoteTable.h"
+#include "EWrapper.h"
+
+#include <chrono>
+#include <new>
+#include <string.h>
+
+
+namespace {
+
+    const size_t    CACHE_LINE  = 64;
+
+    long long nowNs()
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    }
+
+}
+
+
+//***************************************************************************************************
+
+EQuoteTable::EQuoteTable(       int         firstTickerId, 
+                                int         capacity        )
+
+    : m_pMemory         (   0                                   )
+    , m_pSlots          (   0                                   )
+    , m_firstTickerId   (   firstTickerId                       )
+    , m_capacity        (   capacity > 0 ? capacity : 0         )
+{
+
+    static_assert( sizeof( Slot ) == CACHE_LINE, "one slot per cache line" );
+
+    // new[] does not align past 16 bytes before C++17
+    m_pMemory = new char[ m_capacity * CACHE_LINE + CACHE_LINE ];
+
+    char* aligned = m_pMemory + ( CACHE_LINE - ( size_t )m_pMemory % CACHE_LINE ) % CACHE_LINE;
+
+    memset( aligned, 0, m_capacity * CACHE_LINE );
+
+    m_pSlots = reinterpret_cast< Slot* >( aligned );
+
+    for( int i = 0; i < m_capacity; ++i )
+        new( m_pSlots + i ) Slot();
+
+}
+
+//***************************************************************************************************
+
+EQuoteTable::~EQuoteTable()
+{
+
+    delete[] m_pMemory;
+
+}
+
+//***************************************************************************************************
+
+EQuoteTable::Slot* EQuoteTable::slotFor( int tickerId ) const
+{
+
+    unsigned index = ( unsigned )( tickerId - m_firstTickerId );
+
+    if( index >= ( unsigned )m_capacity )
+        return 0;
+
+    return m_pSlots + index;
+
+}
+
+//***************************************************************************************************
+
+void EQuoteTable::beginWrite( Slot& slot )
+{
+
+    slot.seq.store( slot.seq.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_release );
+
+}
+
+//***************************************************************************************************
+
+void EQuoteTable::endWrite( Slot& slot )
+{
+
+    slot.seq.store( slot.seq.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+
+}
+
+//***************************************************************************************************
+
+bool EQuoteTable::applyPrice(   int             tickerId, 
+                                int             tickType, 
+                                double          price, 
+                                int             size            )
+{
+
+    Slot* slot = slotFor( tickerId );
+
+    if( !slot )
+        return false;
+
+    // TICK_PRICE carries the size of bid / ask / last: both change in one write
+    double* field       = 0;
+    int*    sizeField   = 0;
+
+    switch( tickType ) 
+    {
+
+        case BID:
+        case DELAYED_BID:
+            field       = &slot->bid;
+            sizeField   = &slot->bidSize;
+            break;
+
+        case ASK:
+        case DELAYED_ASK:
+            field       = &slot->ask;
+            sizeField   = &slot->askSize;
+            break;
+
+        case LAST:
+        case DELAYED_LAST:
+            field       = &slot->last;
+            sizeField   = &slot->lastSize;
+            break;
+
+        case CLOSE:
+        case DELAYED_CLOSE:
+            field       = &slot->close;
+            break;
+
+        default:
+            return false;
+
+    }
+
+    beginWrite( *slot );
+
+    *field = price;
+
+    if( sizeField )
+        *sizeField = size;
+
+    slot->updates  += 1;
+    slot->timeNs    = nowNs();
+
+    endWrite( *slot );
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+bool EQuoteTable::applySize(    int             tickerId, 
+                                int             tickType, 
+                                int             size            )
+{
+
+    Slot* slot = slotFor( tickerId );
+
+    if( !slot )
+        return false;
+
+    int* field = 0;
+
+    switch( tickType ) 
+    {
+
+        case BID_SIZE:
+        case DELAYED_BID_SIZE:
+            field = &slot->bidSize;
+            break;
+
+        case ASK_SIZE:
+        case DELAYED_ASK_SIZE:
+            field = &slot->askSize;
+            break;
+
+        case LAST_SIZE:
+        case DELAYED_LAST_SIZE:
+            field = &slot->lastSize;
+            break;
+
+        case VOLUME:
+        case DELAYED_VOLUME:
+            field = &slot->volume;
+            break;
+
+        default:
+            return false;
+
+    }
+
+    beginWrite( *slot );
+
+    *field = size;
+
+    slot->updates  += 1;
+    slot->timeNs    = nowNs();
+
+    endWrite( *slot );
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EQuoteTable::reset( int tickerId )
+{
+
+    Slot* slot = slotFor( tickerId );
+
+    if( !slot )
+        return;
+
+    beginWrite( *slot );
+
+    slot->bid       = 0;
+    slot->ask       = 0;
+    slot->last      = 0;
+    slot->close     = 0;
+    slot->bidSize   = 0;
+    slot->askSize   = 0;
+    slot->lastSize  = 0;
+    slot->volume    = 0;
+    slot->timeNs    = 0;
+    slot->updates   = 0;
+
+    endWrite( *slot );
+
+}
+
+//***************************************************************************************************
+
+bool EQuoteTable::snapshot(     int             tickerId, 
+                                EQuote&         quote           ) const
+{
+
+    const Slot* slot = slotFor( tickerId );
+
+    if( !slot )
+        return false;
+
+    for( ;; ) 
+    {
+
+        unsigned before = slot->seq.load( std::memory_order_acquire );
+
+        if( before & 1 )
+            continue;       // being written, a few nanoseconds
+
+        quote.bid       = slot->bid;
+        quote.ask       = slot->ask;
+        quote.last      = slot->last;
+        quote.close     = slot->close;
+        quote.bidSize   = slot->bidSize;
+        quote.askSize   = slot->askSize;
+        quote.lastSize  = slot->lastSize;
+        quote.volume    = slot->volume;
+        quote.timeNs    = slot->timeNs;
+        quote.updates   = slot->updates;
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+
+        if( slot->seq.load( std::memory_order_relaxed ) == before )
+            return quote.updates != 0;
+
+    }
+
+}
@@ -0,0 +1,106 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EQUOTETABLE_H
+#define TWS_API_CLIENT_EQUOTETABLE_H
+
+#include <atomic>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+
+struct EQuote 
+{
+
+    double              bid;
+    double              ask;
+    double              last;
+    double              close;
+    int                 bidSize;
+    int                 askSize;
+    int                 lastSize;
+    int                 volume;
+    long long           timeNs;         // steady clock of the last update
+    unsigned            updates;        // 0: nothing received yet
+
+};
+
+//******************************************************************************************
+// latest top of book of every reqMktData subscription, written by the decoder straight
+// from TICK_PRICE / TICK_SIZE ( EClientSocket::setQuoteTable ) and read by any number
+// of threads without locking.
+//
+// Slots are indexed by tickerId - firstTickerId, one cache line each, and protected by
+// a sequence lock: the single writer makes the count odd while it updates, a reader
+// copies the slot and retries if the count was odd or moved meanwhile. Readers never
+// block the decoder and always get the bid / ask / sizes of one and the same moment.
+// Delayed ticks ( DELAYED_BID ... ) go to the same fields as the live ones.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EQuoteTable
+{
+
+    struct Slot 
+    {
+        std::atomic< unsigned >     seq;
+        unsigned                    updates;
+        double                      bid;
+        double                      ask;
+        double                      last;
+        double                      close;
+        int                         bidSize;
+        int                         askSize;
+        int                         lastSize;
+        int                         volume;
+        long long                   timeNs;
+    };
+
+    char*                           m_pMemory;
+    Slot*                           m_pSlots;           // cache line aligned
+    int                             m_firstTickerId;
+    int                             m_capacity;
+
+
+    Slot*               slotFor             (       int             tickerId                        ) const;
+    void                beginWrite          (       Slot&           slot                            );
+    void                endWrite            (       Slot&           slot                            );
+
+public:
+
+    // room for tickerIds firstTickerId .. firstTickerId + capacity - 1
+    EQuoteTable(                                    int             firstTickerId, 
+                                                    int             capacity                        );
+    ~EQuoteTable();
+
+    // writer side, one thread ( the decoder's ); false for a tickerId out of range or a
+    // tick type the table does not keep
+    bool                applyPrice          (       int             tickerId, 
+                                                    int             tickType, 
+                                                    double          price, 
+                                                    int             size                            );
+    bool                applySize           (       int             tickerId, 
+                                                    int             tickType, 
+                                                    int             size                            );
+    void                reset               (       int             tickerId                        );
+
+    // reader side, any thread; false if out of range or nothing received yet
+    bool                snapshot            (       int             tickerId, 
+                                                    EQuote&         quote                           ) const;
+
+    bool                contains            (       int             tickerId                        ) const { return slotFor( tickerId ) != 0;  }
+    int                 firstTickerId       (                                                       ) const { return m_firstTickerId;   }
+    int                 capacity            (                                                       ) const { return m_capacity;        }
+
+private:
+
+    EQuoteTable(                                    const EQuoteTable&                              );
+    EQuoteTable&        operator=           (       const EQuoteTable&                              );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -12,6 +12,7 @@
 #include "EReaderSignal.h"
 #include "EMessage.h"
 #include "DefaultEWrapper.h"
+#include "EFrameScanner.h"
 
 
 
@@ -30,6 +31,11 @@ EReader::EReader(			EClientSocket*		clientSocket,
 															clientSocket->getWrapper(), 
 															clientSocket 							)
 
+							,  m_lengthDecoder( 			clientSocket->EClient::serverVersion(), 
+															&defaultWrapper 						)
+
+							,  m_lengthDecoderVersion( 		clientSocket->EClient::serverVersion() 	)
+
 #if defined(IB_POSIX)
 
     , m_hReadThread( pthread_self() )
@@ -223,7 +229,31 @@ bool EReader::processNonBlockingSelect()
 
 	struct timeval  tval;
 
-	tval.tv_usec = 100 * 1000; // timeout 100ms
+	// a connect started by eConnectAsync is completed here, on the reader thread
+	if( m_pClientSocket->connectPending() ) 
+	{
+
+		m_pClientSocket->driveConnect( 100 );
+
+		return false;
+
+	}
+
+	// no server version before the connect deadline: gives up instead of waiting forever
+	if( !m_pClientSocket->checkConnectDeadline() )
+		return false;
+
+	// in concurrent mode this thread is the single sender: it drains the submission
+	// queue itself and owns every write to the socket
+	bool concurrent = m_pClientSocket->concurrentSubmission();
+
+	if( concurrent )
+		m_pClientSocket->drainSubmissions();
+
+	// frames parked by the pacer need the sender to wake up and release them
+	bool paced = m_pClientSocket->pacer().queueDepth() > 0;
+
+	tval.tv_usec = ( paced ? 10 : 100 ) * 1000; // timeout 100ms ( 10ms while frames are paced )
 	tval.tv_sec  = 0;
 
 
@@ -264,6 +294,16 @@ bool EReader::processNonBlockingSelect()
 		FD_SET( 			m_pClientSocket->fd(), 
 							&errorSet 								);
 
+		int wakeFd = m_pClientSocket->wakeFd();
+
+		if( wakeFd >= 0 )
+		{
+
+			FD_SET( 			wakeFd, 
+								&readSet 							);
+
+		}
+
 		/*
 
 		int select(			int 							nfds, 
@@ -304,7 +344,7 @@ bool EReader::processNonBlockingSelect()
 		//***********************************************************************************
 		//***********************************************************************************
 
-		int ret = select( 				 m_pClientSocket->fd() + 1, 
+		int ret = select( 				 ( std::max )( m_pClientSocket->fd(), wakeFd ) + 1, 
 										&readSet, 
 										&writeSet, 
 										&errorSet, 
@@ -314,6 +354,15 @@ bool EReader::processNonBlockingSelect()
 		//***********************************************************************************
 
 
+		if( concurrent )
+			m_pClientSocket->drainSubmissions();
+		else if( paced && m_pEReaderSignal )
+			m_pEReaderSignal->issueSignal();
+
+		// a due latency probe is sent by whoever runs processMsgs, wake it up
+		if( m_pClientSocket->latencyProbeDue() && m_pEReaderSignal )
+			m_pEReaderSignal->issueSignal();
+
 		if( ret == 0 ) // timeout expired
 		{ 
 
@@ -364,7 +413,10 @@ bool EReader::processNonBlockingSelect()
 			//************************************
 			//************************************
 
-			 onSend(); // socket ready for writing
+			if( concurrent ) 
+				m_pClientSocket->drainSubmissions();
+			else
+			 	onSend(); // socket ready for writing
 		
 			//************************************
 			//************************************
@@ -520,25 +572,26 @@ EMessage*  EReader::readSingleMsg()
 	else 
 	{
 
-		const char *pBegin = 0;
-		const char *pEnd   = 0;
-
-		int msgSize        = 0;
+		int msgSize;
 
-		while ( msgSize == 0 )
+		// a complete message may already be buffered, only read when there is none
+		while ( ( msgSize = legacyFrameLength() ) == 0 )
 		{
 
+			// the buffer only grows for a message that does not fit, up to MAX_MSG_LEN
 			if ( m_buf.size() >= m_nMaxBufSize * 3/4 ) 
-				m_nMaxBufSize *= 2;
+			{
+
+				if ( m_nMaxBufSize >= (unsigned int)MAX_MSG_LEN )
+					return 0;
+
+				m_nMaxBufSize = ( std::min )( m_nMaxBufSize * 2, (unsigned int)MAX_MSG_LEN );
+
+			}
 
 			if ( !processNonBlockingSelect() && !m_pClientSocket->isSocketOK() )
 				return 0;
 		
-			pBegin 	= m_buf.data();
-			pEnd 	= pBegin + m_buf.size();
-			
-			msgSize = EDecoder(	m_pClientSocket->EClient::serverVersion(), &defaultWrapper ).parseAndProcessMsg( pBegin, pEnd );
-		
 		}
 	
 		std::vector<char> msgData( msgSize );
@@ -546,10 +599,12 @@ EMessage*  EReader::readSingleMsg()
 		if ( !bufferedRead( msgData.data(), msgSize ) )
 			return 0;
 
+		// back to the default size once the large message is out; the buffered bytes
+		// are kept as they are ( resizing here would pad the stream with zeros )
 		if ( m_buf.size() < IN_BUF_SIZE_DEFAULT && m_buf.capacity() > IN_BUF_SIZE_DEFAULT )
 		{
 
-			m_buf.resize( m_nMaxBufSize = IN_BUF_SIZE_DEFAULT );
+			m_nMaxBufSize = IN_BUF_SIZE_DEFAULT;
 		
 			m_buf.shrink_to_fit();
 		
@@ -565,6 +620,47 @@ EMessage*  EReader::readSingleMsg()
 
 //***************************************************************************************************
 
+int EReader::legacyFrameLength()
+{
+
+	if ( m_buf.empty() )
+		return 0;
+
+	const char *pBegin 	= m_buf.data();
+	const char *pEnd 	= pBegin + m_buf.size();
+
+	int serverVersion 	= m_pClientSocket->EClient::serverVersion();
+
+	// no server version yet: the connect ack, which only the decoder knows
+	if ( serverVersion > 0 ) 
+	{
+
+		int msgSize = EFrameScanner::scan( 		pBegin, 
+												pEnd, 
+												serverVersion 					);
+
+		if ( msgSize != EFrameScanner::UNKNOWN_LAYOUT )
+			return msgSize;
+
+	}
+
+	if ( m_lengthDecoderVersion != serverVersion ) 
+	{
+
+		m_lengthDecoder 		= EDecoder( 	serverVersion, 
+												&defaultWrapper 				);
+
+		m_lengthDecoderVersion 	= serverVersion;
+
+	}
+
+	return m_lengthDecoder.parseAndProcessMsg( 	pBegin, 
+												pEnd 							);
+
+}
+
+//***************************************************************************************************
+
 std::shared_ptr<EMessage> EReader::getMsg( void ) 
 {
 
@@ -629,6 +725,14 @@ void EReader::processMsgs( void )
 
 	const char *pBegin = msg->begin();
 
+	EMessageTap *pTap = m_pClientSocket->messageTap();
+
+	if ( pTap )
+		pTap->onMessage( pBegin, msg->end() );
+
+	processMsgsDecoder_.setQuoteTable( m_pClientSocket->quoteTable() );
+	processMsgsDecoder_.setTickByTickNormalizer( m_pClientSocket->tickByTickNormalizer() );
+
 
 	//*****************************************
 	// loop goes processing messages one by one
@@ -653,6 +757,9 @@ void EReader::processMsgs( void )
 
 		pBegin = msg->begin();
 
+		if ( pTap )
+			pTap->onMessage( pBegin, msg->end() );
+
 	} 
 
 	//*****************************************
@@ -26,6 +26,15 @@ class TWSAPIDLLEXP EReader
     EClientSocket                          *m_pClientSocket;
     EReaderSignal                          *m_pEReaderSignal;
     EDecoder                                processMsgsDecoder_;
+
+    //*****************************************************************************
+    // pre-V100 framing: EFrameScanner measures the common messages, everything
+    // else is measured by this decoder ( bound to a do-nothing EWrapper ) which is
+    // kept as long as the server version it was made for does not change
+    //*****************************************************************************
+
+    EDecoder                                m_lengthDecoder;
+    int                                     m_lengthDecoderVersion;
     
 
     //*****************************************************************************
@@ -63,6 +72,8 @@ class TWSAPIDLLEXP EReader
 	bool                            bufferedRead            (       char           *buf, 
                                                                     unsigned int    size    );
 
+    int                             legacyFrameLength       (                               );
+
 public:
 
     EReader(        EClientSocket*      clientSocket, 
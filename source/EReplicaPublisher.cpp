@@ -0,0 +1,248 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EPosixClientSocketPlatform.h"
+#include "EReplicaPublisher.h"
+#include "EClientSocket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+//***************************************************************************************************
+
+EReplicaPublisher::EReplicaPublisher( EClientSocket* client )
+
+    : m_pClient             (   client                  )
+    , m_journalRevision     (   ~0ULL                   )
+    , m_heartbeatMs         (   DEFAULT_HEARTBEAT_MS    )
+    , m_lastBeat            (   Clock::now()            )
+{
+
+    m_pClient->setMessageTap( this );
+
+}
+
+//***************************************************************************************************
+
+EReplicaPublisher::~EReplicaPublisher()
+{
+
+    if( m_pClient->messageTap() == this )
+        m_pClient->setMessageTap( 0 );
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool EReplicaPublisher::listen(         int             port, 
+                                        const char*     host            )
+{
+
+    close();
+
+    return m_server.listen( port, host, 4 );
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::close()
+{
+
+    for( size_t i = 0; i < m_peers.size(); ++i )
+        SocketClose( m_peers[ i ].fd );
+
+    m_peers.clear();
+
+    m_server.close();
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::setHeartbeat( int heartbeatMs )
+{
+
+    m_heartbeatMs = heartbeatMs;
+
+}
+
+//***************************************************************************************************
+
+size_t EReplicaPublisher::standbys() const
+{
+
+    return m_peers.size();
+
+}
+
+//***************************************************************************************************
+
+unsigned long long EReplicaPublisher::applied() const
+{
+
+    EMutexGuard lock( m_csReplica );
+
+    return m_replica.applied();
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::onMessage(      const char*     begin, 
+                                        const char*     end             )
+{
+
+    EMutexGuard lock( m_csReplica );
+
+    // the client may have reconnected since the last pump: the state of the old
+    // connection has to go before the first message of the new one is kept
+    if( m_replica.connection() != m_pClient->connections() )
+        checkHello();
+
+    if( m_replica.apply( begin, end ) )
+        EStateReplica::encodeRecord( m_pending, REPLICA_MESSAGE, begin, end - begin );
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::checkHello()
+{
+
+    int serverVersion = m_pClient->EClient::serverVersion();
+
+    if( serverVersion <= 0 )
+        return;
+
+    if( serverVersion               == m_replica.serverVersion() && 
+        m_pClient->connections()    == m_replica.connection() && 
+        m_pClient->clientId()       == m_replica.clientId() && 
+        m_pClient->port()           == m_replica.port() && 
+        m_pClient->host()           == m_replica.host() )
+        return;
+
+    m_replica.hello(        serverVersion, 
+                            m_pClient->clientId(), 
+                            m_pClient->host(), 
+                            m_pClient->port(), 
+                            m_pClient->connections()    );
+
+    m_replica.encodeHello( m_pending );
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::checkJournal()
+{
+
+    ERequestJournal* journal = m_pClient->requestJournal();
+
+    if( !journal || journal->revision() == m_journalRevision )
+        return;
+
+    m_journalRevision = journal->revision();
+
+    std::vector< ERequestJournal::Record > records;
+
+    journal->records( records );
+
+    m_replica.setJournal( records );
+
+    m_replica.encodeJournal( m_pending );
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::acceptPeers()
+{
+
+    int fd;
+
+    while( ( fd = m_server.accept() ) >= 0 ) 
+    {
+
+        Peer peer;
+
+        peer.fd     = fd;
+        peer.synced = false;
+
+        m_peers.push_back( peer );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EReplicaPublisher::pump()
+{
+
+    acceptPeers();
+
+    bool beat = Clock::now() - m_lastBeat >= std::chrono::milliseconds( m_heartbeatMs );
+
+    if( beat )
+        m_lastBeat = Clock::now();
+
+    {
+
+        EMutexGuard lock( m_csReplica );
+
+        checkHello();
+        checkJournal();
+
+        // a new standby gets the whole state, which already includes the pending deltas
+        std::string snapshot;
+
+        for( size_t i = 0; i < m_peers.size(); ++i ) 
+        {
+
+            Peer& peer = m_peers[ i ];
+
+            if( !peer.synced ) 
+            {
+
+                if( snapshot.empty() )
+                    m_replica.encodeSnapshot( snapshot );
+
+                peer.out   += snapshot;
+                peer.synced = true;
+
+            }
+            else
+                peer.out += m_pending;
+
+        }
+
+        m_pending.clear();
+
+    }
+
+    for( size_t i = 0; i < m_peers.size(); ) 
+    {
+
+        Peer& peer = m_peers[ i ];
+
+        if( beat && peer.out.empty() )
+            EStateReplica::encodeRecord( peer.out, REPLICA_HEARTBEAT, "", 0 );
+
+        if( ELocalServer::flush( peer.fd, peer.out ) ) 
+        {
+            ++i;
+            continue;
+        }
+
+        SocketClose( peer.fd );
+
+        m_peers.erase( m_peers.begin() + i );
+
+    }
+
+}
@@ -0,0 +1,91 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EREPLICAPUBLISHER_H
+#define TWS_API_CLIENT_EREPLICAPUBLISHER_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "ELocalServer.h"
+#include "EMessageTap.h"
+#include "EMutex.h"
+#include "EStateReplica.h"
+
+
+class EClientSocket;
+
+
+
+//******************************************************************************************
+// primary side of a hot standby: taps the incoming messages of a client, keeps the
+// replicated state ( EStateReplica ) and streams it over a local TCP socket to any
+// number of EReplicaStandby processes. A standby connecting late first gets a snapshot,
+// then the same deltas as everyone else, plus heartbeats while nothing happens.
+//
+// The journal replicated is the one set on the client ( ESession sets its own ).
+// onMessage() runs on the processMsgs thread; pump() must be called regularly, from
+// the application loop, to accept standbys and write to them.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EReplicaPublisher : public EMessageTap
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    struct Peer 
+    {
+        int                 fd;
+        bool                synced;         // snapshot queued
+        std::string         out;            // bytes not written yet
+    };
+
+    EClientSocket*                  m_pClient;
+
+    EStateReplica                   m_replica;
+    std::string                     m_pending;          // records since the last pump()
+    mutable EMutex                  m_csReplica;
+
+    ELocalServer                    m_server;
+    std::vector< Peer >             m_peers;
+
+    unsigned long long              m_journalRevision;
+    int                             m_heartbeatMs;
+    Clock::time_point               m_lastBeat;
+
+
+    void                checkHello          (                                                       );
+    void                checkJournal        (                                                       );
+    void                acceptPeers         (                                                       );
+
+public:
+
+    static const int    DEFAULT_HEARTBEAT_MS    = 500;
+
+    // installs itself as the client's message tap
+    explicit EReplicaPublisher(                     EClientSocket*  client                          );
+            ~EReplicaPublisher();
+
+    // listens for standbys, on the loopback interface unless another host is given
+    bool                listen              (       int             port, 
+                                                    const char*     host        = 0                 );
+    void                close               (                                                       );
+
+    void                pump                (                                                       );
+
+    void                setHeartbeat        (       int             heartbeatMs                     );
+
+    size_t              standbys            (                                                       ) const;
+    unsigned long long  applied             (                                                       ) const;
+
+    // EMessageTap
+    void                onMessage           (       const char*     begin, 
+                                                    const char*     end                             );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,271 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EPosixClientSocketPlatform.h"
+#include "EReplicaStandby.h"
+#include "ELocalServer.h"
+#include "EClientSocket.h"
+#include "ESession.h"
+#include "Execution.h"
+#include "DefaultEWrapper.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+static DefaultEWrapper standbyDefaultWrapper;
+
+
+//***************************************************************************************************
+
+EReplicaStandby::EReplicaStandby( EWrapper* wrapper )
+
+    : m_pWrapper        (   wrapper ? wrapper : &standbyDefaultWrapper  )
+    , m_decoder         (   0, m_pWrapper                               )
+    , m_fd              (   -1                                          )
+    , m_state           (   STANDBY_IDLE                                )
+    , m_timeoutMs       (   DEFAULT_TIMEOUT_MS                          )
+    , m_records         (   0                                           )
+{
+
+    SocketsInit();
+
+}
+
+//***************************************************************************************************
+
+EReplicaStandby::~EReplicaStandby()
+{
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool EReplicaStandby::connect(          const char*     host, 
+                                        int             port            )
+{
+
+    close();
+
+    struct addrinfo hints;
+
+    memset( &hints, 0, sizeof( hints ) );
+
+    hints.ai_family     = AF_UNSPEC;
+    hints.ai_socktype   = SOCK_STREAM;
+
+    char service[ 16 ];
+
+    snprintf( service, sizeof( service ), "%d", port );
+
+    struct addrinfo* res = 0;
+
+    if( getaddrinfo( ( host && *host ) ? host : "127.0.0.1", service, &hints, &res ) != 0 || !res )
+        return false;
+
+    for( struct addrinfo* ai = res; ai && m_fd < 0; ai = ai->ai_next ) 
+    {
+
+        int fd = ( int )socket( ai->ai_family, ai->ai_socktype, ai->ai_protocol );
+
+        if( fd < 0 )
+            continue;
+
+        if( ::connect( fd, ai->ai_addr, ( int )ai->ai_addrlen ) == 0 && SetSocketNonBlocking( fd ) )
+            m_fd = fd;
+        else
+            SocketClose( fd );
+
+    }
+
+    freeaddrinfo( res );
+
+    if( m_fd < 0 )
+        return false;
+
+    m_in.clear();
+
+    m_state         = STANDBY_SYNCING;
+    m_lastRecord    = Clock::now();
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EReplicaStandby::close()
+{
+
+    if( m_fd >= 0 )
+        SocketClose( m_fd );
+
+    m_fd = -1;
+
+}
+
+//***************************************************************************************************
+
+void EReplicaStandby::setTimeout( int timeoutMs )
+{
+
+    m_timeoutMs = timeoutMs;
+
+}
+
+//***************************************************************************************************
+
+void EReplicaStandby::lost()
+{
+
+    close();
+
+    // a standby that never got the whole snapshot has nothing reliable to take over with
+    m_state = ( m_state == STANDBY_WARM ) ? STANDBY_PRIMARY_LOST : STANDBY_IDLE;
+
+}
+
+//***************************************************************************************************
+
+EStandbyState EReplicaStandby::pump( int timeoutMs )
+{
+
+    if( m_fd < 0 )
+        return m_state;
+
+    fd_set readSet;
+
+    FD_ZERO( &readSet );
+    FD_SET( m_fd, &readSet );
+
+    struct timeval tval;
+
+    tval.tv_sec     = timeoutMs / 1000;
+    tval.tv_usec    = ( timeoutMs % 1000 ) * 1000;
+
+    int ret = select( m_fd + 1, &readSet, 0, 0, &tval );
+
+    bool open = ret <= 0 || ELocalServer::receive( m_fd, m_in );     // false once the primary closed or reset
+
+    // apply whatever arrived, even if the link closed right after it
+    size_t      pos = 0;
+    int         type;
+    const char* payload;
+    size_t      len;
+    int         used;
+
+    while( ( used = EStateReplica::readRecord( m_in.data() + pos, m_in.data() + m_in.size(), type, payload, len ) ) > 0 ) 
+    {
+
+        pos += used;
+
+        ++m_records;
+
+        m_lastRecord = Clock::now();
+
+        switch( type ) 
+        {
+
+            case REPLICA_HELLO:
+
+                m_replica.applyRecord( type, payload, len );
+
+                m_decoder = EDecoder( m_replica.serverVersion(), m_pWrapper );
+
+                break;
+
+            case REPLICA_MESSAGE: 
+            {
+
+                if( !m_replica.apply( payload, payload + len ) )
+                    break;
+
+                const char* ptr = payload;
+
+                m_decoder.parseAndProcessMsg( ptr, payload + len );
+
+                break;
+
+            }
+
+            case REPLICA_JOURNAL:
+                m_replica.applyRecord( type, payload, len );
+                break;
+
+            case REPLICA_SNAPSHOT_END:
+                m_state = STANDBY_WARM;
+                break;
+
+            default:    // heartbeat
+                break;
+
+        }
+
+    }
+
+    m_in.erase( 0, pos );
+
+    if( used < 0 || !open )
+        lost();
+    else if( m_timeoutMs > 0 && Clock::now() - m_lastRecord > std::chrono::milliseconds( m_timeoutMs ) )
+        lost();
+
+    return m_state;
+
+}
+
+//***************************************************************************************************
+
+bool EReplicaStandby::takeover(         ESession&       session, 
+                                        int             execReqId       )
+{
+
+    if( m_state != STANDBY_WARM && m_state != STANDBY_PRIMARY_LOST )
+        return false;
+
+    close();
+
+    ERequestJournal& journal = session.journal();
+
+    journal.clear();
+
+    const std::vector< ERequestJournal::Record >& records = m_replica.journal();
+
+    for( size_t i = 0; i < records.size(); ++i )
+        journal.record( records[ i ].msgId, records[ i ].reqId, records[ i ].frame, records[ i ].serverVersion );
+
+    if( !session.connect(       m_replica.host().c_str(), 
+                                m_replica.port(), 
+                                m_replica.clientId()        ) ) 
+    {
+
+        session.disconnect();
+
+        m_state = STANDBY_PRIMARY_LOST;
+
+        return false;
+
+    }
+
+    EClientSocket* client = session.client();
+
+    // session.connect() does not replay, only its reconnects do
+    client->replayRequestJournal();
+
+    client->reqOpenOrders();
+
+    ExecutionFilter filter;
+
+    filter.m_clientId   = m_replica.clientId();
+    filter.m_time       = m_replica.lastExecTime();
+
+    client->reqExecutions( execReqId, filter );
+
+    m_state = STANDBY_ACTIVE;
+
+    return true;
+
+}
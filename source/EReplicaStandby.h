@@ -0,0 +1,96 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EREPLICASTANDBY_H
+#define TWS_API_CLIENT_EREPLICASTANDBY_H
+
+#include <chrono>
+#include <string>
+#include "platformspecific.h"
+#include "EDecoder.h"
+#include "EStateReplica.h"
+
+
+class EWrapper;
+class ESession;
+
+
+
+//******************************************************************************************
+
+enum EStandbyState 
+{
+
+    STANDBY_IDLE,           // not connected to a primary
+    STANDBY_SYNCING,        // receiving the snapshot
+    STANDBY_WARM,           // mirror up to date, following the deltas
+    STANDBY_PRIMARY_LOST,   // replication link closed or silent past the timeout
+    STANDBY_ACTIVE          // took over the primary's connection
+
+};
+
+//******************************************************************************************
+// standby side of a hot standby: mirrors an EReplicaPublisher and, when the primary
+// goes away, takes over its TWS connection ( same host, port and clientId ).
+//
+// Every replicated TWS message is also decoded into the wrapper given, so the standby
+// application sees openOrder / orderStatus / position / execDetails / commissionReport
+// as the primary did and keeps its own books warm.
+//
+// takeover() connects the session, re-issues the replicated subscriptions and asks only
+// for what may have changed since: open orders and the executions after the last one
+// replicated. Single threaded, drive it with pump() until it reports the primary lost.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EReplicaStandby
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    EWrapper*                       m_pWrapper;
+    EStateReplica                   m_replica;
+    EDecoder                        m_decoder;          // replicated messages -> m_pWrapper
+
+    int                             m_fd;
+    std::string                     m_in;
+    EStandbyState                   m_state;
+
+    int                             m_timeoutMs;
+    Clock::time_point               m_lastRecord;
+    unsigned long long              m_records;
+
+
+    void                lost                (                                                       );
+
+public:
+
+    static const int    DEFAULT_TIMEOUT_MS  = 3000;
+
+    explicit EReplicaStandby(                       EWrapper*       wrapper     = 0                 );
+            ~EReplicaStandby();
+
+    bool                connect             (       const char*     host, 
+                                                    int             port                            );
+    void                close               (                                                       );
+
+    // silence after which the primary is considered gone ( it sends heartbeats )
+    void                setTimeout          (       int             timeoutMs                       );
+
+    // waits at most timeoutMs for replication data and applies everything received
+    EStandbyState       pump                (       int             timeoutMs   = 100               );
+
+    // connects 'session' in place of the primary; on failure nothing is lost and it can
+    // be called again. execReqId is the request id used for the executions delta
+    bool                takeover            (       ESession&       session, 
+                                                    int             execReqId   = 0                 );
+
+    EStandbyState       state               (                                                       ) const { return m_state;       }
+    const EStateReplica& replica            (                                                       ) const { return m_replica;     }
+    unsigned long long  records             (                                                       ) const { return m_records;     }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,178 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ERequestJournal.h"
+
+#include <algorithm>
+
+
+
+//***************************************************************************************************
+
+ERequestJournal::ERequestJournal()
+
+    : m_seq         (   0   )
+    , m_revision    (   0   )
+{
+}
+
+//***************************************************************************************************
+
+void ERequestJournal::record(           int                     msgId, 
+                                        int                     reqId, 
+                                        const std::string&      frame, 
+                                        int                     serverVersion   )
+{
+
+    EMutexGuard lock( m_mutex );
+
+    Key key( msgId, reqId );
+
+    std::map< Key, Entry >::iterator it = m_entries.find( key );
+
+    if( it == m_entries.end() ) 
+    {
+        it = m_entries.insert( std::make_pair( key, Entry() ) ).first;
+        it->second.seq = m_seq++;
+    }
+
+    it->second.serverVersion    = serverVersion;
+    it->second.frame            = frame;
+
+    ++m_revision;
+
+}
+
+//***************************************************************************************************
+
+bool ERequestJournal::erase(            int         msgId, 
+                                        int         reqId           )
+{
+
+    EMutexGuard lock( m_mutex );
+
+    if( m_entries.erase( Key( msgId, reqId ) ) == 0 )
+        return false;
+
+    ++m_revision;
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void ERequestJournal::clear()
+{
+
+    EMutexGuard lock( m_mutex );
+
+    m_entries.clear();
+
+    ++m_revision;
+
+}
+
+//***************************************************************************************************
+
+size_t ERequestJournal::size() const
+{
+
+    EMutexGuard lock( m_mutex );
+
+    return m_entries.size();
+
+}
+
+//***************************************************************************************************
+
+void ERequestJournal::snapshot(         int                             serverVersion, 
+                                        std::vector< std::string >&     frames, 
+                                        size_t&                         stale           )
+{
+
+    EMutexGuard lock( m_mutex );
+
+    std::vector< std::pair< unsigned long long, const std::string* > > order;
+
+    order.reserve( m_entries.size() );
+
+    stale = 0;
+
+    for( std::map< Key, Entry >::iterator it = m_entries.begin(); it != m_entries.end(); ) 
+    {
+
+        if( it->second.serverVersion != serverVersion ) 
+        {
+            m_entries.erase( it++ );
+            ++stale;
+            ++m_revision;
+            continue;
+        }
+
+        order.push_back( std::make_pair( it->second.seq, &it->second.frame ) );
+        ++it;
+
+    }
+
+    std::sort( order.begin(), order.end() );
+
+    frames.clear();
+    frames.reserve( order.size() );
+
+    for( size_t i = 0; i < order.size(); ++i )
+        frames.push_back( *order[ i ].second );
+
+}
+
+//***************************************************************************************************
+
+void ERequestJournal::records( std::vector< Record >& records ) const
+{
+
+    EMutexGuard lock( m_mutex );
+
+    std::vector< std::pair< unsigned long long, std::map< Key, Entry >::const_iterator > > order;
+
+    order.reserve( m_entries.size() );
+
+    for( std::map< Key, Entry >::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it )
+        order.push_back( std::make_pair( it->second.seq, it ) );
+
+    std::sort( order.begin(), order.end(), 
+               []( const std::pair< unsigned long long, std::map< Key, Entry >::const_iterator >& a, 
+                   const std::pair< unsigned long long, std::map< Key, Entry >::const_iterator >& b ) 
+               { return a.first < b.first; } );
+
+    records.clear();
+    records.reserve( order.size() );
+
+    for( size_t i = 0; i < order.size(); ++i ) 
+    {
+
+        Record r;
+
+        r.msgId             = order[ i ].second->first.first;
+        r.reqId             = order[ i ].second->first.second;
+        r.serverVersion     = order[ i ].second->second.serverVersion;
+        r.frame             = order[ i ].second->second.frame;
+
+        records.push_back( r );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+unsigned long long ERequestJournal::revision() const
+{
+
+    EMutexGuard lock( m_mutex );
+
+    return m_revision;
+
+}
+
+//***************************************************************************************************
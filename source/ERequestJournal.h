@@ -0,0 +1,86 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EREQUESTJOURNAL_H
+#define TWS_API_CLIENT_EREQUESTJOURNAL_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "platformspecific.h"
+#include "EMutex.h"
+
+
+
+//******************************************************************************************
+// encoded frames of the standing requests of a connection ( market data, depth, bars,
+// tick-by-tick, pnl, account / position streams, ... ) keyed by request message id and
+// reqId. EClient records a request when it is sent and drops it on the matching cancel,
+// so after a reconnect the journal holds exactly what has to be subscribed again.
+//
+// Frames are only valid for the server version they were encoded for.
+// Thread safe: requests may be issued from several threads.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ERequestJournal
+{
+
+    typedef std::pair< int, int >   Key;            // request msgId, reqId ( 0 for account wide streams )
+
+    struct Entry 
+    {
+        unsigned long long          seq;            // first time the key was recorded, keeps replay order
+        int                         serverVersion;
+        std::string                 frame;
+    };
+
+    std::map< Key, Entry >          m_entries;
+    unsigned long long              m_seq;
+    unsigned long long              m_revision;     // bumped by every change
+
+    mutable EMutex                  m_mutex;
+
+public:
+
+    struct Record 
+    {
+        int                         msgId;
+        int                         reqId;
+        int                         serverVersion;
+        std::string                 frame;
+    };
+
+    ERequestJournal();
+
+    // adds or replaces a request; a replaced one keeps its place in the replay order
+    void                record              (       int                     msgId, 
+                                                    int                     reqId, 
+                                                    const std::string&      frame, 
+                                                    int                     serverVersion   );
+
+    bool                erase               (       int                     msgId, 
+                                                    int                     reqId           );
+
+    void                clear               (                                               );
+
+    size_t              size                (                                               ) const;
+
+    // frames in the order they were first recorded; entries encoded for another
+    // server version are dropped and counted in 'stale'
+    void                snapshot            (       int                     serverVersion, 
+                                                    std::vector< std::string >& frames, 
+                                                    size_t&                 stale           );
+
+    // every entry with its key, in replay order; used to copy a journal elsewhere
+    void                records             (       std::vector< Record >&  records         ) const;
+
+    // changes whenever an entry is recorded, replaced or dropped
+    unsigned long long  revision            (                                               ) const;
+
+};
+
+//******************************************************************************************
+
+#endif
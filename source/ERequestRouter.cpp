@@ -0,0 +1,1366 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ERequestRouter.h"
+
+
+
+//*******************************************************************************************************************
+
+ERequestRouter::ERequestRouter(         EWrapper*       fallback, 
+                                        int             firstReqId, 
+                                        size_t          capacity        )
+
+    : m_fallback    (   fallback            )
+    , m_capacity    (   1                   )
+    , m_nextReqId   (   firstReqId < 0 ? 0 : firstReqId )
+    , m_active      (   0                   )
+{
+
+    while( m_capacity < capacity )
+        m_capacity <<= 1;
+
+    m_mask  = m_capacity - 1;
+    m_slots.reset( new Slot[ m_capacity ] );
+
+    for( size_t i = 0; i < m_capacity; ++i ) 
+    {
+        m_slots[ i ].reqId.store( FREE_SLOT, std::memory_order_relaxed );
+        m_slots[ i ].handler.store( 0, std::memory_order_relaxed );
+        m_slots[ i ].kind.store( ROUTE_ONE_SHOT, std::memory_order_relaxed );
+    }
+
+}
+
+//*******************************************************************************************************************
+
+int ERequestRouter::allocate(           EWrapper*       handler, 
+                                        ERouteKind      kind            )
+{
+
+    if( !handler || m_active.load( std::memory_order_relaxed ) >= m_capacity )
+        return -1;
+
+    // every id maps to one slot; ids landing on a busy slot are burnt and the next one is tried
+    for( size_t attempt = 0; attempt < m_capacity; ++attempt ) 
+    {
+        int reqId = m_nextReqId.fetch_add( 1, std::memory_order_relaxed );
+
+        if( reqId < 0 )
+            return -1;      // wrapped around the int range
+
+        Slot& slot = m_slots[ reqId & m_mask ];
+
+        int expected = FREE_SLOT;
+
+        if( !slot.reqId.compare_exchange_strong( expected, CLAIMED_SLOT, std::memory_order_acquire ) )
+            continue;
+
+        slot.handler.store( handler, std::memory_order_relaxed );
+        slot.kind.store( kind, std::memory_order_relaxed );
+
+        m_active.fetch_add( 1, std::memory_order_relaxed );
+
+        // publishes handler / kind to route()
+        slot.reqId.store( reqId, std::memory_order_release );
+
+        return reqId;
+    }
+
+    return -1;
+
+}
+
+//*******************************************************************************************************************
+
+bool ERequestRouter::release( int reqId )
+{
+
+    if( reqId < 0 )
+        return false;
+
+    Slot& slot = m_slots[ reqId & m_mask ];
+
+    int expected = reqId;
+
+    if( !slot.reqId.compare_exchange_strong( expected, CLAIMED_SLOT, std::memory_order_acquire ) )
+        return false;
+
+    slot.handler.store( 0, std::memory_order_relaxed );
+    slot.reqId.store( FREE_SLOT, std::memory_order_release );
+
+    m_active.fetch_sub( 1, std::memory_order_relaxed );
+
+    return true;
+
+}
+
+//*******************************************************************************************************************
+
+void ERequestRouter::releaseOneShot( int reqId )
+{
+
+    if( reqId < 0 )
+        return;
+
+    const Slot& slot = m_slots[ reqId & m_mask ];
+
+    if( slot.reqId.load( std::memory_order_acquire ) == reqId && slot.kind.load( std::memory_order_relaxed ) == ROUTE_ONE_SHOT )
+        release( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+bool ERequestRouter::terminatesRequest( int errorCode )
+{
+
+    switch( errorCode ) 
+    {
+        case 101:       // max number of tickers reached
+        case 162:       // historical market data service error ( no data, pacing violation ... )
+        case 200:       // no security definition found
+        case 309:       // max number of market depth requests reached
+        case 321:       // error validating request
+        case 322:       // error processing request
+        case 354:       // not subscribed to market data
+        case 366:       // no historical data query found
+        case 10089:     // additional subscription required
+        case 10168:     // not subscribed to delayed market data
+        case 10197:     // no market data during competing live session
+            return true;
+        default:
+            return false;
+    }
+
+}
+
+//*******************************************************************************************************************
+
+EWrapper* ERequestRouter::handler( int reqId ) const
+{
+
+    if( reqId < 0 )
+        return 0;
+
+    const Slot& slot = m_slots[ reqId & m_mask ];
+
+    if( slot.reqId.load( std::memory_order_acquire ) != reqId )
+        return 0;
+
+    return slot.handler.load( std::memory_order_relaxed );
+
+}
+
+//*******************************************************************************************************************
+
+EWrapper* ERequestRouter::route( int reqId ) const
+{
+
+    EWrapper* owner = handler( reqId );
+
+    return owner ? owner : m_fallback;
+
+}
+
+//*******************************************************************************************************************
+
+size_t ERequestRouter::active() const
+{
+
+    return m_active.load( std::memory_order_relaxed );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickPrice				( 		TickerId 				tickerId, 
+															TickType 				field, 
+															double 					price, 
+															const TickAttrib& 		attrib					) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickPrice( tickerId, field, price, attrib );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickSize				( 		TickerId 				tickerId, 
+															TickType 				field, 
+															int 					size					) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickSize( tickerId, field, size );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickOptionComputation	( 		TickerId 				tickerId, 
+															TickType 				tickType, 
+															int 					tickAttrib, 
+															double 					impliedVol, 
+															double 					delta, 
+															double 					optPrice, 
+															double 					pvDividend, 
+															double 					gamma, 
+															double 					vega, 
+															double 					theta, 
+															double 					undPrice				) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickOptionComputation( tickerId, tickType, tickAttrib, impliedVol, delta, optPrice, pvDividend, gamma, vega, theta, undPrice );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickGeneric				( 		TickerId 				tickerId, 
+															TickType 				tickType, 
+															double 					value					) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickGeneric( tickerId, tickType, value );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickString				( 		TickerId 				tickerId, 
+															TickType 				tickType, 
+															const std::string& 		value					) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickString( tickerId, tickType, value );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickEFP					( 		TickerId 				tickerId, 
+															TickType 				tickType, 
+															double 					basisPoints, 
+															const std::string& 		formattedBasisPoints, 
+															double 					totalDividends, 
+															int 					holdDays, 
+															const std::string& 		futureLastTradeDate, 
+															double 					dividendImpact, 
+															double 					dividendsToLastTradeDate	) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickEFP( tickerId, tickType, basisPoints, formattedBasisPoints, totalDividends, holdDays, futureLastTradeDate, dividendImpact, dividendsToLastTradeDate );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::orderStatus				( 		OrderId 				orderId, 
+															const std::string& 		status, 
+															double 					filled, 
+															double 					remaining, 
+															double 					avgFillPrice, 
+															int 					permId, 
+															int 					parentId, 
+															double 					lastFillPrice, 
+															int 					clientId, 
+															const std::string& 		whyHeld, 
+															double 					mktCapPrice				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->orderStatus( orderId, status, filled, remaining, avgFillPrice, permId, parentId, lastFillPrice, clientId, whyHeld, mktCapPrice );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::openOrder				( 		OrderId 				orderId, 
+															const Contract& 		contract, 
+															const Order& 			order, 
+															const OrderState& 		orderState				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->openOrder( orderId, contract, order, orderState );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::openOrderEnd			() 
+{ 
+
+	if( m_fallback )
+		m_fallback->openOrderEnd();
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::winError				( 		const std::string& 		str, 
+															int 					lastError				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->winError( str, lastError );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::connectionClosed		() 
+{ 
+
+	if( m_fallback )
+		m_fallback->connectionClosed();
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updateAccountValue		( 		const std::string& 		key, 
+															const std::string& 		val, 
+															const std::string& 		currency, 
+															const std::string& 		accountName				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->updateAccountValue( key, val, currency, accountName );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updatePortfolio			( 		const Contract& 		contract, 
+															double 					position, 
+															double 					marketPrice, 
+															double 					marketValue, 
+															double 					averageCost, 
+															double 					unrealizedPNL, 
+															double 					realizedPNL, 
+															const std::string& 		accountName				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->updatePortfolio( contract, position, marketPrice, marketValue, averageCost, unrealizedPNL, realizedPNL, accountName );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updateAccountTime		( 		const std::string& 		timeStamp				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->updateAccountTime( timeStamp );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::accountDownloadEnd		( 		const std::string& 		accountName				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->accountDownloadEnd( accountName );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::nextValidId				( 		OrderId 				orderId					) 
+{ 
+
+	if( m_fallback )
+		m_fallback->nextValidId( orderId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::contractDetails			( 		int 					reqId, 
+															const ContractDetails& 	contractDetails			) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->contractDetails( reqId, contractDetails );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::bondContractDetails		( 		int 					reqId, 
+															const ContractDetails& 	contractDetails			) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->bondContractDetails( reqId, contractDetails );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::contractDetailsEnd		( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->contractDetailsEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::execDetails				( 		int 					reqId, 
+															const Contract& 		contract, 
+															const Execution& 		execution				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->execDetails( reqId, contract, execution );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::execDetailsEnd			( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->execDetailsEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::error					( 		int 					id, 
+															int 					errorCode, 
+															const std::string& 		errorString				) 
+{ 
+
+	EWrapper* handler = route( id );
+
+	if( handler )
+		handler->error( id, errorCode, errorString );
+
+	// warnings, farm notifications and recoverable errors leave the request alive
+	if( terminatesRequest( errorCode ) )
+		releaseOneShot( id );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updateMktDepth			( 		TickerId 				id, 
+															int 					position, 
+															int 					operation, 
+															int 					side, 
+															double 					price, 
+															int 					size					) 
+{ 
+
+	EWrapper* handler = route( id );
+
+	if( handler )
+		handler->updateMktDepth( id, position, operation, side, price, size );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updateMktDepthL2		( 		TickerId 				id, 
+															int 					position, 
+															const std::string& 		marketMaker, 
+															int 					operation, 
+															int 					side, 
+															double 					price, 
+															int 					size, 
+															bool 					isSmartDepth			) 
+{ 
+
+	EWrapper* handler = route( id );
+
+	if( handler )
+		handler->updateMktDepthL2( id, position, marketMaker, operation, side, price, size, isSmartDepth );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::updateNewsBulletin		( 		int 					msgId, 
+															int 					msgType, 
+															const std::string& 		newsMessage, 
+															const std::string& 		originExch				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->updateNewsBulletin( msgId, msgType, newsMessage, originExch );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::managedAccounts			( 		const std::string& 		accountsList			) 
+{ 
+
+	if( m_fallback )
+		m_fallback->managedAccounts( accountsList );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::receiveFA				( 		faDataType 				pFaDataType, 
+															const std::string& 		cxml					) 
+{ 
+
+	if( m_fallback )
+		m_fallback->receiveFA( pFaDataType, cxml );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalData			( 		TickerId 				reqId, 
+															const Bar& 				bar						) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalData( reqId, bar );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalDataEnd		( 		int 					reqId, 
+															const std::string& 		startDateStr, 
+															const std::string& 		endDateStr				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalDataEnd( reqId, startDateStr, endDateStr );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::scannerParameters		( 		const std::string& 		xml						) 
+{ 
+
+	if( m_fallback )
+		m_fallback->scannerParameters( xml );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::scannerData				( 		int 					reqId, 
+															int 					rank, 
+															const ContractDetails& 	contractDetails, 
+															const std::string& 		distance, 
+															const std::string& 		benchmark, 
+															const std::string& 		projection, 
+															const std::string& 		legsStr					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->scannerData( reqId, rank, contractDetails, distance, benchmark, projection, legsStr );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::scannerDataEnd			( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->scannerDataEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::realtimeBar				( 		TickerId 				reqId, 
+															long 					time, 
+															double 					open, 
+															double 					high, 
+															double 					low, 
+															double 					close, 
+															long 					volume, 
+															double 					wap, 
+															int 					count					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->realtimeBar( reqId, time, open, high, low, close, volume, wap, count );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::currentTime				( 		long 					time					) 
+{ 
+
+	if( m_fallback )
+		m_fallback->currentTime( time );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::fundamentalData			( 		TickerId 				reqId, 
+															const std::string& 		data					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->fundamentalData( reqId, data );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::deltaNeutralValidation	( 		int 					reqId, 
+															const DeltaNeutralContract& 	deltaNeutralContract	) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->deltaNeutralValidation( reqId, deltaNeutralContract );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickSnapshotEnd			( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->tickSnapshotEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::marketDataType			( 		TickerId 				reqId, 
+															int 					marketDataType			) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->marketDataType( reqId, marketDataType );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::commissionReport		( 		const CommissionReport& 	commissionReport	) 
+{ 
+
+	if( m_fallback )
+		m_fallback->commissionReport( commissionReport );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::position				( 		const std::string& 		account, 
+															const Contract& 		contract, 
+															double 					position, 
+															double 					avgCost					) 
+{ 
+
+	if( m_fallback )
+		m_fallback->position( account, contract, position, avgCost );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::positionEnd				() 
+{ 
+
+	if( m_fallback )
+		m_fallback->positionEnd();
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::accountSummary			( 		int 					reqId, 
+															const std::string& 		account, 
+															const std::string& 		tag, 
+															const std::string& 		value, 
+															const std::string& 		curency					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->accountSummary( reqId, account, tag, value, curency );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::accountSummaryEnd		( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->accountSummaryEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::verifyMessageAPI		( 		const std::string& 		apiData					) 
+{ 
+
+	if( m_fallback )
+		m_fallback->verifyMessageAPI( apiData );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::verifyCompleted			( 		bool 					isSuccessful, 
+															const std::string& 		errorText				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->verifyCompleted( isSuccessful, errorText );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::displayGroupList		( 		int 					reqId, 
+															const std::string& 		groups					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->displayGroupList( reqId, groups );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::displayGroupUpdated		( 		int 					reqId, 
+															const std::string& 		contractInfo			) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->displayGroupUpdated( reqId, contractInfo );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::verifyAndAuthMessageAPI	( 		const std::string& 		apiData, 
+															const std::string& 		xyzChallange			) 
+{ 
+
+	if( m_fallback )
+		m_fallback->verifyAndAuthMessageAPI( apiData, xyzChallange );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::verifyAndAuthCompleted	( 		bool 					isSuccessful, 
+															const std::string& 		errorText				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->verifyAndAuthCompleted( isSuccessful, errorText );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::connectAck				() 
+{ 
+
+	if( m_fallback )
+		m_fallback->connectAck();
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::positionMulti			( 		int 					reqId, 
+															const std::string& 		account, 
+															const std::string& 		modelCode, 
+															const Contract& 		contract, 
+															double 					pos, 
+															double 					avgCost					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->positionMulti( reqId, account, modelCode, contract, pos, avgCost );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::positionMultiEnd		( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->positionMultiEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::accountUpdateMulti		( 		int 					reqId, 
+															const std::string& 		account, 
+															const std::string& 		modelCode, 
+															const std::string& 		key, 
+															const std::string& 		value, 
+															const std::string& 		currency				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->accountUpdateMulti( reqId, account, modelCode, key, value, currency );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::accountUpdateMultiEnd	( 		int 					reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->accountUpdateMultiEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::securityDefinitionOptionalParameter	( 		int 		reqId, 
+															const std::string& 		exchange, 
+															int 					underlyingConId, 
+															const std::string& 		tradingClass, 
+															const std::string& 		multiplier, 
+															const std::set<std::string>& 	expirations, 
+															const std::set<double>& 	strikes				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->securityDefinitionOptionalParameter( reqId, exchange, underlyingConId, tradingClass, multiplier, expirations, strikes );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::securityDefinitionOptionalParameterEnd	( 		int 	reqId					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->securityDefinitionOptionalParameterEnd( reqId );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::softDollarTiers			( 		int 					reqId, 
+															const std::vector<SoftDollarTier>& 	tiers		) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->softDollarTiers( reqId, tiers );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::familyCodes				( 		const std::vector<FamilyCode>& 	familyCodes		) 
+{ 
+
+	if( m_fallback )
+		m_fallback->familyCodes( familyCodes );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::symbolSamples			( 		int 					reqId, 
+															const std::vector<ContractDescription>& 	contractDescriptions	) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->symbolSamples( reqId, contractDescriptions );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::mktDepthExchanges		( 		const std::vector<DepthMktDataDescription>& 	depthMktDataDescriptions	) 
+{ 
+
+	if( m_fallback )
+		m_fallback->mktDepthExchanges( depthMktDataDescriptions );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickNews				( 		int 					tickerId, 
+															time_t 					timeStamp, 
+															const std::string& 		providerCode, 
+															const std::string& 		articleId, 
+															const std::string& 		headline, 
+															const std::string& 		extraData				) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickNews( tickerId, timeStamp, providerCode, articleId, headline, extraData );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::smartComponents			( 		int 					reqId, 
+															const SmartComponentsMap& 	theMap				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->smartComponents( reqId, theMap );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickReqParams			( 		int 					tickerId, 
+															double 					minTick, 
+															const std::string& 		bboExchange, 
+															int 					snapshotPermissions		) 
+{ 
+
+	EWrapper* handler = route( tickerId );
+
+	if( handler )
+		handler->tickReqParams( tickerId, minTick, bboExchange, snapshotPermissions );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::newsProviders			( 		const std::vector<NewsProvider>& 	newsProviders	) 
+{ 
+
+	if( m_fallback )
+		m_fallback->newsProviders( newsProviders );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::newsArticle				( 		int 					requestId, 
+															int 					articleType, 
+															const std::string& 		articleText				) 
+{ 
+
+	EWrapper* handler = route( requestId );
+
+	if( handler )
+		handler->newsArticle( requestId, articleType, articleText );
+
+	releaseOneShot( requestId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalNews			( 		int 					requestId, 
+															const std::string& 		time, 
+															const std::string& 		providerCode, 
+															const std::string& 		articleId, 
+															const std::string& 		headline				) 
+{ 
+
+	EWrapper* handler = route( requestId );
+
+	if( handler )
+		handler->historicalNews( requestId, time, providerCode, articleId, headline );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalNewsEnd		( 		int 					requestId, 
+															bool 					hasMore					) 
+{ 
+
+	EWrapper* handler = route( requestId );
+
+	if( handler )
+		handler->historicalNewsEnd( requestId, hasMore );
+
+	releaseOneShot( requestId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::headTimestamp			( 		int 					reqId, 
+															const std::string& 		headTimestamp			) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->headTimestamp( reqId, headTimestamp );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::histogramData			( 		int 					reqId, 
+															const HistogramDataVector& 	data				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->histogramData( reqId, data );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalDataUpdate	( 		TickerId 				reqId, 
+															const Bar& 				bar						) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalDataUpdate( reqId, bar );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::rerouteMktDataReq		( 		int 					reqId, 
+															int 					conid, 
+															const std::string& 		exchange				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->rerouteMktDataReq( reqId, conid, exchange );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::rerouteMktDepthReq		( 		int 					reqId, 
+															int 					conid, 
+															const std::string& 		exchange				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->rerouteMktDepthReq( reqId, conid, exchange );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::marketRule				( 		int 					marketRuleId, 
+															const std::vector<PriceIncrement>& 	priceIncrements	) 
+{ 
+
+	if( m_fallback )
+		m_fallback->marketRule( marketRuleId, priceIncrements );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::pnl						( 		int 					reqId, 
+															double 					dailyPnL, 
+															double 					unrealizedPnL, 
+															double 					realizedPnL				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->pnl( reqId, dailyPnL, unrealizedPnL, realizedPnL );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::pnlSingle				( 		int 					reqId, 
+															int 					pos, 
+															double 					dailyPnL, 
+															double 					unrealizedPnL, 
+															double 					realizedPnL, 
+															double 					value					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->pnlSingle( reqId, pos, dailyPnL, unrealizedPnL, realizedPnL, value );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalTicks			( 		int 					reqId, 
+															const std::vector<HistoricalTick>& 	ticks, 
+															bool 					done					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalTicks( reqId, ticks, done );
+
+	if( done )
+		releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalTicksBidAsk	( 		int 					reqId, 
+															const std::vector<HistoricalTickBidAsk>& 	ticks, 
+															bool 					done					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalTicksBidAsk( reqId, ticks, done );
+
+	if( done )
+		releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::historicalTicksLast		( 		int 					reqId, 
+															const std::vector<HistoricalTickLast>& 	ticks, 
+															bool 					done					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->historicalTicksLast( reqId, ticks, done );
+
+	if( done )
+		releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickByTickAllLast		( 		int 					reqId, 
+															int 					tickType, 
+															time_t 					time, 
+															double 					price, 
+															int 					size, 
+															const TickAttribLast& 	tickAttribLast, 
+															const std::string& 		exchange, 
+															const std::string& 		specialConditions		) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->tickByTickAllLast( reqId, tickType, time, price, size, tickAttribLast, exchange, specialConditions );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickByTickBidAsk		( 		int 					reqId, 
+															time_t 					time, 
+															double 					bidPrice, 
+															double 					askPrice, 
+															int 					bidSize, 
+															int 					askSize, 
+															const TickAttribBidAsk& 	tickAttribBidAsk	) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->tickByTickBidAsk( reqId, time, bidPrice, askPrice, bidSize, askSize, tickAttribBidAsk );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::tickByTickMidPoint		( 		int 					reqId, 
+															time_t 					time, 
+															double 					midPoint				) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->tickByTickMidPoint( reqId, time, midPoint );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::orderBound				( 		long long 				orderId, 
+															int 					apiClientId, 
+															int 					apiOrderId				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->orderBound( orderId, apiClientId, apiOrderId );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::completedOrder			( 		const Contract& 		contract, 
+															const Order& 			order, 
+															const OrderState& 		orderState				) 
+{ 
+
+	if( m_fallback )
+		m_fallback->completedOrder( contract, order, orderState );
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::completedOrdersEnd		() 
+{ 
+
+	if( m_fallback )
+		m_fallback->completedOrdersEnd();
+
+}
+
+//*******************************************************************************************************************
+
+void 		ERequestRouter::replaceFAEnd			( 		int 					reqId, 
+															const std::string& 		text					) 
+{ 
+
+	EWrapper* handler = route( reqId );
+
+	if( handler )
+		handler->replaceFAEnd( reqId, text );
+
+	releaseOneShot( reqId );
+
+}
+
+//*******************************************************************************************************************
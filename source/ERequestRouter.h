@@ -0,0 +1,100 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_EREQUESTROUTER_H
+#define TWS_API_CLIENT_EREQUESTROUTER_H
+
+#include <atomic>
+#include <memory>
+#include "EWrapper.h"
+
+
+
+//******************************************************************************************
+
+enum ERouteKind 
+{
+
+    ROUTE_ONE_SHOT,         // released by the matching *End / single reply callback ( or a request-ending error )
+    ROUTE_SUBSCRIPTION      // stays until release(), i.e. when the request is cancelled
+
+};
+
+//******************************************************************************************
+// EWrapper that dispatches reqId / tickerId keyed callbacks to the handler that owns
+// the request. Pass it to EClientSocket / EReader in place of the application wrapper;
+// callbacks without an id ( orderStatus, openOrder, nextValidId, positions, ... ) and
+// ids nobody owns go to the fallback wrapper.
+//
+// reqIds come from allocate(), a lock free counter, and map straight onto a power of
+// two table so lookup is one index + one compare. An id whose slot is still held by a
+// long running subscription is skipped, so the table never needs probing.
+//
+// allocate() / release() may be called from any thread, the callbacks run on the
+// thread calling EReader::processMsgs. A handler has to outlive its entry; after
+// release() it may still see callbacks already being dispatched.
+//
+// error() is routed by id as well, so keep firstReqId clear of the order id range.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ERequestRouter : public EWrapper
+{
+
+    static const int    FREE_SLOT       = -1;
+    static const int    CLAIMED_SLOT    = -2;
+
+    struct Slot 
+    {
+        std::atomic< int >          reqId;      // FREE_SLOT, CLAIMED_SLOT or the owning reqId
+        std::atomic< EWrapper* >    handler;
+        std::atomic< int >          kind;
+    };
+
+    EWrapper*                       m_fallback;
+
+    std::unique_ptr< Slot[] >       m_slots;
+    size_t                          m_capacity;
+    size_t                          m_mask;
+
+    std::atomic< int >              m_nextReqId;
+    std::atomic< size_t >           m_active;
+
+
+    EWrapper*           route               (       int             reqId                           ) const;
+    void                releaseOneShot      (       int             reqId                           );
+
+public:
+
+    static const size_t DEFAULT_CAPACITY = 4096;
+
+    explicit ERequestRouter(        EWrapper*       fallback, 
+                                    int             firstReqId  = 1, 
+                                    size_t          capacity    = DEFAULT_CAPACITY  );
+
+    // reserves a reqId for 'handler', -1 if every slot is taken
+    int                 allocate            (       EWrapper*       handler, 
+                                                    ERouteKind      kind = ROUTE_ONE_SHOT           );
+
+    // drops the entry, call it together with the cancel request. false if reqId was not live
+    bool                release             (       int             reqId                           );
+
+    // handler owning reqId, 0 if none
+    EWrapper*           handler             (       int             reqId                           ) const;
+
+    void                setFallback         (       EWrapper*       fallback                        ) { m_fallback = fallback; }
+    EWrapper*           fallback            (                                                       ) const { return m_fallback; }
+
+    size_t              active              (                                                       ) const;
+    size_t              capacity            (                                                       ) const { return m_capacity; }
+
+    // true for TWS error codes after which the request with that id is gone
+    static bool         terminatesRequest   (       int             errorCode                       );
+
+    #include "EWrapper_prototypes.h"
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,279 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EScannerTracker.h"
+
+
+//***************************************************************************************************
+
+EScannerTracker::EScannerTracker(   EScannerListener*   listener    )
+
+    : m_pListener   ( listener )
+
+{
+}
+
+//***************************************************************************************************
+
+int EScannerTracker::findSlot(  const Scan&     scan, 
+                                long            conId, 
+                                int             rank        ) const
+{
+
+    if( rank >= 0 && rank < ( int )scan.byRank.size() ) 
+    {
+
+        int hint = scan.byRank[ rank ];
+
+        if( hint >= 0 && scan.conIds[ hint ] == conId )
+            return hint;
+
+    }
+
+    for( size_t i = 0; i < scan.conIds.size(); ++i ) 
+    {
+
+        if( scan.conIds[ i ] == conId )
+            return ( int )i;
+
+    }
+
+    return -1;
+
+}
+
+//***************************************************************************************************
+
+void EScannerTracker::scannerData(  int                     reqId, 
+                                    int                     rank, 
+                                    const ContractDetails&  details, 
+                                    const std::string&      distance, 
+                                    const std::string&      benchmark, 
+                                    const std::string&      projection, 
+                                    const std::string&      legsStr     )
+{
+
+    std::map< int, Scan >::iterator it = m_scans.find( reqId );
+
+    if( it == m_scans.end() )
+        return;
+
+    Scan& scan = it->second;
+
+    if( !scan.open ) 
+    {
+
+        // first row of a refresh
+        ++scan.generation;
+        scan.open = true;
+        scan.current.clear();
+
+    }
+
+    long conId = details.contract.conId;
+    int  slot  = findSlot( scan, conId, rank );
+
+    if( slot >= 0 && scan.seen[ slot ] == scan.generation )
+        return;     // listed twice in one refresh: keep the first
+
+    if( slot < 0 ) 
+    {
+
+        if( !scan.freeSlots.empty() ) 
+        {
+            slot = scan.freeSlots.back();
+            scan.freeSlots.pop_back();
+        }
+        else 
+        {
+            slot = ( int )scan.rows.size();
+            scan.rows.push_back( EScannerRow() );
+            scan.conIds.push_back( 0 );
+            scan.seen.push_back( 0 );
+        }
+
+        // assignment into a recycled row reuses its buffers
+        scan.rows[ slot ].details       = details;
+        scan.rows[ slot ].previousRank  = -1;
+        scan.conIds[ slot ]             = conId;
+
+    }
+    else 
+    {
+
+        scan.rows[ slot ].previousRank  = scan.rows[ slot ].rank;
+
+    }
+
+    EScannerRow& row = scan.rows[ slot ];
+
+    row.rank = rank;
+    row.distance    = distance;
+    row.benchmark   = benchmark;
+    row.projection  = projection;
+    row.legsStr     = legsStr;
+
+    scan.seen[ slot ] = scan.generation;
+    scan.current.push_back( slot );
+
+}
+
+//***************************************************************************************************
+
+void EScannerTracker::scannerDataEnd(   int     reqId   )
+{
+
+    m_changes.clear();
+
+    std::map< int, Scan >::iterator it = m_scans.find( reqId );
+
+    if( it == m_scans.end() )
+        return;
+
+    Scan& scan = it->second;
+
+    // an empty refresh sends no rows: everything left
+    if( !scan.open ) 
+    {
+        ++scan.generation;
+        scan.current.clear();
+    }
+
+    scan.open = false;
+
+    size_t removed = 0;
+
+    for( size_t slot = 0; slot < scan.conIds.size(); ++slot ) 
+    {
+
+        if( scan.conIds[ slot ] == 0 || scan.seen[ slot ] == scan.generation )
+            continue;
+
+        EScannerChange change;
+
+        change.kind         = SCAN_REMOVED;
+        change.rank         = scan.rows[ slot ].rank;
+        change.previousRank = scan.rows[ slot ].rank;
+        change.row          = &scan.rows[ slot ];
+
+        m_changes.push_back( change );
+        ++removed;
+
+    }
+
+    int maxRank = -1;
+
+    for( size_t i = 0; i < scan.current.size(); ++i ) 
+    {
+
+        const EScannerRow& row = scan.rows[ scan.current[ i ] ];
+
+        if( row.rank > maxRank )
+            maxRank = row.rank;
+
+        if( row.previousRank == row.rank )
+            continue;
+
+        EScannerChange change;
+
+        change.kind         = row.previousRank < 0 ? SCAN_ADDED : SCAN_MOVED;
+        change.rank         = row.rank;
+        change.previousRank = row.previousRank;
+        change.row          = &row;
+
+        m_changes.push_back( change );
+
+    }
+
+    if( m_pListener && !m_changes.empty() )
+        m_pListener->onScannerChanges( reqId, &m_changes[ 0 ], m_changes.size() );
+
+    // free the departed after the listener has seen them; their buffers stay for reuse
+    for( size_t i = 0; i < removed; ++i ) 
+    {
+
+        int slot = ( int )( m_changes[ i ].row - &scan.rows[ 0 ] );
+
+        scan.conIds[ slot ] = 0;
+        scan.freeSlots.push_back( slot );
+
+    }
+
+    scan.byRank.assign( maxRank + 1, -1 );
+
+    for( size_t i = 0; i < scan.current.size(); ++i ) 
+    {
+
+        int slot = scan.current[ i ];
+
+        if( scan.rows[ slot ].rank >= 0 )
+            scan.byRank[ scan.rows[ slot ].rank ] = slot;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EScannerTracker::track(    int     reqId   )
+{
+
+    // a reused reqId starts over
+    m_scans[ reqId ] = Scan();
+
+}
+
+//***************************************************************************************************
+
+void EScannerTracker::forget(   int     reqId   )
+{
+
+    m_scans.erase( reqId );
+
+}
+
+//***************************************************************************************************
+
+size_t EScannerTracker::size(   int     reqId   ) const
+{
+
+    std::map< int, Scan >::const_iterator it = m_scans.find( reqId );
+
+    return it == m_scans.end() ? 0 : it->second.conIds.size() - it->second.freeSlots.size();
+
+}
+
+//***************************************************************************************************
+
+const EScannerRow* EScannerTracker::ranked(     int     reqId, 
+                                                int     rank        ) const
+{
+
+    std::map< int, Scan >::const_iterator it = m_scans.find( reqId );
+
+    if( it == m_scans.end() || rank < 0 || rank >= ( int )it->second.byRank.size() )
+        return 0;
+
+    int slot = it->second.byRank[ rank ];
+
+    return slot >= 0 ? &it->second.rows[ slot ] : 0;
+
+}
+
+//***************************************************************************************************
+
+const EScannerRow* EScannerTracker::find(   int     reqId, 
+                                            long    conId       ) const
+{
+
+    std::map< int, Scan >::const_iterator it = m_scans.find( reqId );
+
+    if( it == m_scans.end() || conId == 0 )
+        return 0;
+
+    int slot = findSlot( it->second, conId, -1 );
+
+    return slot >= 0 ? &it->second.rows[ slot ] : 0;
+
+}
@@ -0,0 +1,149 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESCANNERTRACKER_H
+#define TWS_API_CLIENT_ESCANNERTRACKER_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "Contract.h"
+
+
+
+//******************************************************************************************
+
+struct EScannerRow 
+{
+
+    ContractDetails     details;        // copied once, when the contract enters the scan
+    int                 rank;
+    int                 previousRank;   // -1: new in the last refresh
+    std::string         distance;
+    std::string         benchmark;
+    std::string         projection;
+    std::string         legsStr;
+
+};
+
+//******************************************************************************************
+
+enum EScannerChangeKind 
+{
+
+    SCAN_ADDED,
+    SCAN_REMOVED,       // rank: the last one the row had
+    SCAN_MOVED
+
+};
+
+//******************************************************************************************
+
+struct EScannerChange 
+{
+
+    EScannerChangeKind  kind;
+    int                 rank;
+    int                 previousRank;
+    const EScannerRow*  row;            // see lastChanges()
+
+};
+
+//******************************************************************************************
+// receives what one refresh of a scanner changed: removals first, then entries and
+// moves by new rank. Nothing for a refresh that changed no rank
+
+struct EScannerListener 
+{
+
+    virtual void    onScannerChanges(       int                     reqId, 
+                                            const EScannerChange*   changes, 
+                                            size_t                  count   ) = 0;
+
+    virtual        ~EScannerListener() {}
+
+};
+
+//******************************************************************************************
+// turns the full ranked list every scanner refresh delivers ( scannerData per row, then
+// scannerDataEnd ) into the rows that entered, left or changed rank.
+//
+// Rows are keyed by conId in slots that are recycled, ContractDetails included, so a
+// contract already in the scan costs a comparison and no copy, and one replacing a
+// departed contract reuses the string buffers of the old. A row is first looked for at
+// the slot that held its rank in the previous refresh, which is where it usually is;
+// scans are 50 rows, a linear search of the contiguous conIds covers the rest.
+//
+// Only scanners passed to track() are kept: rows still in flight after forget() are
+// ignored instead of bringing the scan back. Not thread safe: feed it from the EWrapper
+// callbacks.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EScannerTracker
+{
+
+    struct Scan 
+    {
+        std::vector< EScannerRow >      rows;           // slots
+        std::vector< long >             conIds;         // per slot, 0: free
+        std::vector< unsigned >         seen;           // per slot, generation of the last refresh listing it
+        std::vector< int >              freeSlots;
+        std::vector< int >              byRank;         // rank -> slot, previous refresh
+        std::vector< int >              current;        // slots in the order of this refresh
+        unsigned                        generation;
+        bool                            open;           // rows received, no scannerDataEnd yet
+
+        Scan() : generation( 0 ), open( false ) {}
+    };
+
+    EScannerListener*                   m_pListener;
+    std::map< int, Scan >               m_scans;
+    std::vector< EScannerChange >       m_changes;      // reused by every refresh
+
+
+    int                 findSlot            (       const Scan&     scan, 
+                                                    long            conId, 
+                                                    int             rank                            ) const;
+
+public:
+
+    explicit EScannerTracker(                       EScannerListener*   listener    = 0             );
+
+    void                setListener         (       EScannerListener*   listener                    ) { m_pListener = listener;  }
+
+    // with reqScannerSubscription
+    void                track               (       int                     reqId                   );
+
+    // the two EWrapper callbacks, ignored for scanners not tracked
+    void                scannerData         (       int                     reqId, 
+                                                    int                     rank, 
+                                                    const ContractDetails&  details, 
+                                                    const std::string&      distance, 
+                                                    const std::string&      benchmark, 
+                                                    const std::string&      projection, 
+                                                    const std::string&      legsStr                 );
+    void                scannerDataEnd      (       int                     reqId                   );
+
+    // after cancelScannerSubscription
+    void                forget              (       int                     reqId                   );
+
+    // scanners tracked and not forgotten yet
+    size_t              tracked             (                                                       ) const { return m_scans.size(); }
+
+    // rows of the last complete refresh
+    size_t              size                (       int                     reqId                   ) const;
+    const EScannerRow*  ranked              (       int                     reqId, 
+                                                    int                     rank                    ) const;
+    const EScannerRow*  find                (       int                     reqId, 
+                                                    long                    conId                   ) const;
+
+    // what the last scannerDataEnd reported, rows valid until that scanner's next row
+    const std::vector< EScannerChange >&    lastChanges (                                           ) const { return m_changes; }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,261 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ESession.h"
+#include "EClientSocket.h"
+#include "EReader.h"
+#include "EReaderSignal.h"
+
+#include <algorithm>
+#include <thread>
+
+
+
+//***************************************************************************************************
+
+ESession::ESession(         EClientSocket*      client, 
+                            EReaderSignal*      signal              )
+
+    : m_pClient             (   client                          )
+    , m_pSignal             (   signal                          )
+    , m_port                (   0                               )
+    , m_clientId            (   0                               )
+    , m_extraAuth           (   false                           )
+    , m_state               (   SESSION_IDLE                    )
+    , m_backoffInitialMs    (   DEFAULT_BACKOFF_INITIAL_MS      )
+    , m_backoffMaxMs        (   DEFAULT_BACKOFF_MAX_MS          )
+    , m_jitter              (   0.5                             )
+    , m_maxAttempts         (   0                               )
+    , m_attempt             (   0                               )
+    , m_reconnects          (   0                               )
+    , m_replayed            (   0                               )
+    , m_lastGapMs           (   0                               )
+    , m_rng                 (   std::random_device()()          )
+{
+}
+
+//***************************************************************************************************
+
+ESession::~ESession()
+{
+
+    // the reader thread has to stop before the session ( and the journal ) goes away
+    m_pReader.reset();
+
+}
+
+//***************************************************************************************************
+
+void ESession::setBackoff(          int         initialMs, 
+                                    int         maxMs, 
+                                    double      jitter          )
+{
+
+    m_backoffInitialMs  = ( std::max )( initialMs, 1 );
+    m_backoffMaxMs      = ( std::max )( maxMs, m_backoffInitialMs );
+    m_jitter            = ( std::min )( ( std::max )( jitter, 0.0 ), 1.0 );
+
+}
+
+//***************************************************************************************************
+
+void ESession::setMaxAttempts( unsigned attempts )
+{
+
+    m_maxAttempts = attempts;
+
+}
+
+//***************************************************************************************************
+
+bool ESession::connect(             const char*     host, 
+                                    int             port, 
+                                    int             clientId, 
+                                    bool            extraAuth       )
+{
+
+    m_host          = ( host && *host ) ? host : "127.0.0.1";
+    m_port          = port;
+    m_clientId      = clientId;
+    m_extraAuth     = extraAuth;
+
+    m_attempt       = 0;
+
+    m_pClient->setRequestJournal( &m_journal );
+
+    if( open() ) 
+    {
+
+        m_state = SESSION_CONNECTED;
+
+        return true;
+
+    }
+
+    m_lostAt = Clock::now();
+
+    scheduleRetry();
+
+    return false;
+
+}
+
+//***************************************************************************************************
+
+void ESession::disconnect()
+{
+
+    m_pReader.reset();
+
+    m_pClient->eDisconnect();
+    m_pClient->setRequestJournal( 0 );
+
+    m_journal.clear();
+
+    m_state = SESSION_IDLE;
+
+}
+
+//***************************************************************************************************
+
+bool ESession::open()
+{
+
+    // the old reader thread exits once its socket is gone; join it before dialing again
+    m_pReader.reset();
+
+    if( !m_pClient->eConnect(       m_host.c_str(), 
+                                    m_port, 
+                                    m_clientId, 
+                                    m_extraAuth             ) )
+        return false;
+
+    m_pReader.reset( new EReader( m_pClient, m_pSignal ) );
+    m_pReader->start();
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+int ESession::backoffMs( unsigned attempt )
+{
+
+    // initial * 2^attempt capped at max, then up to 'jitter' of it taken off at random so
+    // clients dropped by the same gateway restart do not all come back in lock step
+    double delay = m_backoffInitialMs;
+
+    for( unsigned i = 0; i < attempt && delay < m_backoffMaxMs; ++i )
+        delay *= 2;
+
+    delay = ( std::min )( delay, (double)m_backoffMaxMs );
+
+    std::uniform_real_distribution< double > unit( 0.0, 1.0 );
+
+    return (int)( delay * ( 1.0 - m_jitter * unit( m_rng ) ) );
+
+}
+
+//***************************************************************************************************
+
+void ESession::scheduleRetry()
+{
+
+    if( m_maxAttempts > 0 && m_attempt >= m_maxAttempts ) 
+    {
+
+        m_pReader.reset();
+        m_pClient->setRequestJournal( 0 );
+
+        m_state = SESSION_FAILED;
+
+        return;
+
+    }
+
+    m_nextAttempt   = Clock::now() + std::chrono::milliseconds( backoffMs( m_attempt ) );
+    m_state         = SESSION_BACKOFF;
+
+}
+
+//***************************************************************************************************
+
+void ESession::processMsgs()
+{
+
+    if( m_state == SESSION_CONNECTED ) 
+    {
+
+        m_pReader->processMsgs();
+
+        if( m_pClient->isConnected() )
+            return;
+
+        // link lost: the reader thread is on its way out, the journal still holds every
+        // standing request
+        m_lostAt    = Clock::now();
+        m_attempt   = 0;
+
+        scheduleRetry();
+
+        return;
+
+    }
+
+    if( m_state != SESSION_BACKOFF )
+        return;
+
+    Clock::time_point now = Clock::now();
+
+    if( now < m_nextAttempt ) 
+    {
+
+        std::this_thread::sleep_for( ( std::min )(      std::chrono::duration_cast< std::chrono::milliseconds >( m_nextAttempt - now ), 
+                                                        std::chrono::milliseconds( 100 )        ) );
+
+        if( Clock::now() < m_nextAttempt )
+            return;
+
+    }
+
+    if( !open() ) 
+    {
+
+        ++m_attempt;
+
+        scheduleRetry();
+
+        return;
+
+    }
+
+    m_state = SESSION_CONNECTED;
+
+    ++m_reconnects;
+
+    m_replayed  = m_pClient->replayRequestJournal();
+    m_lastGapMs = std::chrono::duration< double, std::milli >( Clock::now() - m_lostAt ).count();
+
+}
+
+//***************************************************************************************************
+
+bool ESession::connected() const
+{
+
+    return m_state == SESSION_CONNECTED && m_pClient->isConnected();
+
+}
+
+//***************************************************************************************************
+
+bool ESession::alive() const
+{
+
+    return m_state == SESSION_CONNECTED || m_state == SESSION_BACKOFF;
+
+}
+
+//***************************************************************************************************
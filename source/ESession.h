@@ -0,0 +1,124 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESESSION_H
+#define TWS_API_CLIENT_ESESSION_H
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include "platformspecific.h"
+#include "ERequestJournal.h"
+
+
+class  EClientSocket;
+class  EReader;
+struct EReaderSignal;
+
+
+//******************************************************************************************
+
+enum ESessionState 
+{
+
+    SESSION_IDLE,           // never connected or disconnect() called
+    SESSION_CONNECTED,
+    SESSION_BACKOFF,        // link lost, waiting for the next reconnect attempt
+    SESSION_FAILED          // gave up after setMaxAttempts() consecutive failures
+
+};
+
+//******************************************************************************************
+// keeps one EClientSocket connected: owns its EReader, records the standing requests
+// sent through the client ( ERequestJournal ) and, when the link drops, reconnects with
+// jittered exponential backoff and replays them through the paced send path.
+//
+// Drive it from the thread that used to call EReader::processMsgs. The client must
+// outlive the session, or disconnect() must be called before the client goes away.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ESession
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    EClientSocket*                      m_pClient;
+    EReaderSignal*                      m_pSignal;
+    std::unique_ptr< EReader >          m_pReader;
+
+    ERequestJournal                     m_journal;
+
+    std::string                         m_host;
+    int                                 m_port;
+    int                                 m_clientId;
+    bool                                m_extraAuth;
+
+    ESessionState                       m_state;
+
+    int                                 m_backoffInitialMs;
+    int                                 m_backoffMaxMs;
+    double                              m_jitter;           // 0..1, share of the delay that is randomized
+    unsigned                            m_maxAttempts;      // 0 retries forever
+
+    unsigned                            m_attempt;          // consecutive failed attempts
+    unsigned                            m_reconnects;
+    int                                 m_replayed;         // requests re-sent by the last reconnect
+    double                              m_lastGapMs;        // link lost -> requests replayed
+
+    Clock::time_point                   m_lostAt;
+    Clock::time_point                   m_nextAttempt;
+
+    std::mt19937                        m_rng;
+
+
+    bool                open                (                                                       );
+    void                scheduleRetry       (                                                       );
+    int                 backoffMs           (       unsigned        attempt                         );
+
+public:
+
+    static const int    DEFAULT_BACKOFF_INITIAL_MS  = 250;
+    static const int    DEFAULT_BACKOFF_MAX_MS      = 30000;
+
+    ESession(       EClientSocket*      client, 
+                    EReaderSignal*      signal              );
+
+   ~ESession();
+
+    void                setBackoff          (       int             initialMs, 
+                                                    int             maxMs, 
+                                                    double          jitter      = 0.5               );
+
+    void                setMaxAttempts      (       unsigned        attempts                        );
+
+    // first connect; on failure the session keeps retrying from processMsgs()
+    bool                connect             (       const char*     host, 
+                                                    int             port, 
+                                                    int             clientId    = 0, 
+                                                    bool            extraAuth   = false             );
+
+    // closes the link for good: no reconnect, journal cleared
+    void                disconnect          (                                                       );
+
+    // dispatches queued messages while connected; while the link is down sleeps ( at most
+    // 100ms per call ) until the next attempt is due, reconnects and replays the journal
+    void                processMsgs         (                                                       );
+
+    bool                connected           (                                                       ) const;
+    bool                alive               (                                                       ) const;    // connected or retrying
+    ESessionState       state               (                                                       ) const { return m_state;       }
+
+    unsigned            reconnects          (                                                       ) const { return m_reconnects;  }
+    int                 lastReplayed        (                                                       ) const { return m_replayed;    }
+    double              lastGapMs           (                                                       ) const { return m_lastGapMs;   }
+
+    ERequestJournal&    journal             (                                                       )       { return m_journal;     }
+    EClientSocket*      client              (                                                       ) const { return m_pClient;     }
+
+};
+
+//******************************************************************************************
+
+#endif
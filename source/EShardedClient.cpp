@@ -0,0 +1,594 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EShardedClient.h"
+#include "EClientSocket.h"
+#include "EReader.h"
+#include "ERequestRouter.h"
+#include "Contract.h"
+#include "TwsSocketClientErrors.h"
+
+#include <algorithm>
+#include <sstream>
+
+
+using namespace ibapi::client_constants;
+
+
+//***************************************************************************************************
+// per shard wrapper: an ERequestRouter without entries forwards every callback to its
+// fallback, the merged application wrapper; only the account level callbacks of the
+// secondary connections are held back so the application sees them once
+//***************************************************************************************************
+
+class EShardedClient::Shard : public ERequestRouter
+{
+
+    EShardedClient*             m_pOwner;
+    size_t                      m_index;
+
+public:
+
+    EClientSocket               m_client;
+    std::unique_ptr< EReader >  m_pReader;
+    size_t                      m_lines;
+
+    Shard(          EShardedClient*     owner, 
+                    size_t              index, 
+                    EWrapper*           wrapper, 
+                    EReaderSignal*      signal          )
+
+        : ERequestRouter    (   wrapper, 1, 1       )
+        , m_pOwner          (   owner               )
+        , m_index           (   index               )
+        , m_client          (   this, signal        )
+        , m_lines           (   0                   )
+    {
+    }
+
+    ~Shard()
+    {
+        // the reader thread uses the client, stop it first
+        m_pReader.reset();
+    }
+
+    void nextValidId( OrderId orderId )
+    {
+        if( m_index == 0 )
+            ERequestRouter::nextValidId( orderId );
+    }
+
+    void managedAccounts( const std::string& accountsList )
+    {
+        if( m_index == 0 )
+            ERequestRouter::managedAccounts( accountsList );
+    }
+
+    void connectAck()
+    {
+        if( m_index == 0 )
+            ERequestRouter::connectAck();
+    }
+
+    void error(     int                 id, 
+                    int                 errorCode, 
+                    const std::string&  errorString     )
+    {
+        // farm status notices ( 2100 - 2199 ) arrive on every connection
+        if( m_index != 0 && id == NO_VALID_ID && errorCode >= 2100 && errorCode < 2200 )
+            return;
+
+        ERequestRouter::error( id, errorCode, errorString );
+
+        // a request that failed gets no end or cancel: release it here
+        if( id != NO_VALID_ID && terminatesRequest( errorCode ) )
+            m_pOwner->failed( m_index, id );
+    }
+
+    void historicalDataEnd(     int                 reqId, 
+                                const std::string&  startDateStr, 
+                                const std::string&  endDateStr      )
+    {
+        ERequestRouter::historicalDataEnd( reqId, startDateStr, endDateStr );
+
+        m_pOwner->completed( reqId );
+    }
+
+};
+
+//***************************************************************************************************
+
+namespace 
+{
+
+    unsigned long long hashBytes( const std::string& s )
+    {
+
+        // FNV-1a followed by a splitmix64 finalizer, FNV alone clusters short keys
+        unsigned long long h = 1469598103934665603ULL;
+
+        for( size_t i = 0; i < s.size(); ++i ) 
+        {
+            h ^= (unsigned char)s[ i ];
+            h *= 1099511628211ULL;
+        }
+
+        h ^= h >> 30;   h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;   h *= 0x94d049bb133111ebULL;
+        h ^= h >> 31;
+
+        return h;
+
+    }
+
+    std::string instrumentKey( const Contract& contract )
+    {
+
+        std::stringstream key;
+
+        if( contract.conId != 0 )
+            key << 'c' << contract.conId;
+        else
+            key << contract.symbol << '|' << contract.secType << '|' << contract.lastTradeDateOrContractMonth << '|' 
+                << contract.strike << '|' << contract.right << '|' << contract.multiplier << '|' 
+                << contract.currency << '|' << contract.localSymbol;
+
+        return key.str();
+
+    }
+
+}
+
+//***************************************************************************************************
+
+EShardedClient::EShardedClient(         EWrapper*       wrapper, 
+                                        size_t          shards, 
+                                        unsigned        virtualNodes        )
+
+    : m_pWrapper    (   wrapper     )
+    , m_signal      (   2000        )
+{
+
+    shards = ( std::max )( shards, (size_t)1 );
+
+    for( size_t i = 0; i < shards; ++i ) 
+    {
+
+        m_shards.push_back( std::unique_ptr< Shard >( new Shard( this, i, wrapper, &m_signal ) ) );
+
+        // TWS paces each client connection on its own, so sharding also multiplies the request rate
+        m_shards.back()->m_client.setPacing( EPacer::DEFAULT_RATE, EPacer::DEFAULT_BURST );
+
+    }
+
+    buildRing( ( std::max )( virtualNodes, 1u ) );
+
+}
+
+//***************************************************************************************************
+
+EShardedClient::~EShardedClient()
+{
+
+    disconnect();
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::buildRing( unsigned virtualNodes )
+{
+
+    m_ring.clear();
+    m_ring.reserve( m_shards.size() * virtualNodes );
+
+    for( size_t s = 0; s < m_shards.size(); ++s ) 
+    {
+
+        for( unsigned v = 0; v < virtualNodes; ++v ) 
+        {
+
+            std::stringstream point;
+
+            point << "shard#" << s << '#' << v;
+
+            m_ring.push_back( std::make_pair( hashBytes( point.str() ), s ) );
+
+        }
+
+    }
+
+    std::sort( m_ring.begin(), m_ring.end() );
+
+}
+
+//***************************************************************************************************
+
+bool EShardedClient::connect(           const char*     host, 
+                                        int             port, 
+                                        int             baseClientId    )
+{
+
+    bool ok = true;
+
+    for( size_t i = 0; i < m_shards.size(); ++i ) 
+    {
+
+        Shard& shard = *m_shards[ i ];
+
+        if( shard.m_client.isConnected() )
+            continue;
+
+        shard.m_pReader.reset();
+
+        if( !shard.m_client.eConnect( host, port, baseClientId + (int)i ) ) 
+        {
+            ok = false;
+            continue;
+        }
+
+        // every reader issues the shared signal, processMsgs() drains them all
+        shard.m_pReader.reset( new EReader( &shard.m_client, &m_signal ) );
+        shard.m_pReader->start();
+
+    }
+
+    return ok;
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::disconnect()
+{
+
+    for( size_t i = 0; i < m_shards.size(); ++i ) 
+    {
+
+        m_shards[ i ]->m_pReader.reset();
+        m_shards[ i ]->m_client.eDisconnect();
+
+    }
+
+    EMutexGuard lock( m_csOwner );
+
+    for( size_t i = 0; i < m_shards.size(); ++i )
+        m_shards[ i ]->m_lines = 0;
+
+    m_owner.clear();
+    m_streaming.clear();
+
+}
+
+//***************************************************************************************************
+
+bool EShardedClient::isConnected() const
+{
+
+    for( size_t i = 0; i < m_shards.size(); ++i ) 
+    {
+
+        if( !m_shards[ i ]->m_client.isConnected() )
+            return false;
+
+    }
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::processMsgs()
+{
+
+    m_signal.waitForSignal();
+
+    for( size_t i = 0; i < m_shards.size(); ++i ) 
+    {
+
+        if( m_shards[ i ]->m_pReader )
+            m_shards[ i ]->m_pReader->processMsgs();
+
+    }
+
+}
+
+//***************************************************************************************************
+
+size_t EShardedClient::shardCount() const
+{
+
+    return m_shards.size();
+
+}
+
+//***************************************************************************************************
+
+size_t EShardedClient::shardFor( const Contract& contract ) const
+{
+
+    // first ring point clockwise from the instrument's hash
+    std::pair< unsigned long long, size_t > probe( hashBytes( instrumentKey( contract ) ), 0 );
+
+    std::vector< std::pair< unsigned long long, size_t > >::const_iterator it = std::lower_bound( m_ring.begin(), m_ring.end(), probe );
+
+    if( it == m_ring.end() )
+        it = m_ring.begin();
+
+    return it->second;
+
+}
+
+//***************************************************************************************************
+
+size_t EShardedClient::lineCount( size_t shard ) const
+{
+
+    EMutexGuard lock( m_csOwner );
+
+    return shard < m_shards.size() ? m_shards[ shard ]->m_lines : 0;
+
+}
+
+//***************************************************************************************************
+
+EClientSocket& EShardedClient::shard( size_t i )
+{
+
+    return m_shards[ i ]->m_client;
+
+}
+
+//***************************************************************************************************
+
+EClientSocket& EShardedClient::primary()
+{
+
+    return m_shards[ 0 ]->m_client;
+
+}
+
+//***************************************************************************************************
+
+EClientSocket& EShardedClient::route(           int                 msgId, 
+                                                long                id, 
+                                                const Contract&     contract        )
+{
+
+    size_t s = shardFor( contract );
+
+    EMutexGuard lock( m_csOwner );
+
+    // a request reused before its cancel stays where it was
+    std::map< RequestKey, size_t >::iterator it = m_owner.find( RequestKey( msgId, id ) );
+
+    if( it != m_owner.end() )
+        return m_shards[ it->second ]->m_client;
+
+    m_owner[ RequestKey( msgId, id ) ] = s;
+    ++m_shards[ s ]->m_lines;
+
+    return m_shards[ s ]->m_client;
+
+}
+
+//***************************************************************************************************
+
+EClientSocket* EShardedClient::release(         int                 msgId, 
+                                                long                id              )
+{
+
+    EMutexGuard lock( m_csOwner );
+
+    std::map< RequestKey, size_t >::iterator it = m_owner.find( RequestKey( msgId, id ) );
+
+    if( it == m_owner.end() )
+        return 0;
+
+    Shard& shard = *m_shards[ it->second ];
+
+    --shard.m_lines;
+    m_owner.erase( it );
+
+    if( msgId == REQ_HISTORICAL_DATA )
+        m_streaming.erase( id );
+
+    return &shard.m_client;
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::completed( long id )
+{
+
+    {
+        EMutexGuard lock( m_csOwner );
+
+        if( m_streaming.count( id ) )
+            return;
+    }
+
+    release( REQ_HISTORICAL_DATA, id );
+
+}
+
+//***************************************************************************************************
+// the error does not say which request it ends, so every one under that id on the
+// shard reporting it goes
+
+void EShardedClient::failed(    size_t      shard, 
+                                long        id              )
+{
+
+    EMutexGuard lock( m_csOwner );
+
+    for( std::map< RequestKey, size_t >::iterator it = m_owner.begin(); it != m_owner.end(); ) 
+    {
+
+        if( it->first.second != id || it->second != shard ) 
+        {
+            ++it;
+            continue;
+        }
+
+        --m_shards[ shard ]->m_lines;
+
+        if( it->first.first == REQ_HISTORICAL_DATA )
+            m_streaming.erase( id );
+
+        m_owner.erase( it++ );
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::reqMktData(        TickerId                    tickerId, 
+                                        const Contract&             contract, 
+                                        const std::string&          genericTicks, 
+                                        bool                        snapshot, 
+                                        bool                        regulatorySnapshot, 
+                                        const TagValueListSPtr&     mktDataOptions      )
+{
+
+    // snapshots end by themselves, they are not tracked
+    EClientSocket& client = ( snapshot || regulatorySnapshot ) ? shard( shardFor( contract ) ) : route( REQ_MKT_DATA, tickerId, contract );
+
+    client.reqMktData( tickerId, contract, genericTicks, snapshot, regulatorySnapshot, mktDataOptions );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::cancelMktData( TickerId tickerId )
+{
+
+    EClientSocket* client = release( REQ_MKT_DATA, tickerId );
+
+    if( client )
+        client->cancelMktData( tickerId );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::reqMktDepth(       TickerId                    tickerId, 
+                                        const Contract&             contract, 
+                                        int                         numRows, 
+                                        bool                        isSmartDepth, 
+                                        const TagValueListSPtr&     mktDepthOptions     )
+{
+
+    route( REQ_MKT_DEPTH, tickerId, contract ).reqMktDepth( tickerId, contract, numRows, isSmartDepth, mktDepthOptions );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::cancelMktDepth(    TickerId    tickerId, 
+                                        bool        isSmartDepth        )
+{
+
+    EClientSocket* client = release( REQ_MKT_DEPTH, tickerId );
+
+    if( client )
+        client->cancelMktDepth( tickerId, isSmartDepth );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::reqRealTimeBars(   TickerId                    tickerId, 
+                                        const Contract&             contract, 
+                                        int                         barSize, 
+                                        const std::string&          whatToShow, 
+                                        bool                        useRTH, 
+                                        const TagValueListSPtr&     realTimeBarsOptions )
+{
+
+    route( REQ_REAL_TIME_BARS, tickerId, contract ).reqRealTimeBars( tickerId, contract, barSize, whatToShow, useRTH, realTimeBarsOptions );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::cancelRealTimeBars( TickerId tickerId )
+{
+
+    EClientSocket* client = release( REQ_REAL_TIME_BARS, tickerId );
+
+    if( client )
+        client->cancelRealTimeBars( tickerId );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::reqHistoricalData( TickerId                    tickerId, 
+                                        const Contract&             contract, 
+                                        const std::string&          endDateTime, 
+                                        const std::string&          durationStr, 
+                                        const std::string&          barSizeSetting, 
+                                        const std::string&          whatToShow, 
+                                        int                         useRTH, 
+                                        int                         formatDate, 
+                                        bool                        keepUpToDate, 
+                                        const TagValueListSPtr&     chartOptions        )
+{
+
+    EClientSocket& client = route( REQ_HISTORICAL_DATA, tickerId, contract );
+
+    // one shot requests are released again by historicalDataEnd, streaming ones by the cancel
+    if( keepUpToDate ) 
+    {
+        EMutexGuard lock( m_csOwner );
+        m_streaming.insert( tickerId );
+    }
+
+    client.reqHistoricalData(   tickerId, contract, endDateTime, durationStr, barSizeSetting, 
+                                whatToShow, useRTH, formatDate, keepUpToDate, chartOptions );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::cancelHistoricalData( TickerId tickerId )
+{
+
+    EClientSocket* client = release( REQ_HISTORICAL_DATA, tickerId );
+
+    if( client )
+        client->cancelHistoricalData( tickerId );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::reqTickByTickData( int                         reqId, 
+                                        const Contract&             contract, 
+                                        const std::string&          tickType, 
+                                        int                         numberOfTicks, 
+                                        bool                        ignoreSize          )
+{
+
+    route( REQ_TICK_BY_TICK_DATA, reqId, contract ).reqTickByTickData( reqId, contract, tickType, numberOfTicks, ignoreSize );
+
+}
+
+//***************************************************************************************************
+
+void EShardedClient::cancelTickByTickData( int reqId )
+{
+
+    EClientSocket* client = release( REQ_TICK_BY_TICK_DATA, reqId );
+
+    if( client )
+        client->cancelTickByTickData( reqId );
+
+}
+
+//***************************************************************************************************
@@ -0,0 +1,153 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESHARDEDCLIENT_H
+#define TWS_API_CLIENT_ESHARDEDCLIENT_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "platformspecific.h"
+#include "CommonDefs.h"
+#include "TagValue.h"
+#include "EReaderOSSignal.h"
+#include "EMutex.h"
+
+
+class  EWrapper;
+class  EClientSocket;
+class  EReader;
+struct Contract;
+
+
+//******************************************************************************************
+// spreads market data lines over K TWS connections ( clientId base .. base + K - 1 ).
+//
+// Instruments are placed on a shard by consistent hashing of the contract, so adding a
+// shard only moves about 1/K of them. Every shard reader issues the same signal and
+// processMsgs() dispatches all of them on the calling thread, so the application sees
+// one serialized EWrapper stream.
+//
+// TWS scopes ids per connection, so a shard is sent the caller's own tickerId / reqId;
+// the facade only remembers which shard owns a request, by request type and id, to
+// route the cancel: the same tickerId may carry market data and depth at once. Orders,
+// account and every other non-instrument request go to primary() ( shard 0 ), whose
+// nextValidId / managedAccounts are the only ones passed on.
+//
+// Same threading contract as EClient: requests from one thread, processMsgs() from one.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EShardedClient
+{
+
+    class Shard;
+
+    EWrapper*                                   m_pWrapper;
+    EReaderOSSignal                             m_signal;
+
+    std::vector< std::unique_ptr< Shard > >     m_shards;
+
+    std::vector< std::pair< unsigned long long, size_t > >  m_ring;        // ( point, shard ) sorted by point
+
+    typedef std::pair< int, long >              RequestKey;                 // request msgId, tickerId / reqId
+
+    std::map< RequestKey, size_t >              m_owner;                    // -> shard
+    std::set< long >                            m_streaming;                // keepUpToDate historical requests
+    mutable EMutex                              m_csOwner;
+
+
+    void                buildRing           (       unsigned        virtualNodes                    );
+    EClientSocket&      route               (       int             msgId, 
+                                                    long            id, 
+                                                    const Contract& contract                        );
+    EClientSocket*      release             (       int             msgId, 
+                                                    long            id                              );
+    void                completed           (       long            id                              );
+    void                failed              (       size_t          shard, 
+                                                    long            id                              );
+
+public:
+
+    static const unsigned   DEFAULT_VIRTUAL_NODES = 160;
+
+    EShardedClient(         EWrapper*       wrapper, 
+                            size_t          shards, 
+                            unsigned        virtualNodes    = DEFAULT_VIRTUAL_NODES     );
+
+   ~EShardedClient();
+
+    // connects every shard, shard i as clientId baseClientId + i; false if any failed
+    bool                connect             (       const char*     host, 
+                                                    int             port, 
+                                                    int             baseClientId    = 0             );
+
+    void                disconnect          (                                                       );
+    bool                isConnected         (                                                       ) const;    // every shard
+
+    // waits for any shard reader, then dispatches the messages of all shards
+    void                processMsgs         (                                                       );
+
+    size_t              shardCount          (                                                       ) const;
+    size_t              shardFor            (       const Contract& contract                        ) const;
+    size_t              lineCount           (       size_t          shard                           ) const;    // live instrument requests
+
+    EClientSocket&      shard               (       size_t          i                               );
+    EClientSocket&      primary             (                                                       );
+
+    // instrument requests, placed by contract and cancelled on the owning shard
+    void                reqMktData          (       TickerId                tickerId, 
+                                                    const Contract&         contract, 
+                                                    const std::string&      genericTicks, 
+                                                    bool                    snapshot, 
+                                                    bool                    regulatorySnapshot, 
+                                                    const TagValueListSPtr& mktDataOptions          );
+
+    void                cancelMktData       (       TickerId                tickerId                );
+
+    void                reqMktDepth         (       TickerId                tickerId, 
+                                                    const Contract&         contract, 
+                                                    int                     numRows, 
+                                                    bool                    isSmartDepth, 
+                                                    const TagValueListSPtr& mktDepthOptions         );
+
+    void                cancelMktDepth      (       TickerId                tickerId, 
+                                                    bool                    isSmartDepth            );
+
+    void                reqRealTimeBars     (       TickerId                tickerId, 
+                                                    const Contract&         contract, 
+                                                    int                     barSize, 
+                                                    const std::string&      whatToShow, 
+                                                    bool                    useRTH, 
+                                                    const TagValueListSPtr& realTimeBarsOptions     );
+
+    void                cancelRealTimeBars  (       TickerId                tickerId                );
+
+    void                reqHistoricalData   (       TickerId                tickerId, 
+                                                    const Contract&         contract, 
+                                                    const std::string&      endDateTime, 
+                                                    const std::string&      durationStr, 
+                                                    const std::string&      barSizeSetting, 
+                                                    const std::string&      whatToShow, 
+                                                    int                     useRTH, 
+                                                    int                     formatDate, 
+                                                    bool                    keepUpToDate, 
+                                                    const TagValueListSPtr& chartOptions            );
+
+    void                cancelHistoricalData(       TickerId                tickerId                );
+
+    void                reqTickByTickData   (       int                     reqId, 
+                                                    const Contract&         contract, 
+                                                    const std::string&      tickType, 
+                                                    int                     numberOfTicks, 
+                                                    bool                    ignoreSize              );
+
+    void                cancelTickByTickData(       int                     reqId                   );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -6,9 +6,11 @@
 #include "ESocket.h"
 
 #include <assert.h>
+#include <string.h>
 
 #if defined(IB_POSIX)
 #include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 
@@ -16,6 +18,12 @@
 //********************************************************************************************************************
 
 ESocket::ESocket() 
+
+	: m_fd			( -1 )
+	, m_outOffset	( 0  )
+	, m_queuedBytes	( 0  )
+	, m_queuedFrames( 0  )
+	, m_hold		( false )
 {
 	// nothing
 }
@@ -31,6 +39,15 @@ void ESocket::fd( int fd )
 
 //********************************************************************************************************************
 
+void ESocket::hold( bool val ) 
+{
+
+    m_hold = val;
+
+}
+
+//********************************************************************************************************************
+
 ESocket::~ESocket( void ) 
 {
 }
@@ -56,12 +73,22 @@ int ESocket::bufferedSend(			const char* 	buf,
 		return 0;
 
 
-	if( !m_outBuffer.empty() ) 
+	if( m_hold ) 
+	{
+
+		enqueue( 			buf, 
+							sz						);
+
+		return (int)sz;
+
+	}
+
+	// keep frame order: anything behind a backlog has to wait its turn
+	if( !m_outQueue.empty() ) 
 	{
 	
-		m_outBuffer.insert( 			m_outBuffer.end(), 
-										buf, 
-										buf + sz					);
+		enqueue( 			buf, 
+							sz						);
 	
 		return sendBufferedData();
 	
@@ -81,9 +108,8 @@ int ESocket::bufferedSend(			const char* 	buf,
 
 		int sent = (std::max)( nResult, 0 );
 
-		m_outBuffer.insert( 				m_outBuffer.end(), 
-											buf + sent, 
-											buf + sz						);
+		enqueue( 			buf + sent, 
+							sz  - sent				);
 	
 	}
 
@@ -93,31 +119,125 @@ int ESocket::bufferedSend(			const char* 	buf,
 
 //********************************************************************************************************************
 
+static const size_t MaxChunksPerSend = 64; 	// iovec entries handed to a single sendmsg()
+static const size_t MaxSpareChunks 	 = 16;
+
+//********************************************************************************************************************
+
+void ESocket::enqueue(			const char* 	buf, 
+								size_t 			sz				)
+{
+
+	if( m_spareChunks.empty() ) 
+	{
+
+		m_outQueue.push_back( Chunk() );
+
+	}
+	else 
+	{
+
+		m_outQueue.push_back( Chunk() );
+
+		m_outQueue.back().swap( m_spareChunks.back() );
+
+		m_spareChunks.pop_back();
+
+	}
+
+	m_outQueue.back().assign( 			buf, 
+										buf + sz					);
+
+	m_queuedBytes  += sz;
+	m_queuedFrames += 1;
+
+}
+
+//********************************************************************************************************************
+
 int ESocket::sendBufferedData()
 {
 
 
-	if( m_outBuffer.empty() )
+	if( m_outQueue.empty() )
 		return 0;
 
 
+#if defined(IB_POSIX)
+
+	/*
+
+		#include <sys/socket.h>
+
+		ssize_t sendmsg(		int 					sockfd, 
+								const struct msghdr	   *msg, 
+								int 					flags			);
+
+		Gather write: the iovec array in msg is sent as one contiguous byte stream,
+		so several queued frames leave in a single system call.
+
+	*/
+
+	struct iovec iov[ MaxChunksPerSend ];
+
+	size_t nIov = 0;
+
+	for( std::deque<Chunk>::iterator it = m_outQueue.begin(); 
+		 it != m_outQueue.end() && nIov < MaxChunksPerSend; 
+		 ++it, ++nIov ) 
+	{
+
+		size_t skip = ( nIov == 0 ) ? m_outOffset : 0;
+
+		iov[ nIov ].iov_base = &(*it)[ skip ];
+		iov[ nIov ].iov_len  = it->size() - skip;
+
+	}
+
+	struct msghdr mh;
+
+	memset( 			&mh, 
+						0, 
+						sizeof( mh ) 				);
+
+	mh.msg_iov 		= 	iov;
+	mh.msg_iovlen 	= 	nIov;
+
+	//************************************************************************	
+	//************************************************************************
+
+	int nResult = ::sendmsg( 			m_fd, 
+										&mh, 
+										0									);
+
 	//************************************************************************	
 	//************************************************************************
 
-	int nResult = send( 				&m_outBuffer[ 0 ], 
-										m_outBuffer.size()					);
+	if( nResult == -1 )
+		return -1;
+
+#else
+
+	const Chunk& front = m_outQueue.front();
 
 	//************************************************************************	
 	//************************************************************************
 
+	int nResult = send( 				&front[ m_outOffset ], 
+										front.size() - m_outOffset			);
+
+	//************************************************************************	
+	//************************************************************************
+
+#endif
+
 
 	if( nResult <= 0 ) 
 	{
 		return nResult;
 	}
 	
-	CleanupBuffer( 				m_outBuffer, 
-								nResult 					);
+	CleanupBuffer( nResult );
 	
 	return nResult;
 
@@ -167,43 +287,83 @@ static const size_t BufferSizeHighMark = 1 * 1024 * 1024; // 1Mb
 
 //********************************************************************************************************************
 
-void ESocket::CleanupBuffer(		std::vector<char>& 		buffer, 
-									int 					processed		)
+void ESocket::CleanupBuffer( 	size_t 		processed 	)
 {
 
-	assert( buffer.empty() || processed <= (int)buffer.size() );
+	assert( processed <= m_queuedBytes );
 
-	if( buffer.empty() )
-		return;
+	m_queuedBytes -= processed;
 
-	if( processed <= 0 )
-		return;
-
-	if( (size_t)processed == buffer.size() ) 
+	// advance through the queue by offset, popping every chunk that went out whole
+	while( processed > 0 && !m_outQueue.empty() ) 
 	{
-	
-		if( buffer.capacity() >= BufferSizeHighMark ) 
+
+		Chunk& front = m_outQueue.front();
+
+		size_t left = front.size() - m_outOffset;
+
+		if( processed < left ) 
 		{
 
-			std::vector<char>().swap( buffer );
-		
+			m_outOffset += processed;
+
+			return;
+
 		}
-		else 
+
+		processed  	-= left;
+		m_outOffset  = 0;
+
+		if( m_spareChunks.size() < MaxSpareChunks && front.capacity() < BufferSizeHighMark ) 
 		{
 
-			buffer.clear();
-		
+			front.clear();
+
+			m_spareChunks.push_back( Chunk() );
+
+			m_spareChunks.back().swap( front );
+
 		}
 
+		m_outQueue.pop_front();
+
+		m_queuedFrames -= 1;
+
 	}
-	else 
+
+}
+
+//********************************************************************************************************************
+
+void ESocket::reset()
+{
+
+	// a half sent frame is worthless on a new connection: drop all, keep the storage
+	while( !m_outQueue.empty() ) 
 	{
 
-		buffer.erase( 				buffer.begin(), 
-									buffer.begin() + processed				);
-	
+		Chunk& front = m_outQueue.front();
+
+		if( m_spareChunks.size() < MaxSpareChunks && front.capacity() < BufferSizeHighMark ) 
+		{
+
+			front.clear();
+
+			m_spareChunks.push_back( Chunk() );
+
+			m_spareChunks.back().swap( front );
+
+		}
+
+		m_outQueue.pop_front();
+
 	}
 
+	m_outOffset 	= 0;
+	m_queuedBytes 	= 0;
+	m_queuedFrames 	= 0;
+	m_hold 			= false;
+
 }
 
 //********************************************************************************************************************
@@ -211,7 +371,25 @@ void ESocket::CleanupBuffer(		std::vector<char>& 		buffer,
 bool ESocket::isOutBufferEmpty() const
 {
 
-	return m_outBuffer.empty();
+	return m_queuedBytes == 0;
+
+}
+
+//********************************************************************************************************************
+
+size_t ESocket::queuedBytes() const
+{
+
+	return m_queuedBytes;
+
+}
+
+//********************************************************************************************************************
+
+size_t ESocket::queuedFrames() const
+{
+
+	return m_queuedFrames;
 
 }
 
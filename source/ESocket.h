@@ -6,6 +6,8 @@
 #define TWS_API_CLIENT_ESOCKET_H
 
 #include "ETransport.h"
+#include <atomic>
+#include <deque>
 #include <vector>
 
 
@@ -15,13 +17,30 @@
 class ESocket : public ETransport
 {
 
+    typedef std::vector<char>   Chunk;
+
     int                     m_fd;           // socket FD ( File Descriptor )
-	std::vector<char>       m_outBuffer;    // socket buffer
+
+    //*****************************************************************************
+    // outbound queue: one chunk per unsent frame, the front chunk is partially
+    // sent up to m_outOffset. Nothing is ever shifted, a fully sent chunk is just
+    // popped and its storage recycled through m_spareChunks
+    //*****************************************************************************
+
+    std::deque<Chunk>       m_outQueue;
+    size_t                  m_outOffset;    // bytes of m_outQueue.front() already sent
+    std::vector<Chunk>      m_spareChunks;  // recycled chunk storage
+
+    std::atomic<size_t>     m_queuedBytes;  // unsent bytes  ( readable from any thread )
+    std::atomic<size_t>     m_queuedFrames; // unsent frames ( readable from any thread )
+
+    bool                    m_hold;         // queue frames without writing, see hold()
 
 
     int         bufferedSend    (       const char*         buf     ,       size_t      sz              );
     int         send            (       const char*         buf     ,       size_t      sz              );
-    void        CleanupBuffer   (       std::vector<char>&  buffer  ,       int         processed       );
+    void        enqueue         (       const char*         buf     ,       size_t      sz              );
+    void        CleanupBuffer   (       size_t              processed                                   );
 
 public:
 
@@ -31,8 +50,17 @@ public:
 
     int         send            (       EMessage*           pMsg                                        );
     bool        isOutBufferEmpty(                                                                       ) const;
+    size_t      queuedBytes     (                                                                       ) const;
+    size_t      queuedFrames    (                                                                       ) const;
     int         sendBufferedData(                                                                       );
+
+    // while held every frame is only queued, sendBufferedData() after releasing writes
+    // them all with a single gather write
+    void        hold            (       bool                val                                         );
     void        fd              (       int                 fd                                          );
+
+    // drops whatever is still queued for the old connection, counters and hold included
+    void        reset           (                                                                       );
     
 };
 
@@ -0,0 +1,41 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESOCKETOPTIONS_H
+#define TWS_API_CLIENT_ESOCKETOPTIONS_H
+
+
+
+//******************************************************************************************
+// TCP tuning applied by EClientSocket to the socket before it connects.
+// Options the platform does not have are skipped ( and read back as 0 / -1 ).
+//******************************************************************************************
+
+struct ESocketOptions
+{
+
+	ESocketOptions() 
+
+		: tcpNoDelay	( true 		)
+		, tcpQuickAck	( false 	)
+		, rcvBuf		( 0 		)
+		, sndBuf		( 0 		)
+		, busyPollUs	( 0 		)
+		, priority		( -1 		)
+	{
+		// nothing
+	}
+
+	bool 	tcpNoDelay;		// TCP_NODELAY: no Nagle, a small order frame leaves at once
+	bool 	tcpQuickAck;	// TCP_QUICKACK ( Linux ): ack at once; the kernel clears it, so it is re-armed after every read
+	int 	rcvBuf;			// SO_RCVBUF in bytes, 0 keeps the kernel default
+	int 	sndBuf;			// SO_SNDBUF in bytes, 0 keeps the kernel default
+	int 	busyPollUs;		// SO_BUSY_POLL ( Linux ) in microseconds, 0 off
+	int 	priority;		// SO_PRIORITY ( Linux ) 0..6, -1 keeps the default
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,109 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EStartupTimeline.h"
+
+
+//***************************************************************************************************
+
+EStartupTimeline::EStartupTimeline()
+{
+
+    reset();
+
+}
+
+//***************************************************************************************************
+
+void EStartupTimeline::reset()
+{
+
+    for( int i = 0; i < STARTUP_PHASE_COUNT; ++i )
+        m_at[ i ].store( -1, std::memory_order_relaxed );
+
+}
+
+//***************************************************************************************************
+
+void EStartupTimeline::mark( EStartupPhase phase )
+{
+
+    int64_t now = std::chrono::duration_cast< std::chrono::nanoseconds >( Clock::now().time_since_epoch() ).count();
+
+    int64_t unset = -1;
+
+    m_at[ phase ].compare_exchange_strong( unset, now, std::memory_order_relaxed );
+
+}
+
+//***************************************************************************************************
+
+bool EStartupTimeline::reached( EStartupPhase phase ) const
+{
+
+    return m_at[ phase ].load( std::memory_order_relaxed ) >= 0;
+
+}
+
+//***************************************************************************************************
+
+double EStartupTimeline::elapsedMs( EStartupPhase phase ) const
+{
+
+    int64_t begin   = m_at[ STARTUP_CONNECT_BEGIN ].load( std::memory_order_relaxed );
+    int64_t at      = m_at[ phase ].load( std::memory_order_relaxed );
+
+    if( begin < 0 || at < 0 )
+        return -1;
+
+    return ( at - begin ) / 1e6;
+
+}
+
+//***************************************************************************************************
+
+double EStartupTimeline::phaseMs( EStartupPhase phase ) const
+{
+
+    int64_t at = m_at[ phase ].load( std::memory_order_relaxed );
+
+    if( at < 0 )
+        return -1;
+
+    for( int i = phase - 1; i >= 0; --i ) 
+    {
+
+        int64_t prev = m_at[ i ].load( std::memory_order_relaxed );
+
+        if( prev >= 0 )
+            return ( at - prev ) / 1e6;
+
+    }
+
+    return 0;
+
+}
+
+//***************************************************************************************************
+
+const char* EStartupTimeline::phaseName( EStartupPhase phase )
+{
+
+    switch( phase ) 
+    {
+
+        case STARTUP_CONNECT_BEGIN:         return "connect";
+        case STARTUP_TCP_CONNECTED:         return "tcp";
+        case STARTUP_HANDSHAKE_SENT:        return "handshake";
+        case STARTUP_SERVER_VERSION:        return "serverVersion";
+        case STARTUP_API_STARTED:           return "startApi";
+        case STARTUP_NEXT_VALID_ID:         return "nextValidId";
+        case STARTUP_MANAGED_ACCOUNTS:      return "managedAccounts";
+        case STARTUP_FIRST_TICK:            return "firstTick";
+
+        default:                            return "";
+
+    }
+
+}
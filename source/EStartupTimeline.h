@@ -0,0 +1,74 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESTARTUPTIMELINE_H
+#define TWS_API_CLIENT_ESTARTUPTIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// milestones of a connection, in the order they normally happen
+//******************************************************************************************
+
+enum EStartupPhase 
+{
+
+    STARTUP_CONNECT_BEGIN,          // eConnect / eConnectAsync called
+    STARTUP_TCP_CONNECTED,          // TCP connect completed
+    STARTUP_HANDSHAKE_SENT,         // API sign and version range written
+    STARTUP_SERVER_VERSION,         // connect ack decoded, server version known
+    STARTUP_API_STARTED,            // startApi and the queued startup requests written
+    STARTUP_NEXT_VALID_ID,          // first nextValidId
+    STARTUP_MANAGED_ACCOUNTS,       // first managedAccounts
+    STARTUP_FIRST_TICK,             // first market data message ( ticks, depth, bars, tick-by-tick )
+
+    STARTUP_PHASE_COUNT
+
+};
+
+//******************************************************************************************
+// when each phase of the current connection was reached. EClientSocket resets it on
+// every connect and marks the phases from whichever thread reaches them; only the
+// first mark of a phase counts. May be read from any thread while it fills in.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EStartupTimeline
+{
+
+    typedef std::chrono::steady_clock   Clock;
+
+    std::atomic< int64_t >      m_at[ STARTUP_PHASE_COUNT ];   // steady clock ns, -1 not reached
+
+public:
+
+    EStartupTimeline();
+
+    void                reset               (                                                       );
+    void                mark                (       EStartupPhase   phase                           );
+
+    bool                reached             (       EStartupPhase   phase                           ) const;
+
+    // milliseconds from STARTUP_CONNECT_BEGIN to the phase, -1 if not reached
+    double              elapsedMs           (       EStartupPhase   phase                           ) const;
+
+    // milliseconds from the latest earlier phase reached to this one, -1 if not reached
+    double              phaseMs             (       EStartupPhase   phase                           ) const;
+
+    static const char*  phaseName           (       EStartupPhase   phase                           );
+
+private:
+
+    EStartupTimeline                        (       const EStartupTimeline&                         );
+    EStartupTimeline&   operator=           (       const EStartupTimeline&                         );
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,515 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EStateReplica.h"
+#include "EDecoder.h"
+#include "DefaultEWrapper.h"
+#include "Contract.h"
+#include "Execution.h"
+#include "CommissionReport.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+namespace
+{
+
+    //***********************************************************************************
+    // decodes a state message only to learn what it is about
+
+    struct KeyCapture : public DefaultEWrapper
+    {
+
+        enum Kind { NONE, OPEN_ORDER_KEY, ORDER_STATUS_KEY, POSITION_KEY, EXECUTION_KEY, COMMISSION_KEY, NEXT_ID_KEY };
+
+        Kind            kind;
+        OrderId         orderId;
+        std::string     status;
+        std::string     key;
+        double          quantity;
+        std::string     time;
+
+        KeyCapture() : kind( NONE ), orderId( 0 ), quantity( 0 ) {}
+
+        void nextValidId( OrderId id )
+        {
+            kind    = NEXT_ID_KEY;
+            orderId = id;
+        }
+
+        void openOrder( OrderId id, const Contract&, const Order&, const OrderState& )
+        {
+            kind    = OPEN_ORDER_KEY;
+            orderId = id;
+        }
+
+        void orderStatus( OrderId id, const std::string& st, double, double, double, int, int, double, int, const std::string&, double )
+        {
+            kind    = ORDER_STATUS_KEY;
+            orderId = id;
+            status  = st;
+        }
+
+        void position( const std::string& account, const Contract& contract, double pos, double )
+        {
+            char conId[ 32 ];
+
+            snprintf( conId, sizeof( conId ), "%ld", contract.conId );
+
+            kind        = POSITION_KEY;
+            key         = account + '|' + conId;
+            quantity    = pos;
+        }
+
+        void execDetails( int, const Contract&, const Execution& execution )
+        {
+            kind    = EXECUTION_KEY;
+            key     = execution.execId;
+            time    = execution.time;
+        }
+
+        void commissionReport( const CommissionReport& report )
+        {
+            kind    = COMMISSION_KEY;
+            key     = report.execId;
+        }
+
+    };
+
+    //***********************************************************************************
+
+    void appendInt( std::string& out, unsigned v )
+    {
+
+        char b[ 4 ] = { ( char )( v >> 24 ), ( char )( v >> 16 ), ( char )( v >> 8 ), ( char )v };
+
+        out.append( b, 4 );
+
+    }
+
+    unsigned readInt( const char* p )
+    {
+
+        const unsigned char* u = ( const unsigned char* )p;
+
+        return ( unsigned( u[ 0 ] ) << 24 ) | ( unsigned( u[ 1 ] ) << 16 ) | ( unsigned( u[ 2 ] ) << 8 ) | u[ 3 ];
+
+    }
+
+    // TWS reports "yyyymmdd  hh:mm:ss[ tz]", ExecutionFilter wants "yyyymmdd hh:mm:ss"
+    std::string filterTime( const std::string& t )
+    {
+
+        size_t date = t.find_first_not_of( ' ' );
+
+        if( date == std::string::npos || t.size() < date + 8 )
+            return std::string();
+
+        size_t clock = t.find_first_not_of( ' ', date + 8 );
+
+        if( clock == std::string::npos )
+            return t.substr( date, 8 );
+
+        size_t stop = t.find( ' ', clock );
+
+        return t.substr( date, 8 ) + ' ' + t.substr( clock, stop == std::string::npos ? std::string::npos : stop - clock );
+
+    }
+
+    bool terminalStatus( const std::string& status )
+    {
+
+        return status == "Filled" || status == "Cancelled" || status == "ApiCancelled" || status == "Inactive";
+
+    }
+
+    const int MAX_RECORD_LEN = 0xFFFFFF;
+
+}
+
+//***************************************************************************************************
+
+EStateReplica::EStateReplica()
+
+    : m_serverVersion   (   0   )
+    , m_clientId        (   0   )
+    , m_port            (   0   )
+    , m_connection      (   0   )
+    , m_nextValidId     (   0   )
+    , m_applied         (   0   )
+{
+}
+
+//***************************************************************************************************
+
+void EStateReplica::hello(          int                 serverVersion, 
+                                    int                 clientId, 
+                                    const std::string&  host, 
+                                    int                 port, 
+                                    unsigned            connection      )
+{
+
+    if( serverVersion != m_serverVersion || connection != m_connection ) 
+    {
+
+        m_openOrders.clear();
+        m_orderStatus.clear();
+        m_positions.clear();
+
+    }
+
+    // executions stay valid across connections, execIds keep them unique
+    if( serverVersion != m_serverVersion ) 
+    {
+
+        m_executions.clear();
+        m_commissions.clear();
+
+    }
+
+    m_serverVersion     = serverVersion;
+    m_clientId          = clientId;
+    m_host              = host;
+    m_port              = port;
+    m_connection        = connection;
+
+}
+
+//***************************************************************************************************
+
+bool EStateReplica::apply(          const char*     begin, 
+                                    const char*     end             )
+{
+
+    if( begin >= end || m_serverVersion <= 0 )
+        return false;
+
+    switch( atoi( begin ) ) 
+    {
+
+        case NEXT_VALID_ID:
+        case OPEN_ORDER:
+        case ORDER_STATUS:
+        case POSITION_DATA:
+        case EXECUTION_DATA:
+        case COMMISSION_REPORT:
+            break;
+
+        default:
+            return false;
+
+    }
+
+    KeyCapture capture;
+
+    const char* ptr = begin;
+
+    if( EDecoder( m_serverVersion, &capture ).parseAndProcessMsg( ptr, end ) <= 0 )
+        return false;
+
+    std::string frame( begin, end );
+
+    switch( capture.kind ) 
+    {
+
+        case KeyCapture::NEXT_ID_KEY:
+            m_nextValidId = ( std::max )( m_nextValidId, capture.orderId );
+            break;
+
+        case KeyCapture::OPEN_ORDER_KEY:
+            m_openOrders[ capture.orderId ] = frame;
+            m_nextValidId = ( std::max )( m_nextValidId, capture.orderId + 1 );
+            break;
+
+        case KeyCapture::ORDER_STATUS_KEY:
+
+            // done orders need no takeover, TWS keeps reporting the live ones
+            if( terminalStatus( capture.status ) ) 
+            {
+                m_openOrders.erase( capture.orderId );
+                m_orderStatus.erase( capture.orderId );
+            }
+            else
+                m_orderStatus[ capture.orderId ] = frame;
+
+            m_nextValidId = ( std::max )( m_nextValidId, capture.orderId + 1 );
+            break;
+
+        case KeyCapture::POSITION_KEY:
+
+            if( capture.quantity == 0 )
+                m_positions.erase( capture.key );
+            else
+                m_positions[ capture.key ] = frame;
+
+            break;
+
+        case KeyCapture::EXECUTION_KEY: 
+        {
+
+            m_executions[ capture.key ] = frame;
+
+            std::string t = filterTime( capture.time );
+
+            if( t > m_lastExecTime )
+                m_lastExecTime = t;
+
+            break;
+
+        }
+
+        case KeyCapture::COMMISSION_KEY:
+            m_commissions[ capture.key ] = frame;
+            break;
+
+        default:
+            return false;
+
+    }
+
+    ++m_applied;
+
+    return true;
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::setJournal( const std::vector< ERequestJournal::Record >& records )
+{
+
+    m_journal = records;
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::clear()
+{
+
+    hello( 0, 0, std::string(), 0, 0 );
+
+    m_openOrders.clear();
+    m_orderStatus.clear();
+    m_positions.clear();
+    m_executions.clear();
+    m_commissions.clear();
+    m_journal.clear();
+
+    m_nextValidId   = 0;
+    m_lastExecTime.clear();
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::messages( std::vector< std::string >& frames ) const
+{
+
+    frames.clear();
+
+    if( m_nextValidId > 0 ) 
+    {
+
+        char id[ 64 ];
+
+        int n = snprintf( id, sizeof( id ), "%d%c1%c%ld", NEXT_VALID_ID, 0, 0, ( long )m_nextValidId );
+
+        frames.push_back( std::string( id, n + 1 ) );
+
+    }
+
+    const OrderFrames* orders[] = { &m_openOrders, &m_orderStatus };
+
+    for( size_t i = 0; i < 2; ++i )
+        for( OrderFrames::const_iterator it = orders[ i ]->begin(); it != orders[ i ]->end(); ++it )
+            frames.push_back( it->second );
+
+    const KeyedFrames* keyed[] = { &m_positions, &m_executions, &m_commissions };
+
+    for( size_t i = 0; i < 3; ++i )
+        for( KeyedFrames::const_iterator it = keyed[ i ]->begin(); it != keyed[ i ]->end(); ++it )
+            frames.push_back( it->second );
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::encodeRecord(       std::string&    out, 
+                                        int             type, 
+                                        const char*     payload, 
+                                        size_t          len             )
+{
+
+    appendInt( out, ( unsigned )( len + 1 ) );
+
+    out.push_back( ( char )type );
+    out.append( payload, len );
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::encodeHello( std::string& out ) const
+{
+
+    std::string p;
+
+    appendInt( p, ( unsigned )m_serverVersion );
+    appendInt( p, ( unsigned )m_clientId );
+    appendInt( p, ( unsigned )m_port );
+    appendInt( p, m_connection );
+
+    p += m_host;
+
+    encodeRecord( out, REPLICA_HELLO, p.data(), p.size() );
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::encodeJournal( std::string& out ) const
+{
+
+    std::string p;
+
+    for( size_t i = 0; i < m_journal.size(); ++i ) 
+    {
+
+        const ERequestJournal::Record& r = m_journal[ i ];
+
+        appendInt( p, ( unsigned )r.msgId );
+        appendInt( p, ( unsigned )r.reqId );
+        appendInt( p, ( unsigned )r.serverVersion );
+        appendInt( p, ( unsigned )r.frame.size() );
+
+        p += r.frame;
+
+    }
+
+    encodeRecord( out, REPLICA_JOURNAL, p.data(), p.size() );
+
+}
+
+//***************************************************************************************************
+
+void EStateReplica::encodeSnapshot( std::string& out ) const
+{
+
+    encodeHello( out );
+
+    std::vector< std::string > frames;
+
+    messages( frames );
+
+    for( size_t i = 0; i < frames.size(); ++i )
+        encodeRecord( out, REPLICA_MESSAGE, frames[ i ].data(), frames[ i ].size() );
+
+    encodeJournal( out );
+
+    encodeRecord( out, REPLICA_SNAPSHOT_END, "", 0 );
+
+}
+
+//***************************************************************************************************
+
+int EStateReplica::readRecord(          const char*     begin, 
+                                        const char*     end, 
+                                        int&            type, 
+                                        const char*&    payload, 
+                                        size_t&         len             )
+{
+
+    if( end - begin < 4 )
+        return 0;
+
+    unsigned size = readInt( begin );
+
+    if( size == 0 || size > ( unsigned )MAX_RECORD_LEN )
+        return -1;
+
+    if( ( size_t )( end - begin ) < 4 + size )
+        return 0;
+
+    type    = ( unsigned char )begin[ 4 ];
+    payload = begin + 5;
+    len     = size - 1;
+
+    return ( int )( 4 + size );
+
+}
+
+//***************************************************************************************************
+
+bool EStateReplica::applyRecord(        int             type, 
+                                        const char*     payload, 
+                                        size_t          len             )
+{
+
+    switch( type ) 
+    {
+
+        case REPLICA_HELLO:
+
+            if( len < 16 )
+                return false;
+
+            hello(      ( int )readInt( payload ), 
+                        ( int )readInt( payload + 4 ), 
+                        std::string( payload + 16, len - 16 ), 
+                        ( int )readInt( payload + 8 ), 
+                        readInt( payload + 12 )                 );
+
+            return true;
+
+        case REPLICA_MESSAGE:
+            return apply( payload, payload + len );
+
+        case REPLICA_JOURNAL: 
+        {
+
+            std::vector< ERequestJournal::Record > records;
+
+            const char* p   = payload;
+            const char* end = payload + len;
+
+            while( end - p >= 16 ) 
+            {
+
+                ERequestJournal::Record r;
+
+                r.msgId             = ( int )readInt( p );
+                r.reqId             = ( int )readInt( p + 4 );
+                r.serverVersion     = ( int )readInt( p + 8 );
+
+                size_t n = readInt( p + 12 );
+
+                p += 16;
+
+                if( ( size_t )( end - p ) < n )
+                    return false;
+
+                r.frame.assign( p, n );
+
+                p += n;
+
+                records.push_back( r );
+
+            }
+
+            setJournal( records );
+
+            return true;
+
+        }
+
+        default:
+            return false;
+
+    }
+
+}
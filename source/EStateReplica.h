@@ -0,0 +1,136 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESTATEREPLICA_H
+#define TWS_API_CLIENT_ESTATEREPLICA_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "CommonDefs.h"
+#include "ERequestJournal.h"
+
+
+
+//******************************************************************************************
+// records of the replication channel between EReplicaPublisher and EReplicaStandby.
+// On the wire every record is [ 4 byte big endian length ][ 1 byte type ][ payload ],
+// the length counting type and payload.
+//******************************************************************************************
+
+enum EReplicaRecordType 
+{
+
+    REPLICA_HELLO           = 1,    // server version, clientId, port, connection number, host of the primary's connection
+    REPLICA_MESSAGE,                // an incoming TWS message that changes the state, as received
+    REPLICA_JOURNAL,                // the whole subscription journal, sent when it changes
+    REPLICA_HEARTBEAT,              // primary alive, nothing changed
+    REPLICA_SNAPSHOT_END            // the standby has caught up with the primary
+
+};
+
+//******************************************************************************************
+// what a standby needs to take over a connection: open orders and their last status,
+// positions, executions with their commissions, the next valid order id and the
+// standing requests of the journal. The TWS messages are kept as received, latest one
+// per order / position / execution, so they can be handed to an EDecoder again.
+//
+// Not thread safe.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EStateReplica
+{
+
+    typedef std::map< OrderId, std::string >        OrderFrames;
+    typedef std::map< std::string, std::string >    KeyedFrames;
+
+    int                                     m_serverVersion;
+    int                                     m_clientId;
+    int                                     m_port;
+    std::string                             m_host;
+    unsigned                                m_connection;
+
+    OrderId                                 m_nextValidId;
+    OrderFrames                             m_openOrders;
+    OrderFrames                             m_orderStatus;
+    KeyedFrames                             m_positions;        // account + conId
+    KeyedFrames                             m_executions;       // execId
+    KeyedFrames                             m_commissions;      // execId
+    std::string                             m_lastExecTime;     // "yyyymmdd hh:mm:ss"
+
+    std::vector< ERequestJournal::Record >  m_journal;
+
+    unsigned long long                      m_applied;
+
+public:
+
+    EStateReplica();
+
+    // identifies the connection. A new connection drops the open orders, statuses and
+    // positions, which TWS sends again and which may have changed while disconnected;
+    // a new server version drops everything kept, which could not be decoded any more
+    void                hello               (       int                 serverVersion, 
+                                                    int                 clientId, 
+                                                    const std::string&  host, 
+                                                    int                 port, 
+                                                    unsigned            connection                  );
+
+    // keeps the message if it belongs to the replicated state, returns false if it does not
+    bool                apply               (       const char*         begin, 
+                                                    const char*         end                         );
+
+    void                setJournal          (       const std::vector< ERequestJournal::Record >& records   );
+
+    void                clear               (                                                       );
+
+    // all kept messages in the order a standby should see them: next valid id, open orders,
+    // order statuses, positions, executions, commissions
+    void                messages            (       std::vector< std::string >& frames              ) const;
+
+    // HELLO, every kept message, JOURNAL and SNAPSHOT_END
+    void                encodeSnapshot      (       std::string&        out                         ) const;
+
+    void                encodeHello         (       std::string&        out                         ) const;
+    void                encodeJournal       (       std::string&        out                         ) const;
+
+    static void         encodeRecord        (       std::string&        out, 
+                                                    int                 type, 
+                                                    const char*         payload, 
+                                                    size_t              len                         );
+
+    // applies one HELLO / MESSAGE / JOURNAL payload
+    bool                applyRecord         (       int                 type, 
+                                                    const char*         payload, 
+                                                    size_t              len                         );
+
+    // splits the next record off a byte stream: bytes consumed, 0 if incomplete, -1 if corrupt
+    static int          readRecord          (       const char*         begin, 
+                                                    const char*         end, 
+                                                    int&                type, 
+                                                    const char*&        payload, 
+                                                    size_t&             len                         );
+
+    int                 serverVersion       (                                                       ) const { return m_serverVersion;   }
+    int                 clientId            (                                                       ) const { return m_clientId;        }
+    int                 port                (                                                       ) const { return m_port;            }
+    const std::string&  host                (                                                       ) const { return m_host;            }
+    unsigned            connection          (                                                       ) const { return m_connection;      }
+    OrderId             nextValidId         (                                                       ) const { return m_nextValidId;     }
+    const std::string&  lastExecTime        (                                                       ) const { return m_lastExecTime;    }
+
+    size_t              openOrders          (                                                       ) const { return m_openOrders.size();   }
+    size_t              positions           (                                                       ) const { return m_positions.size();    }
+    size_t              executions          (                                                       ) const { return m_executions.size();   }
+
+    const std::vector< ERequestJournal::Record >&   journal (                                       ) const { return m_journal;         }
+
+    // state messages applied since construction
+    unsigned long long  applied             (                                                       ) const { return m_applied;         }
+
+};
+
+//******************************************************************************************
+
+#endif
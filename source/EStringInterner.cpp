@@ -0,0 +1,127 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "EStringInterner.h"
+
+#include <string.h>
+
+
+const int EStringInterner::NOT_FOUND;
+
+
+//***************************************************************************************************
+
+EStringInterner::EStringInterner()
+
+    : m_table   (   64, NOT_FOUND   )
+{
+}
+
+//***************************************************************************************************
+// FNV-1a, plenty for codes of a few characters
+
+unsigned EStringInterner::hash(         const char*     text, 
+                                        size_t          len             )
+{
+
+    unsigned h = 2166136261u;
+
+    for( size_t i = 0; i < len; ++i ) 
+    {
+        h ^= ( unsigned char )text[ i ];
+        h *= 16777619u;
+    }
+
+    return h;
+
+}
+
+//***************************************************************************************************
+// slot holding the code, or the empty slot where it would go
+
+int EStringInterner::slotFor(           const char*     text, 
+                                        size_t          len, 
+                                        unsigned        h               ) const
+{
+
+    size_t mask = m_table.size() - 1;
+
+    for( size_t slot = h & mask; ; slot = ( slot + 1 ) & mask ) 
+    {
+
+        int id = m_table[ slot ];
+
+        if( id == NOT_FOUND )
+            return ( int )slot;
+
+        const std::string& name = m_names[ id ];
+
+        if( m_hashes[ id ] == h && name.size() == len && memcmp( name.data(), text, len ) == 0 )
+            return ( int )slot;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+void EStringInterner::grow()
+{
+
+    std::vector< int > table( m_table.size() * 2, NOT_FOUND );
+
+    size_t mask = table.size() - 1;
+
+    for( size_t id = 0; id < m_names.size(); ++id ) 
+    {
+
+        size_t slot = m_hashes[ id ] & mask;
+
+        while( table[ slot ] != NOT_FOUND )
+            slot = ( slot + 1 ) & mask;
+
+        table[ slot ] = ( int )id;
+
+    }
+
+    m_table.swap( table );
+
+}
+
+//***************************************************************************************************
+
+int EStringInterner::intern(            const char*     text, 
+                                        size_t          len             )
+{
+
+    unsigned    h       = hash( text, len );
+    int         slot    = slotFor( text, len, h );
+
+    if( m_table[ slot ] != NOT_FOUND )
+        return m_table[ slot ];
+
+    int id = ( int )m_names.size();
+
+    m_names.push_back( std::string( text, len ) );
+    m_hashes.push_back( h );
+
+    m_table[ slot ] = id;
+
+    // at most half full, probes stay short
+    if( m_names.size() * 2 > m_table.size() )
+        grow();
+
+    return id;
+
+}
+
+//***************************************************************************************************
+
+int EStringInterner::find(              const char*     text, 
+                                        size_t          len             ) const
+{
+
+    return m_table[ slotFor( text, len, hash( text, len ) ) ];
+
+}
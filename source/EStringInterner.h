@@ -0,0 +1,61 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ESTRINGINTERNER_H
+#define TWS_API_CLIENT_ESTRINGINTERNER_H
+
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+
+
+
+//******************************************************************************************
+// maps the short codes repeated in market data ( market makers, exchanges, tick-by-tick
+// exchanges ... ) to small dense integers, 0, 1, 2 ... in order of first appearance, so
+// hot structures store and compare ints instead of strings.
+//
+// Open addressing on the hash of the bytes: looking up a code already known allocates
+// nothing. Ids are never reused. Not thread safe.
+//******************************************************************************************
+
+class TWSAPIDLLEXP EStringInterner
+{
+
+    std::vector< std::string >      m_names;            // by id
+    std::vector< unsigned >         m_hashes;           // by id
+    std::vector< int >              m_table;            // id or -1, size a power of two
+
+
+    static unsigned     hash                (       const char*         text, 
+                                                    size_t              len                         );
+    int                 slotFor             (       const char*         text, 
+                                                    size_t              len, 
+                                                    unsigned            h                           ) const;
+    void                grow                (                                                       );
+
+public:
+
+    static const int    NOT_FOUND           = -1;
+
+    EStringInterner();
+
+    // id of the code, added if new
+    int                 intern              (       const char*         text, 
+                                                    size_t              len                         );
+    int                 intern              (       const std::string&  text                        ) { return intern( text.data(), text.size() );    }
+
+    // id of the code, NOT_FOUND if it never was interned
+    int                 find                (       const char*         text, 
+                                                    size_t              len                         ) const;
+    int                 find                (       const std::string&  text                        ) const { return find( text.data(), text.size() );      }
+
+    const std::string&  name                (       int                 id                          ) const { return m_names[ id ];     }
+    int                 size                (                                                       ) const { return ( int )m_names.size(); }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,265 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ETickByTick.h"
+#include "EMutex.h"
+#include "TickAttribLast.h"
+#include "TickAttribBidAsk.h"
+
+#include <string.h>
+
+
+const unsigned short ETickCodes::OVERFLOW_ID;
+
+
+namespace {
+
+    struct Dictionary 
+    {
+
+        EMutex              mutex;
+        EStringInterner     codes;
+
+        Dictionary()        { codes.intern( "", 0 ); }
+
+    };
+
+    // constructed on first use ( thread safe since C++11 ), never destroyed before its users
+    Dictionary& dictionary()
+    {
+
+        static Dictionary* d = new Dictionary;
+
+        return *d;
+
+    }
+
+}
+
+
+//***************************************************************************************************
+
+unsigned short ETickCodes::intern(  const char*     text, 
+                                    size_t          len     )
+{
+
+    Dictionary& d = dictionary();
+
+    d.mutex.Enter();
+
+    int id = d.codes.find( text, len );
+
+    if( id == EStringInterner::NOT_FOUND && d.codes.size() < OVERFLOW_ID )
+        id = d.codes.intern( text, len );
+
+    d.mutex.Leave();
+
+    return id == EStringInterner::NOT_FOUND ? OVERFLOW_ID : ( unsigned short )id;
+
+}
+
+//***************************************************************************************************
+
+std::string ETickCodes::name(   unsigned short  id  )
+{
+
+    Dictionary& d = dictionary();
+
+    std::string name;
+
+    d.mutex.Enter();
+
+    if( id < d.codes.size() )
+        name = d.codes.name( id );
+
+    d.mutex.Leave();
+
+    return name;
+
+}
+
+//***************************************************************************************************
+
+size_t ETickCodes::size()
+{
+
+    Dictionary& d = dictionary();
+
+    d.mutex.Enter();
+
+    size_t n = d.codes.size();
+
+    d.mutex.Leave();
+
+    return n;
+
+}
+
+//***************************************************************************************************
+
+void ETickCodes::names( std::vector< std::string >& out )
+{
+
+    Dictionary& d = dictionary();
+
+    d.mutex.Enter();
+
+    out.resize( d.codes.size() );
+
+    for( int id = 0; id < d.codes.size(); ++id )
+        out[ id ] = d.codes.name( id );
+
+    d.mutex.Leave();
+
+}
+
+
+//***************************************************************************************************
+
+ETickByTickNormalizer::ETickByTickNormalizer(   ETickByTickSink*    sink    )
+
+    : m_pSink   ( sink )
+
+{
+
+    memset( &m_event, 0, sizeof( m_event ) );
+
+}
+
+//***************************************************************************************************
+
+unsigned short ETickByTickNormalizer::code( const std::string&  text    )
+{
+
+    int local = m_local.intern( text );
+
+    // first time this normalizer meets the code: one trip to the global dictionary
+    if( local == ( int )m_global.size() )
+        m_global.push_back( ETickCodes::intern( text.data(), text.size() ) );
+
+    return m_global[ local ];
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::emit()
+{
+
+    if( m_pSink )
+        m_pSink->onTickByTick( m_event );
+
+    return m_event;
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::last(    int                 reqId, 
+                                                        int                 tickType, 
+                                                        long long           time, 
+                                                        double              price, 
+                                                        int                 size, 
+                                                        int                 attrMask, 
+                                                        const std::string&  exchange, 
+                                                        const std::string&  specialConditions   )
+{
+
+    m_event.time        = time;
+    m_event.price       = price;
+    m_event.askPrice    = 0;
+    m_event.reqId       = reqId;
+    m_event.size        = size;
+    m_event.askSize     = 0;
+    m_event.exchange    = code( exchange );
+    m_event.conditions  = code( specialConditions );
+    m_event.kind        = ( unsigned char )tickType;
+    m_event.flags       = ( unsigned char )( attrMask & ( TBT_PAST_LIMIT | TBT_UNREPORTED ) );
+
+    return emit();
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::bidAsk(  int                 reqId, 
+                                                        long long           time, 
+                                                        double              bidPrice, 
+                                                        double              askPrice, 
+                                                        int                 bidSize, 
+                                                        int                 askSize, 
+                                                        int                 attrMask    )
+{
+
+    m_event.time        = time;
+    m_event.price       = bidPrice;
+    m_event.askPrice    = askPrice;
+    m_event.reqId       = reqId;
+    m_event.size        = bidSize;
+    m_event.askSize     = askSize;
+    m_event.exchange    = 0;
+    m_event.conditions  = 0;
+    m_event.kind        = TBT_BID_ASK;
+    m_event.flags       = ( unsigned char )( attrMask & ( TBT_BID_PAST_LOW | TBT_ASK_PAST_HIGH ) );
+
+    return emit();
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::midPoint(    int             reqId, 
+                                                            long long       time, 
+                                                            double          midPoint    )
+{
+
+    m_event.time        = time;
+    m_event.price       = midPoint;
+    m_event.askPrice    = 0;
+    m_event.reqId       = reqId;
+    m_event.size        = 0;
+    m_event.askSize     = 0;
+    m_event.exchange    = 0;
+    m_event.conditions  = 0;
+    m_event.kind        = TBT_MID_POINT;
+    m_event.flags       = 0;
+
+    return emit();
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::last(    int                     reqId, 
+                                                        int                     tickType, 
+                                                        long long               time, 
+                                                        double                  price, 
+                                                        int                     size, 
+                                                        const TickAttribLast&   attrib, 
+                                                        const std::string&      exchange, 
+                                                        const std::string&      specialConditions   )
+{
+
+    int attrMask = ( attrib.pastLimit ? TBT_PAST_LIMIT : 0 ) | ( attrib.unreported ? TBT_UNREPORTED : 0 );
+
+    return last( reqId, tickType, time, price, size, attrMask, exchange, specialConditions );
+
+}
+
+//***************************************************************************************************
+
+const ETickByTickEvent& ETickByTickNormalizer::bidAsk(  int                     reqId, 
+                                                        long long               time, 
+                                                        double                  bidPrice, 
+                                                        double                  askPrice, 
+                                                        int                     bidSize, 
+                                                        int                     askSize, 
+                                                        const TickAttribBidAsk& attrib      )
+{
+
+    int attrMask = ( attrib.bidPastLow ? TBT_BID_PAST_LOW : 0 ) | ( attrib.askPastHigh ? TBT_ASK_PAST_HIGH : 0 );
+
+    return bidAsk( reqId, time, bidPrice, askPrice, bidSize, askSize, attrMask );
+
+}
@@ -0,0 +1,175 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ETICKBYTICK_H
+#define TWS_API_CLIENT_ETICKBYTICK_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "platformspecific.h"
+#include "EStringInterner.h"
+
+struct TickAttribLast;
+struct TickAttribBidAsk;
+
+
+
+//******************************************************************************************
+// the tickType of the TICK_BY_TICK message
+
+enum ETickByTickKind 
+{
+
+    TBT_LAST        = 1,
+    TBT_ALL_LAST    = 2,
+    TBT_BID_ASK     = 3,
+    TBT_MID_POINT   = 4
+
+};
+
+//******************************************************************************************
+// flags, the attribute mask as sent
+
+enum ETickByTickFlag 
+{
+
+    TBT_PAST_LIMIT      = 1,        // Last / AllLast
+    TBT_UNREPORTED      = 2,
+    TBT_BID_PAST_LOW    = 1,        // BidAsk
+    TBT_ASK_PAST_HIGH   = 2
+
+};
+
+//******************************************************************************************
+// one tick-by-tick event, fixed size and without pointers: fit for rings, shared memory
+// and columnar files. Exchange and special conditions are ids of ETickCodes.
+//
+//      Last / AllLast      price, size, exchange, conditions
+//      BidAsk              price ( bid ), askPrice, size ( bid ), askSize
+//      MidPoint            price
+
+struct ETickByTickEvent 
+{
+
+    long long           time;           // seconds since the epoch
+    double              price;
+    double              askPrice;
+    int                 reqId;
+    int                 size;
+    int                 askSize;
+    unsigned short      exchange;
+    unsigned short      conditions;
+    unsigned char       kind;           // ETickByTickKind
+    unsigned char       flags;          // ETickByTickFlag
+    unsigned char       reserved[ 6 ];  // zero
+
+};
+
+static_assert( sizeof( ETickByTickEvent ) == 48, "fixed layout, no implicit padding" );
+
+//******************************************************************************************
+// the process wide dictionary of tick-by-tick exchange and condition codes. Id 0 is the
+// empty string; ids are never reused. Thread safe, but meant to be reached through an
+// ETickByTickNormalizer, which only locks for codes it has not seen before.
+//
+// Ids are only meaningful in this process: whoever ships events elsewhere ships the
+// names too ( names(), in id order ).
+//******************************************************************************************
+
+class TWSAPIDLLEXP ETickCodes
+{
+
+public:
+
+    static const unsigned short     OVERFLOW_ID     = 0xFFFF;       // dictionary full
+
+    static unsigned short   intern          (       const char*                 text, 
+                                                    size_t                      len             );
+    static std::string      name            (       unsigned short              id              );
+    static size_t           size            (                                                   );
+    static void             names           (       std::vector< std::string >& out             );
+
+};
+
+//******************************************************************************************
+
+struct ETickByTickSink 
+{
+
+    virtual void    onTickByTick    (       const ETickByTickEvent&     event   ) = 0;
+
+    virtual        ~ETickByTickSink () {}
+
+};
+
+//******************************************************************************************
+// builds ETickByTickEvents out of the fields of a TICK_BY_TICK message, and hands them to
+// the sink, if any. Attached to a client ( EClientSocket::setTickByTickNormalizer ) it is
+// fed by the decoder before the tickByTick* callbacks; the overloads taking the
+// attribute structs serve callers fed from those callbacks instead.
+//
+// Keeps its own map of the codes it has met to global ids, so the hot path is one hash
+// lookup without locking. One thread per normalizer.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ETickByTickNormalizer
+{
+
+    ETickByTickSink*                m_pSink;
+    EStringInterner                 m_local;
+    std::vector< unsigned short >   m_global;           // local id -> ETickCodes id
+    ETickByTickEvent                m_event;
+
+
+    unsigned short      code                (       const std::string&  text                        );
+    const ETickByTickEvent& emit            (                                                       );
+
+public:
+
+    explicit ETickByTickNormalizer(                 ETickByTickSink*    sink    = 0                 );
+
+    void                setSink             (       ETickByTickSink*    sink                        ) { m_pSink = sink;     }
+
+    const ETickByTickEvent& last            (       int                 reqId, 
+                                                    int                 tickType, 
+                                                    long long           time, 
+                                                    double              price, 
+                                                    int                 size, 
+                                                    int                 attrMask, 
+                                                    const std::string&  exchange, 
+                                                    const std::string&  specialConditions           );
+    const ETickByTickEvent& bidAsk          (       int                 reqId, 
+                                                    long long           time, 
+                                                    double              bidPrice, 
+                                                    double              askPrice, 
+                                                    int                 bidSize, 
+                                                    int                 askSize, 
+                                                    int                 attrMask                    );
+    const ETickByTickEvent& midPoint        (       int                 reqId, 
+                                                    long long           time, 
+                                                    double              midPoint                    );
+
+    // from the EWrapper callbacks
+    const ETickByTickEvent& last            (       int                     reqId, 
+                                                    int                     tickType, 
+                                                    long long               time, 
+                                                    double                  price, 
+                                                    int                     size, 
+                                                    const TickAttribLast&   attrib, 
+                                                    const std::string&      exchange, 
+                                                    const std::string&      specialConditions   );
+    const ETickByTickEvent& bidAsk          (       int                     reqId, 
+                                                    long long               time, 
+                                                    double                  bidPrice, 
+                                                    double                  askPrice, 
+                                                    int                     bidSize, 
+                                                    int                     askSize, 
+                                                    const TickAttribBidAsk& attrib              );
+
+};
+
+//******************************************************************************************
+
+#endif
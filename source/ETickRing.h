@@ -0,0 +1,89 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ETICKRING_H
+#define TWS_API_CLIENT_ETICKRING_H
+
+#include <atomic>
+
+
+//******************************************************************************************
+// layout of the shared memory tick ring written by ETickRingPublisher and mapped, read
+// only, by any number of ETickRingReader in other processes of the same host.
+//
+// [ header, 128 bytes ][ capacity slots of 64 bytes ]
+//
+// Each slot carries its own sequence stamp: odd while the publisher writes it, 2n + 2
+// once it holds event n. A reader copies the event and checks the stamp did not move,
+// so the publisher never waits for anybody; a reader left behind by more than the
+// capacity notices it and skips ahead ( the events skipped are counted as lost ).
+//******************************************************************************************
+
+enum ETickEventKind 
+{
+
+    TICK_EVENT_TICK     = 1,    // tickPrice / tickSize: tickType, price and / or size
+    TICK_EVENT_QUOTE,           // top of book: price / size bid, price2 / size2 ask
+    TICK_EVENT_DEPTH            // updateMktDepth( L2 ): position, operation, side, price, size
+
+};
+
+//******************************************************************************************
+
+struct ETickEvent 
+{
+
+    unsigned long long      timeNs;         // publisher's steady clock, shared by the host
+    int                     tickerId;
+    unsigned char           kind;           // ETickEventKind
+    unsigned char           tickType;       // TICK
+    unsigned char           operation;      // DEPTH: 0 insert, 1 update, 2 delete
+    unsigned char           side;           // DEPTH: 0 ask, 1 bid
+    int                     position;       // DEPTH
+    int                     reserved;
+    double                  price;          // TICK and DEPTH price, QUOTE bid, 0 if unset
+    double                  size;           // TICK and DEPTH size, QUOTE bid size, 0 if unset
+    double                  price2;         // QUOTE ask
+    double                  size2;          // QUOTE ask size
+
+};
+
+//******************************************************************************************
+
+struct ETickRingSlot 
+{
+
+    std::atomic< unsigned long long >   seq;
+    ETickEvent                          event;
+
+};
+
+//******************************************************************************************
+
+struct ETickRingHeader 
+{
+
+    unsigned                            magic;
+    unsigned                            version;
+    unsigned                            capacity;       // slots, a power of two
+    unsigned                            slotSize;
+    char                                pad0[ 48 ];
+
+    std::atomic< unsigned long long >   head;           // events published so far
+    char                                pad1[ 56 ];
+
+};
+
+//******************************************************************************************
+
+const unsigned  TICK_RING_MAGIC     = 0x54524E47;       // "TRNG"
+const unsigned  TICK_RING_VERSION   = 1;
+
+static_assert( sizeof( ETickRingSlot )      == 64,  "one slot per cache line" );
+static_assert( sizeof( ETickRingHeader )    == 128, "slots start on a cache line" );
+static_assert( ATOMIC_LLONG_LOCK_FREE       == 2,   "the ring is shared between processes" );
+
+//******************************************************************************************
+
+#endif
@@ -0,0 +1,232 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ETickRingPublisher.h"
+
+#include <chrono>
+#include <string.h>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+//***************************************************************************************************
+
+ETickRingPublisher::ETickRingPublisher()
+
+    : m_pHeader     (   0   )
+    , m_pSlots      (   0   )
+    , m_mapped      (   0   )
+    , m_mask        (   0   )
+    , m_next        (   0   )
+{
+}
+
+//***************************************************************************************************
+
+ETickRingPublisher::~ETickRingPublisher()
+{
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool ETickRingPublisher::create(        const char*     name, 
+                                        unsigned        capacity        )
+{
+
+    close();
+
+#if defined(_WIN32)
+
+    ( void )name;
+    ( void )capacity;
+
+    return false;
+
+#else
+
+    unsigned slots = 1;
+
+    while( slots < capacity && slots < ( 1u << 30 ) )
+        slots <<= 1;
+
+    size_t size = sizeof( ETickRingHeader ) + ( size_t )slots * sizeof( ETickRingSlot );
+
+    // a fresh object: readers of a previous ring keep theirs until they reopen
+    shm_unlink( name );
+
+    int fd = shm_open( name, O_CREAT | O_EXCL | O_RDWR, 0644 );
+
+    if( fd < 0 )
+        return false;
+
+    void* mem = MAP_FAILED;
+
+    if( ftruncate( fd, ( off_t )size ) == 0 )
+        mem = mmap( 0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+
+    ::close( fd );
+
+    if( mem == MAP_FAILED ) 
+    {
+
+        shm_unlink( name );
+
+        return false;
+
+    }
+
+    m_name      = name;
+    m_mapped    = size;
+    m_pHeader   = static_cast< ETickRingHeader* >( mem );
+    m_pSlots    = reinterpret_cast< ETickRingSlot* >( m_pHeader + 1 );
+    m_mask      = slots - 1;
+    m_next      = 0;
+
+    // ftruncate zero filled everything: every stamp reads "not written yet"
+    m_pHeader->version  = TICK_RING_VERSION;
+    m_pHeader->capacity = slots;
+    m_pHeader->slotSize = sizeof( ETickRingSlot );
+
+    m_pHeader->head.store( 0, std::memory_order_relaxed );
+
+    // readers check the magic last
+    std::atomic_thread_fence( std::memory_order_release );
+
+    m_pHeader->magic    = TICK_RING_MAGIC;
+
+    return true;
+
+#endif
+
+}
+
+//***************************************************************************************************
+
+void ETickRingPublisher::close()
+{
+
+    if( !m_pHeader )
+        return;
+
+#if !defined(_WIN32)
+
+    munmap( m_pHeader, m_mapped );
+
+    shm_unlink( m_name.c_str() );
+
+#endif
+
+    m_pHeader   = 0;
+    m_pSlots    = 0;
+    m_mapped    = 0;
+
+    m_name.clear();
+
+}
+
+//***************************************************************************************************
+
+void ETickRingPublisher::publish( const ETickEvent& event )
+{
+
+    if( !m_pHeader )
+        return;
+
+    ETickRingSlot& slot = m_pSlots[ m_next & m_mask ];
+
+    // odd: a reader copying this slot now will see the stamp move and drop the copy
+    slot.seq.store( 2 * m_next + 1, std::memory_order_relaxed );
+
+    std::atomic_thread_fence( std::memory_order_release );
+
+    slot.event = event;
+
+    slot.seq.store( 2 * m_next + 2, std::memory_order_release );
+
+    m_pHeader->head.store( ++m_next, std::memory_order_release );
+
+}
+
+//***************************************************************************************************
+
+void ETickRingPublisher::publishTick(   int             tickerId, 
+                                        int             tickType, 
+                                        double          price, 
+                                        double          size            )
+{
+
+    ETickEvent event;
+
+    memset( &event, 0, sizeof( event ) );
+
+    event.timeNs    = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    event.tickerId  = tickerId;
+    event.kind      = TICK_EVENT_TICK;
+    event.tickType  = ( unsigned char )tickType;
+    event.price     = price;
+    event.size      = size;
+
+    publish( event );
+
+}
+
+//***************************************************************************************************
+
+void ETickRingPublisher::publishQuote(  int             tickerId, 
+                                        double          bidPrice, 
+                                        double          bidSize, 
+                                        double          askPrice, 
+                                        double          askSize         )
+{
+
+    ETickEvent event;
+
+    memset( &event, 0, sizeof( event ) );
+
+    event.timeNs    = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    event.tickerId  = tickerId;
+    event.kind      = TICK_EVENT_QUOTE;
+    event.price     = bidPrice;
+    event.size      = bidSize;
+    event.price2    = askPrice;
+    event.size2     = askSize;
+
+    publish( event );
+
+}
+
+//***************************************************************************************************
+
+void ETickRingPublisher::publishDepth(  int             tickerId, 
+                                        int             position, 
+                                        int             operation, 
+                                        int             side, 
+                                        double          price, 
+                                        double          size            )
+{
+
+    ETickEvent event;
+
+    memset( &event, 0, sizeof( event ) );
+
+    event.timeNs    = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+    event.tickerId  = tickerId;
+    event.kind      = TICK_EVENT_DEPTH;
+    event.operation = ( unsigned char )operation;
+    event.side      = ( unsigned char )side;
+    event.position  = position;
+    event.price     = price;
+    event.size      = size;
+
+    publish( event );
+
+}
@@ -0,0 +1,78 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ETICKRINGPUBLISHER_H
+#define TWS_API_CLIENT_ETICKRINGPUBLISHER_H
+
+#include <string>
+#include "platformspecific.h"
+#include "ETickRing.h"
+
+
+
+//******************************************************************************************
+// writes normalized tick, quote and depth events into a named shared memory ring
+// ( POSIX shm_open ) that other processes read with ETickRingReader. Publishing is a
+// couple of stores into the mapping: no syscall and no work per reader.
+//
+// Single writer: call the publish methods from one thread at a time, typically from the
+// EWrapper callbacks ( tickPrice, tickSize, updateMktDepth ... ) on the processMsgs thread.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ETickRingPublisher
+{
+
+    std::string                     m_name;
+    ETickRingHeader*                m_pHeader;
+    ETickRingSlot*                  m_pSlots;
+    size_t                          m_mapped;
+    unsigned long long              m_mask;
+    unsigned long long              m_next;
+
+
+    void                publish             (       const ETickEvent&   event                       );
+
+public:
+
+    static const unsigned   DEFAULT_CAPACITY    = 1 << 16;      // 4MB of slots
+
+    ETickRingPublisher();
+    ~ETickRingPublisher();
+
+    // creates ( or replaces ) the ring "name", e.g. "/tws-ticks"; capacity is rounded up
+    // to a power of two
+    bool                create              (       const char*         name, 
+                                                    unsigned            capacity    = DEFAULT_CAPACITY  );
+
+    // unmaps and removes the ring; readers already attached keep their mapping
+    void                close               (                                                       );
+
+    bool                isOpen              (                                                       ) const { return m_pHeader != 0;    }
+
+    void                publishTick         (       int                 tickerId, 
+                                                    int                 tickType, 
+                                                    double              price, 
+                                                    double              size                        );
+
+    void                publishQuote        (       int                 tickerId, 
+                                                    double              bidPrice, 
+                                                    double              bidSize, 
+                                                    double              askPrice, 
+                                                    double              askSize                     );
+
+    void                publishDepth        (       int                 tickerId, 
+                                                    int                 position, 
+                                                    int                 operation, 
+                                                    int                 side, 
+                                                    double              price, 
+                                                    double              size                        );
+
+    unsigned long long  published           (                                                       ) const { return m_next;        }
+    unsigned            capacity            (                                                       ) const { return ( unsigned )( m_mask + 1 ); }
+
+};
+
+//******************************************************************************************
+
+#endif
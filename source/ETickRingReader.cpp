@@ -0,0 +1,191 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#include "../StdAfx.h"
+#include "ETickRingReader.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+//***************************************************************************************************
+
+ETickRingReader::ETickRingReader()
+
+    : m_pHeader     (   0   )
+    , m_pSlots      (   0   )
+    , m_mapped      (   0   )
+    , m_mask        (   0   )
+    , m_next        (   0   )
+    , m_lost        (   0   )
+{
+}
+
+//***************************************************************************************************
+
+ETickRingReader::~ETickRingReader()
+{
+
+    close();
+
+}
+
+//***************************************************************************************************
+
+bool ETickRingReader::open(             const char*     name, 
+                                        bool            live            )
+{
+
+    close();
+
+#if defined(_WIN32)
+
+    ( void )name;
+    ( void )live;
+
+    return false;
+
+#else
+
+    int fd = shm_open( name, O_RDONLY, 0 );
+
+    if( fd < 0 )
+        return false;
+
+    struct stat st;
+
+    void* mem = MAP_FAILED;
+
+    if( fstat( fd, &st ) == 0 && ( size_t )st.st_size >= sizeof( ETickRingHeader ) )
+        mem = mmap( 0, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+
+    ::close( fd );
+
+    if( mem == MAP_FAILED )
+        return false;
+
+    const ETickRingHeader* header = static_cast< const ETickRingHeader* >( mem );
+
+    bool valid = header->magic == TICK_RING_MAGIC;
+
+    std::atomic_thread_fence( std::memory_order_acquire );
+
+    unsigned capacity = header->capacity;
+
+    valid = valid && 
+            header->version     == TICK_RING_VERSION && 
+            header->slotSize    == sizeof( ETickRingSlot ) && 
+            capacity > 0 && ( capacity & ( capacity - 1 ) ) == 0 && 
+            sizeof( ETickRingHeader ) + ( size_t )capacity * sizeof( ETickRingSlot ) <= ( size_t )st.st_size;
+
+    if( !valid ) 
+    {
+
+        munmap( mem, st.st_size );
+
+        return false;
+
+    }
+
+    m_pHeader   = header;
+    m_pSlots    = reinterpret_cast< const ETickRingSlot* >( header + 1 );
+    m_mapped    = st.st_size;
+    m_mask      = capacity - 1;
+    m_lost      = 0;
+
+    unsigned long long head = header->head.load( std::memory_order_acquire );
+
+    m_next      = live ? head : ( head > capacity ? head - capacity : 0 );
+
+    return true;
+
+#endif
+
+}
+
+//***************************************************************************************************
+
+void ETickRingReader::close()
+{
+
+    if( !m_pHeader )
+        return;
+
+#if !defined(_WIN32)
+
+    munmap( const_cast< ETickRingHeader* >( m_pHeader ), m_mapped );
+
+#endif
+
+    m_pHeader   = 0;
+    m_pSlots    = 0;
+    m_mapped    = 0;
+
+}
+
+//***************************************************************************************************
+
+bool ETickRingReader::next( ETickEvent& event )
+{
+
+    if( !m_pHeader )
+        return false;
+
+    for( ;; ) 
+    {
+
+        const ETickRingSlot& slot = m_pSlots[ m_next & m_mask ];
+
+        unsigned long long expected = 2 * m_next + 2;
+        unsigned long long stamp    = slot.seq.load( std::memory_order_acquire );
+
+        if( stamp == expected ) 
+        {
+
+            event = slot.event;
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            if( slot.seq.load( std::memory_order_relaxed ) == expected ) 
+            {
+                ++m_next;
+                return true;
+            }
+
+        }
+        else if( stamp < expected )
+            return false;           // not published yet ( or being written for the first time )
+
+        // lapped: the slot already holds a later event. Resume a quarter of the ring
+        // behind the head so the reader does not get lapped again right away
+        unsigned long long head     = m_pHeader->head.load( std::memory_order_acquire );
+        unsigned long long capacity = m_mask + 1;
+        unsigned long long resume   = head > capacity ? head - capacity + capacity / 4 : 0;
+
+        if( resume <= m_next )
+            resume = m_next + 1;
+
+        m_lost += resume - m_next;
+        m_next  = resume;
+
+    }
+
+}
+
+//***************************************************************************************************
+
+unsigned long long ETickRingReader::backlog() const
+{
+
+    if( !m_pHeader )
+        return 0;
+
+    unsigned long long head = m_pHeader->head.load( std::memory_order_acquire );
+
+    return head > m_next ? head - m_next : 0;
+
+}
@@ -0,0 +1,55 @@
+﻿/* Copyright (C) 2019 Interactive Brokers LLC. All rights reserved. This code is subject to the terms
+ * and conditions of the IB API Non-Commercial License or the IB API Commercial License, as applicable. */
+
+#pragma once
+#ifndef TWS_API_CLIENT_ETICKRINGREADER_H
+#define TWS_API_CLIENT_ETICKRINGREADER_H
+
+#include "platformspecific.h"
+#include "ETickRing.h"
+
+
+
+//******************************************************************************************
+// maps a ring created by ETickRingPublisher read only and walks its events. Polling:
+// next() returns false when the reader is caught up, it never blocks nor enters the
+// kernel. Each reader has its own position; the publisher does not know about it.
+//******************************************************************************************
+
+class TWSAPIDLLEXP ETickRingReader
+{
+
+    const ETickRingHeader*          m_pHeader;
+    const ETickRingSlot*            m_pSlots;
+    size_t                          m_mapped;
+    unsigned long long              m_mask;
+    unsigned long long              m_next;
+    unsigned long long              m_lost;
+
+public:
+
+    ETickRingReader();
+    ~ETickRingReader();
+
+    // attaches to the ring "name"; a live reader starts with the next event published,
+    // otherwise with the oldest one still in the ring
+    bool                open                (       const char*         name, 
+                                                    bool                live        = true          );
+    void                close               (                                                       );
+
+    bool                isOpen              (                                                       ) const { return m_pHeader != 0;    }
+
+    // copies the next event, false if there is none yet
+    bool                next                (       ETickEvent&         event                       );
+
+    // events published and not read yet ( as far as the ring still holds them )
+    unsigned long long  backlog             (                                                       ) const;
+
+    unsigned long long  position            (                                                       ) const { return m_next;        }
+    unsigned long long  lost                (                                                       ) const { return m_lost;        }
+
+};
+
+//******************************************************************************************
+
+#endif
@@ -79,6 +79,15 @@ static const CodeMsgPair SSL_FAIL			(			530,
 static const CodeMsgPair INVALID_SYMBOL		(			579, 
 														"Invalid symbol in string - "														);
 
+static const CodeMsgPair BAD_ORDER_TEMPLATE	(			590, 
+														"Order template cannot be used - "													);
+
+static const CodeMsgPair STALE_REQUEST_JOURNAL(			591, 
+														"Server version changed, recorded subscriptions not replayed: "						);
+
+static const CodeMsgPair GATEWAY_REJECTED	(			592, 
+														"Request not served by the gateway: "												);
+
 //******************************************************************************************
 
 #endif